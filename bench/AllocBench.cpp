@@ -0,0 +1,128 @@
+// Замер выделений памяти при загрузке хранилища: куча против арены TaskArena.
+//
+//   ToDoAllocBench [число задач]   (по умолчанию 1000000)
+//
+// Для каждого режима печатает число выделений за загрузку (вызовы operator new и запросы
+// к ресурсу std::pmr по умолчанию: new_delete_resource() в libstdc++ не идёт через
+// заменённый operator new), время загрузки и время освобождения задач (с ареной —
+// вместе с её release()).
+
+#include "Storage.hpp"
+#include "TaskArena.hpp"
+#include "TaskImporter.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+// Ресурс по умолчанию, считающий выделения строк задач и блоков арены
+class CountingResource : public std::pmr::memory_resource {
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Хранилище NDJSON с задачами, похожими на настоящие: описание длиннее короткого
+// буфера строки, у части задач дата и 1–3 тега
+std::string writeStore(std::size_t count) {
+    std::string path = (std::filesystem::temp_directory_path() / "todo_alloc_bench.ndjson").string();
+    std::vector<Task> tasks;
+    tasks.reserve(count);
+    static const std::vector<std::string> tagPool = {"home", "work", "errands", "project-alpha",
+                                                     "someday-maybe"};
+    for (std::size_t i = 1; i <= count; ++i) {
+        std::vector<std::string> tags;
+        for (std::size_t k = 0; k < i % 4; ++k) {
+            tags.push_back(tagPool[(i + k) % tagPool.size()]);
+        }
+        std::optional<std::string> due;
+        if (i % 3 == 0) {
+            due = "2025-06-15";
+        }
+        tasks.push_back(Task::restore(static_cast<TaskId>(i), "Task number " + std::to_string(i)
+                                                                  + " with a longer description",
+                                      due, i % 5 == 0, tags));
+    }
+    std::filesystem::remove(path);
+    Storage(path, "ndjson").save(tasks);
+    return path;
+}
+
+void run(const char* mode, const std::string& path, bool useArena) {
+    auto arena = useArena ? std::make_unique<TaskArena>() : nullptr;
+    std::size_t before = allocations.load();
+    auto start = Clock::now();
+    std::vector<Task> tasks = TaskImporter::loadFile(path, "ndjson", 0, arena.get());
+    double loadMs = msSince(start);
+    std::size_t count = allocations.load() - before;
+    std::size_t loaded = tasks.size();
+
+    start = Clock::now();
+    std::vector<Task>().swap(tasks);
+    arena.reset();
+    double freeMs = msSince(start);
+    std::printf("%-6s %12zu %12.2f %10.1f %12.1f\n", mode, count,
+                loaded ? static_cast<double>(count) / static_cast<double>(loaded) : 0.0, loadMs, freeMs);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    CountingResource counting;
+    std::pmr::set_default_resource(&counting);
+    std::string path = writeStore(count);
+    std::printf("%zu tasks, %s\n", count, path.c_str());
+    std::printf("%-6s %12s %12s %10s %12s\n", "mode", "allocations", "per task", "load ms", "teardown ms");
+    run("heap", path, false);
+    run("arena", path, true);
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".lock");
+    return 0;
+}
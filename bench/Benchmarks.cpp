@@ -0,0 +1,238 @@
+// Набор замеров Google Benchmark для основных операций.
+//
+//   ToDoBench [--benchmark_filter=<regex>]
+//   ToDoBench --benchmark_out=bench.json --benchmark_out_format=json
+//
+// Размеры списков: 1k, 100k и 1M задач. Файлы пишутся во временный каталог и удаляются
+// после каждого замера. Результаты в JSON удобно сравнивать между сборками
+// (tools/compare.py из google/benchmark).
+
+#include "Logger.hpp"
+#include "Storage.hpp"
+#include "TaskManager.hpp"
+#include "UndoStack.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::int64_t kSizes[] = {1000, 100000, 1000000};
+
+// Задачи, похожие на настоящие: описание длиннее короткого буфера строки,
+// у части задач дата и 1–3 тега, каждая пятая выполнена
+const std::vector<Task>& tasksOf(std::size_t count) {
+    static std::map<std::size_t, std::vector<Task>> cache;
+    auto it = cache.find(count);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    static const std::vector<std::string> tagPool = {"home", "work", "errands", "project-alpha",
+                                                     "someday-maybe"};
+    std::vector<Task> tasks;
+    tasks.reserve(count);
+    for (std::size_t i = 1; i <= count; ++i) {
+        std::vector<std::string> tags;
+        for (std::size_t k = 0; k < i % 4; ++k) {
+            tags.push_back(tagPool[(i + k) % tagPool.size()]);
+        }
+        std::optional<std::string> due;
+        if (i % 3 == 0) {
+            due = "2025-06-" + std::to_string(10 + i % 20);
+        }
+        tasks.push_back(Task::restore(static_cast<TaskId>(i),
+                                      "Task number " + std::to_string(i) + " with a longer description",
+                                      due, i % 5 == 0, tags));
+    }
+    return cache.emplace(count, std::move(tasks)).first->second;
+}
+
+TaskManager managerOf(std::size_t count) {
+    TaskManager mgr;
+    mgr.setAllTasks(std::vector<Task>(tasksOf(count)));
+    return mgr;
+}
+
+// Путь во временном каталоге; файл и его спутники (.lock) удаляются в деструкторе
+class TempFile {
+public:
+    explicit TempFile(const std::string& name)
+        : path_((fs::temp_directory_path() / ("todo_bench_" + name)).string()) {
+        remove();
+    }
+
+    ~TempFile() { remove(); }
+
+    const std::string& path() const noexcept { return path_; }
+
+private:
+    void remove() {
+        std::error_code ec;
+        fs::remove(path_, ec);
+        fs::remove(path_ + ".lock", ec);
+        fs::remove(path_ + "-journal", ec);
+    }
+
+    std::string path_;
+};
+
+void setSizes(benchmark::internal::Benchmark* b) {
+    for (auto n : kSizes) {
+        b->Arg(n);
+    }
+    b->Unit(benchmark::kMillisecond);
+}
+
+void BM_StorageSave(benchmark::State& state, const std::string& format) {
+    const auto& tasks = tasksOf(static_cast<std::size_t>(state.range(0)));
+    TempFile file("save." + format);
+    Storage storage(file.path(), format);
+    for (auto _ : state) {
+        storage.save(tasks);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(fs::file_size(file.path())));
+}
+
+void BM_StorageLoad(benchmark::State& state, const std::string& format) {
+    TempFile file("load." + format);
+    Storage(file.path(), format).save(tasksOf(static_cast<std::size_t>(state.range(0))));
+    for (auto _ : state) {
+        Storage storage(file.path(), format);
+        benchmark::DoNotOptimize(storage.load());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(fs::file_size(file.path())));
+}
+
+BENCHMARK_CAPTURE(BM_StorageSave, json, std::string("json"))->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_StorageSave, ndjson, std::string("ndjson"))->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_StorageSave, sqlite, std::string("sqlite"))->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_StorageLoad, json, std::string("json"))->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_StorageLoad, ndjson, std::string("ndjson"))->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_StorageLoad, sqlite, std::string("sqlite"))->Apply(setSizes);
+
+// Откуда берётся таблица столбцов для выборок
+enum class TableMode {
+    Scan,    ///< Менеджер без таблицы: прямой проход по задачам (разовый CLI, ConcurrentTaskManager).
+    Cached,  ///< Таблица построена до замера и переиспользуется (демон без изменений).
+    Rebuild  ///< Каждая итерация — свежая копия без таблицы, table() строит её заново (демон после изменения).
+};
+
+// Выполняет query на менеджере с n задачами в режиме mode
+template <typename Query>
+void runWithTable(benchmark::State& state, TableMode mode, Query&& query) {
+    TaskManager base = managerOf(static_cast<std::size_t>(state.range(0)));
+    if (mode == TableMode::Cached) {
+        base.table();
+    }
+    for (auto _ : state) {
+        if (mode == TableMode::Rebuild) {
+            // Копия O(1): задачи общие, таблицы у неё нет
+            TaskManager fresh = base;
+            fresh.table();
+            benchmark::DoNotOptimize(query(fresh));
+        } else {
+            benchmark::DoNotOptimize(query(base));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Совпадает ровно одна задача из середины списка, но просматриваются все описания
+void BM_SearchByDescription(benchmark::State& state, TableMode mode) {
+    std::string needle = "number " + std::to_string(state.range(0) / 2) + " with";
+    runWithTable(state, mode, [&](const TaskManager& mgr) { return mgr.searchByDescription(needle); });
+}
+BENCHMARK_CAPTURE(BM_SearchByDescription, scan, TableMode::Scan)->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_SearchByDescription, cached, TableMode::Cached)->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_SearchByDescription, rebuild, TableMode::Rebuild)->Apply(setSizes);
+
+void BM_ListTasks(benchmark::State& state) {
+    TaskManager mgr = managerOf(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mgr.listTasks());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListTasks)->Apply(setSizes);
+
+void BM_ListTasksPending(benchmark::State& state, TableMode mode) {
+    runWithTable(state, mode, [](const TaskManager& mgr) { return mgr.listTasks(false); });
+}
+BENCHMARK_CAPTURE(BM_ListTasksPending, scan, TableMode::Scan)->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_ListTasksPending, cached, TableMode::Cached)->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_ListTasksPending, rebuild, TableMode::Rebuild)->Apply(setSizes);
+
+// Поиск по ID (findIndexById через getTask): последняя задача — худший случай
+void BM_FindById(benchmark::State& state) {
+    TaskManager mgr = managerOf(static_cast<std::size_t>(state.range(0)));
+    const TaskId last = static_cast<TaskId>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&mgr.getTask(last));
+    }
+}
+BENCHMARK(BM_FindById)->Apply(setSizes);
+
+// Запись об изменении задачи; бюджет памяти стека вытесняет старые записи
+void BM_UndoStackPush(benchmark::State& state) {
+    const auto& tasks = tasksOf(1000);
+    UndoStack stack;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const Task& before = tasks[i % tasks.size()];
+        Task after = before;
+        after.markDone();
+        stack.push(UndoAction::updated(before, after, i % tasks.size()));
+        ++i;
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK(BM_UndoStackPush);
+
+void BM_LoggerLog(benchmark::State& state) {
+    static TempFile file("history.log");
+    Logger& logger = Logger::instance(file.path());
+    LoggerOptions options;
+    options.async = state.range(0) != 0;
+    options.flushBytes = 64 * 1024;
+    // Режим меняет один поток: остальные ждут начала цикла и log() ещё не вызывали
+    if (state.thread_index() == 0) {
+        logger.setOptions(options);
+    }
+    const std::string message = "Added task 42: Task number 42 with a longer description";
+    for (auto _ : state) {
+        logger.log(message);
+    }
+    if (state.thread_index() == 0) {
+        logger.flush();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    state.SetLabel(options.async ? "async" : "sync");
+}
+BENCHMARK(BM_LoggerLog)->Arg(0)->Arg(1)->ThreadRange(1, 4)->UseRealTime();
+
+void BM_ExportAll(benchmark::State& state, const std::string& format) {
+    TaskManager mgr = managerOf(static_cast<std::size_t>(state.range(0)));
+    TempFile file("export." + format);
+    for (auto _ : state) {
+        mgr.exportAll(format, file.path());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(fs::file_size(file.path())));
+}
+
+BENCHMARK_CAPTURE(BM_ExportAll, json, std::string("json"))->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_ExportAll, csv, std::string("csv"))->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_ExportAll, ndjson, std::string("ndjson"))->Apply(setSizes);
+BENCHMARK_CAPTURE(BM_ExportAll, arrow, std::string("arrow"))->Apply(setSizes);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,124 @@
+// Генератор синтетических хранилищ задач для нагрузочных тестов (DatasetGenerator).
+//
+//   ToDoGen --out <файл> [--format json|ndjson|sqlite] [--count N] [--seed S]
+//           [--desc-min N] [--desc-max N] [--tags N] [--tag-skew S] [--max-tags N]
+//           [--done P] [--due P] [--due-from YYYY-MM-DD] [--due-spread DAYS] [--compress]
+//
+// Формат по умолчанию — по расширению (.ndjson, .db/.sqlite, иначе json); .gz или --compress
+// сжимают JSON/NDJSON. Задачи пишутся в Storage потоково, без TaskManager. Файл
+// перезаписывается; одинаковые параметры дают одинаковые задачи.
+
+#include "DatasetGenerator.hpp"
+#include "Storage.hpp"
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+namespace {
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string formatFor(std::string path) {
+    if (endsWith(path, ".gz")) {
+        path.resize(path.size() - 3);
+    }
+    if (endsWith(path, ".ndjson") || endsWith(path, ".jsonl")) {
+        return "ndjson";
+    }
+    if (endsWith(path, ".db") || endsWith(path, ".sqlite")) {
+        return "sqlite";
+    }
+    return "json";
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "Usage: ToDoGen --out <file> [--format json|ndjson|sqlite] [--count N] [--seed S]\n"
+                 "               [--desc-min N] [--desc-max N] [--tags N] [--tag-skew S] [--max-tags N]\n"
+                 "               [--done P] [--due P] [--due-from YYYY-MM-DD] [--due-spread DAYS]\n"
+                 "               [--compress]\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::unordered_map<std::string, std::string> args;
+        bool compress = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string token = argv[i];
+            if (token == "--help" || token == "-h") {
+                usage();
+                return 0;
+            }
+            if (token.rfind("--", 0) != 0) {
+                throw std::runtime_error("Unexpected argument: " + token);
+            }
+            auto eqPos = token.find('=');
+            if (eqPos != std::string::npos) {
+                args[token.substr(2, eqPos - 2)] = token.substr(eqPos + 1);
+            } else if (token == "--compress") {
+                compress = true;
+            } else if (i + 1 < argc) {
+                args[token.substr(2)] = argv[++i];
+            } else {
+                throw std::runtime_error("Missing value for option: " + token);
+            }
+        }
+        if (!args.count("out")) {
+            usage();
+            return 1;
+        }
+
+        DatasetOptions options;
+        auto take = [&args](const char* key, auto& field, auto parse) {
+            auto it = args.find(key);
+            if (it != args.end()) {
+                field = static_cast<std::decay_t<decltype(field)>>(parse(it->second));
+                args.erase(it);
+            }
+        };
+        auto toSize = [](const std::string& s) { return std::stoull(s); };
+        auto toDouble = [](const std::string& s) { return std::stod(s); };
+        auto toString = [](const std::string& s) { return s; };
+        std::string out = args["out"];
+        args.erase("out");
+        std::string format = formatFor(out);
+        take("format", format, toString);
+        take("count", options.count, toSize);
+        take("seed", options.seed, toSize);
+        take("desc-min", options.minDescription, toSize);
+        take("desc-max", options.maxDescription, toSize);
+        take("tags", options.tagVocabulary, toSize);
+        take("tag-skew", options.tagSkew, toDouble);
+        take("max-tags", options.maxTags, toSize);
+        take("done", options.doneFraction, toDouble);
+        take("due", options.dueFraction, toDouble);
+        take("due-from", options.dueFrom, toString);
+        take("due-spread", options.dueSpreadDays, toSize);
+        if (!args.empty()) {
+            throw std::runtime_error("Unknown option: --" + args.begin()->first);
+        }
+        if (format != "json" && format != "ndjson" && format != "sqlite") {
+            throw std::runtime_error("Unsupported storage format: " + format);
+        }
+
+        DatasetGenerator generator(options);
+        auto start = std::chrono::steady_clock::now();
+        Storage storage(out, format, compress);
+        storage.saveStream([&generator](const auto& sink) { generator.generate(sink); },
+                           generator.nextId());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%zu tasks -> %s (%s), %.2f s\n", options.count, out.c_str(), format.c_str(), seconds);
+        return 0;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,443 @@
+#include "ArrowWriter.hpp"
+#include "TaskTable.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr char kMagic[] = "ARROW1";
+constexpr std::uint32_t kContinuation = 0xFFFFFFFF;
+constexpr std::int16_t kMetadataV5 = 4;
+
+// Типы из Schema.fbs / Message.fbs формата Arrow
+constexpr std::uint8_t kTypeInt = 2;
+constexpr std::uint8_t kTypeUtf8 = 5;
+constexpr std::uint8_t kTypeBool = 6;
+constexpr std::uint8_t kTypeDate = 8;
+constexpr std::uint8_t kTypeList = 12;
+constexpr std::uint8_t kHeaderSchema = 1;
+constexpr std::uint8_t kHeaderDictionaryBatch = 2;
+constexpr std::uint8_t kHeaderRecordBatch = 3;
+constexpr std::int16_t kDateUnitDay = 0;
+
+bool littleEndian() noexcept {
+    const std::uint16_t probe = 1;
+    std::uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+std::size_t align8(std::size_t n) noexcept {
+    return (n + 7) & ~std::size_t{7};
+}
+
+/**
+ * Минимальный построитель FlatBuffers (метаданные Arrow — это flatbuffer).
+ * Как и оригинальный FlatBufferBuilder, пишет от конца к началу: сначала дочерние
+ * объекты, затем ссылающиеся на них таблицы. Ref — расстояние от конца буфера.
+ * Метаданные занимают сотни байт, поэтому вставка в начало строки здесь не важна.
+ */
+class FlatBuilder {
+public:
+    using Ref = std::uint32_t;
+
+    Ref createString(std::string_view s) {
+        prep(4, s.size() + 1);
+        buf_.insert(0, 1, '\0');
+        buf_.insert(0, s.data(), s.size());
+        prependScalar<std::uint32_t>(static_cast<std::uint32_t>(s.size()));
+        return size();
+    }
+
+    // Вектор структур; bytes — уже закодированные элементы подряд
+    Ref createStructVector(const std::string& bytes, std::size_t count) {
+        prep(8, bytes.size());
+        buf_.insert(0, bytes);
+        prependScalar<std::uint32_t>(static_cast<std::uint32_t>(count));
+        return size();
+    }
+
+    Ref createOffsetVector(const std::vector<Ref>& refs) {
+        prep(4, 4 * refs.size());
+        for (auto it = refs.rbegin(); it != refs.rend(); ++it) {
+            prependScalar<std::uint32_t>(size() + 4 - *it);
+        }
+        prependScalar<std::uint32_t>(static_cast<std::uint32_t>(refs.size()));
+        return size();
+    }
+
+    void startTable() {
+        fields_.clear();
+        tableEnd_ = size();
+    }
+
+    template <typename T>
+    void add(std::uint16_t id, T value) {
+        prep(sizeof(T), 0);
+        prependScalar(value);
+        fields_.emplace_back(id, size());
+    }
+
+    void addOffset(std::uint16_t id, Ref ref) {
+        prep(4, 0);
+        prependScalar<std::uint32_t>(size() + 4 - ref);
+        fields_.emplace_back(id, size());
+    }
+
+    Ref endTable() {
+        prep(4, 0);
+        prependScalar<std::int32_t>(0); // смещение vtable, заполняется ниже
+        Ref table = size();
+        std::uint16_t slots = 0;
+        for (const auto& f : fields_) {
+            slots = std::max<std::uint16_t>(slots, f.first + 1);
+        }
+        std::vector<std::uint16_t> vtable(2 + slots, 0);
+        vtable[0] = static_cast<std::uint16_t>(2 * vtable.size());
+        vtable[1] = static_cast<std::uint16_t>(table - tableEnd_);
+        for (const auto& f : fields_) {
+            vtable[2 + f.first] = static_cast<std::uint16_t>(table - f.second);
+        }
+        for (auto it = vtable.rbegin(); it != vtable.rend(); ++it) {
+            prependScalar(*it);
+        }
+        // vtable лежит сразу перед таблицей: soffset = её размер
+        patchScalar<std::int32_t>(table, static_cast<std::int32_t>(2 * vtable.size()));
+        return table;
+    }
+
+    std::string finish(Ref root) {
+        prep(8, 4);
+        prependScalar<std::uint32_t>(size() + 4 - root);
+        return std::move(buf_);
+    }
+
+private:
+    Ref size() const noexcept { return static_cast<Ref>(buf_.size()); }
+
+    // Выравнивает так, чтобы после extra байт размер был кратен align
+    void prep(std::size_t align, std::size_t extra) {
+        std::size_t padding = (align - (buf_.size() + extra) % align) % align;
+        buf_.insert(0, padding, '\0');
+    }
+
+    template <typename T>
+    static void encode(T value, char* out) {
+        using U = std::make_unsigned_t<T>;
+        U u = static_cast<U>(value);
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            out[i] = static_cast<char>((u >> (8 * i)) & 0xFF);
+        }
+    }
+
+    template <typename T>
+    void prependScalar(T value) {
+        char bytes[sizeof(T)];
+        encode(value, bytes);
+        buf_.insert(0, bytes, sizeof(T));
+    }
+
+    template <typename T>
+    void patchScalar(Ref at, T value) {
+        encode(value, &buf_[buf_.size() - at]);
+    }
+
+    std::string buf_;
+    std::vector<std::pair<std::uint16_t, Ref>> fields_;
+    Ref tableEnd_ = 0;
+};
+
+using Ref = FlatBuilder::Ref;
+
+template <typename T>
+void appendLe(std::string& out, T value) {
+    using U = std::make_unsigned_t<T>;
+    U u = static_cast<U>(value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out += static_cast<char>((u >> (8 * i)) & 0xFF);
+    }
+}
+
+Ref emptyTable(FlatBuilder& b) {
+    b.startTable();
+    return b.endTable();
+}
+
+Ref intType(FlatBuilder& b, std::int32_t bitWidth) {
+    b.startTable();
+    b.add<std::int32_t>(0, bitWidth);
+    b.add<std::uint8_t>(1, 1); // is_signed
+    return b.endTable();
+}
+
+Ref field(FlatBuilder& b, std::string_view name, bool nullable, std::uint8_t typeType, Ref type,
+          Ref dictionary, const std::vector<Ref>& children) {
+    Ref nameRef = b.createString(name);
+    Ref childrenRef = b.createOffsetVector(children);
+    b.startTable();
+    b.addOffset(0, nameRef);
+    b.add<std::uint8_t>(1, nullable ? 1 : 0);
+    b.add<std::uint8_t>(2, typeType);
+    b.addOffset(3, type);
+    if (dictionary != 0) {
+        b.addOffset(4, dictionary);
+    }
+    b.addOffset(5, childrenRef);
+    return b.endTable();
+}
+
+Ref schema(FlatBuilder& b) {
+    Ref id = field(b, "id", false, kTypeInt, intType(b, 64), 0, {});
+    Ref description = field(b, "description", false, kTypeUtf8, emptyTable(b), 0, {});
+    b.startTable();
+    b.add<std::int16_t>(0, kDateUnitDay);
+    Ref dateType = b.endTable();
+    Ref dueDate = field(b, "dueDate", true, kTypeDate, dateType, 0, {});
+    Ref done = field(b, "done", false, kTypeBool, emptyTable(b), 0, {});
+    Ref indexType = intType(b, 32);
+    b.startTable(); // DictionaryEncoding
+    b.add<std::int64_t>(0, 0);
+    b.addOffset(1, indexType);
+    b.add<std::uint8_t>(2, 0);
+    Ref encoding = b.endTable();
+    Ref item = field(b, "item", false, kTypeUtf8, emptyTable(b), encoding, {});
+    Ref tags = field(b, "tags", false, kTypeList, emptyTable(b), 0, {item});
+    Ref fields = b.createOffsetVector({id, description, dueDate, done, tags});
+    b.startTable();
+    b.add<std::int16_t>(0, littleEndian() ? 0 : 1);
+    b.addOffset(1, fields);
+    return b.endTable();
+}
+
+std::string message(FlatBuilder& b, std::uint8_t headerType, Ref header, std::int64_t bodyLength) {
+    b.startTable();
+    b.add<std::int16_t>(0, kMetadataV5);
+    b.add<std::uint8_t>(1, headerType);
+    b.addOffset(2, header);
+    b.add<std::int64_t>(3, bodyLength);
+    return b.finish(b.endTable());
+}
+
+/// Узел столбца в пакете: число значений и null.
+struct FieldNode {
+    std::int64_t length;
+    std::int64_t nullCount;
+};
+
+// RecordBatch: раскладка буферов тела по порядку, каждый выровнен на 8 байт
+Ref recordBatch(FlatBuilder& b, std::int64_t length, const std::vector<FieldNode>& nodes,
+                const std::vector<std::string_view>& body) {
+    std::string nodeBytes;
+    for (const auto& n : nodes) {
+        appendLe(nodeBytes, n.length);
+        appendLe(nodeBytes, n.nullCount);
+    }
+    std::string bufferBytes;
+    std::int64_t offset = 0;
+    for (const auto& buf : body) {
+        appendLe(bufferBytes, offset);
+        appendLe(bufferBytes, static_cast<std::int64_t>(buf.size()));
+        offset += static_cast<std::int64_t>(align8(buf.size()));
+    }
+    Ref nodesRef = b.createStructVector(nodeBytes, nodes.size());
+    Ref buffersRef = b.createStructVector(bufferBytes, body.size());
+    b.startTable();
+    b.add<std::int64_t>(0, length);
+    b.addOffset(1, nodesRef);
+    b.addOffset(2, buffersRef);
+    return b.endTable();
+}
+
+std::int64_t bodyLength(const std::vector<std::string_view>& body) {
+    std::int64_t total = 0;
+    for (const auto& buf : body) {
+        total += static_cast<std::int64_t>(align8(buf.size()));
+    }
+    return total;
+}
+
+template <typename T>
+std::string_view bytes(const std::vector<T>& v) {
+    return {reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T)};
+}
+
+void setBit(std::vector<std::uint8_t>& bits, std::size_t index, bool value) {
+    if (index % 8 == 0) {
+        bits.push_back(0);
+    }
+    if (value) {
+        bits.back() |= static_cast<std::uint8_t>(1u << (index % 8));
+    }
+}
+
+} // namespace
+
+ArrowWriter::ArrowWriter(OutputWriter& out) : out_(out) {
+    writeBytes(kMagic, 6);
+    writeBytes("\0\0", 2);
+    FlatBuilder b;
+    writeMessage(message(b, kHeaderSchema, schema(b), 0), {});
+    descOffsets_.push_back(0);
+    tagOffsets_.push_back(0);
+}
+
+void ArrowWriter::writeBytes(const void* data, std::size_t size) {
+    out_.write(std::string_view(static_cast<const char*>(data), size));
+    offset_ += static_cast<std::int64_t>(size);
+}
+
+ArrowWriter::Block ArrowWriter::writeMessage(const std::string& meta,
+                                             const std::vector<std::string_view>& body) {
+    static const char zeros[8] = {};
+    Block block{offset_, static_cast<std::int32_t>(8 + meta.size()), bodyLength(body)};
+    std::string prefix;
+    appendLe(prefix, kContinuation);
+    appendLe(prefix, static_cast<std::int32_t>(meta.size()));
+    writeBytes(prefix.data(), prefix.size());
+    writeBytes(meta.data(), meta.size());
+    for (const auto& buf : body) {
+        writeBytes(buf.data(), buf.size());
+        writeBytes(zeros, align8(buf.size()) - buf.size());
+    }
+    return block;
+}
+
+void ArrowWriter::add(const Task& t) {
+    const Task::String& desc = t.getDescription();
+    constexpr auto kMaxOffset = static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max());
+    if (rows_ > 0 && descData_.size() + desc.size() > kMaxOffset) {
+        flushBatch(); // смещения utf8 — int32
+    }
+    ids_.push_back(t.getId());
+    descData_ += desc;
+    descOffsets_.push_back(static_cast<std::int32_t>(descData_.size()));
+
+    std::optional<std::int32_t> days;
+    if (t.getDueDate()) {
+        days = TaskTable::parseDate(*t.getDueDate());
+    }
+    bool hasDate = days.has_value();
+    setBit(dueValid_, rows_, hasDate);
+    due_.push_back(days.value_or(0));
+    dueNulls_ += hasDate ? 0 : 1;
+
+    setBit(done_, rows_, t.isDone());
+
+    for (const auto& tag : t.getTags()) {
+        auto [it, inserted] = tagIds_.try_emplace(tag, static_cast<std::int32_t>(tagIds_.size()));
+        if (inserted) {
+            newTags_.push_back(tag);
+        }
+        tagIndices_.push_back(it->second);
+    }
+    tagOffsets_.push_back(static_cast<std::int32_t>(tagIndices_.size()));
+
+    if (++rows_ == kBatchRows) {
+        flushBatch();
+    }
+}
+
+void ArrowWriter::writeDictionaryDelta() {
+    dictOffsets_.assign(1, 0);
+    dictData_.clear();
+    for (auto tag : newTags_) {
+        dictData_ += tag;
+        dictOffsets_.push_back(static_cast<std::int32_t>(dictData_.size()));
+    }
+    std::vector<std::string_view> body = {{}, bytes(dictOffsets_), dictData_};
+    auto count = static_cast<std::int64_t>(newTags_.size());
+    FlatBuilder b;
+    Ref data = recordBatch(b, count, {{count, 0}}, body);
+    b.startTable();
+    b.add<std::int64_t>(0, 0); // id словаря
+    b.addOffset(1, data);
+    b.add<std::uint8_t>(2, dictionaryWritten_ ? 1 : 0); // isDelta
+    Ref header = b.endTable();
+    dictionaries_.push_back(writeMessage(message(b, kHeaderDictionaryBatch, header, bodyLength(body)), body));
+    newTags_.clear();
+    dictionaryWritten_ = true;
+}
+
+void ArrowWriter::flushBatch() {
+    if (!dictionaryWritten_ || !newTags_.empty()) {
+        writeDictionaryDelta();
+    }
+    auto rows = static_cast<std::int64_t>(rows_);
+    std::vector<FieldNode> nodes = {
+        {rows, 0},
+        {rows, 0},
+        {rows, static_cast<std::int64_t>(dueNulls_)},
+        {rows, 0},
+        {rows, 0},
+        {static_cast<std::int64_t>(tagIndices_.size()), 0},
+    };
+    // Буферы по порядку полей: битовая карта null (пустая, если null нет), затем данные
+    std::vector<std::string_view> body = {
+        {}, bytes(ids_),
+        {}, bytes(descOffsets_), descData_,
+        bytes(dueValid_), bytes(due_),
+        {}, bytes(done_),
+        {}, bytes(tagOffsets_),
+        {}, bytes(tagIndices_),
+    };
+    FlatBuilder b;
+    Ref header = recordBatch(b, rows, nodes, body);
+    batches_.push_back(writeMessage(message(b, kHeaderRecordBatch, header, bodyLength(body)), body));
+
+    rows_ = 0;
+    ids_.clear();
+    descOffsets_.assign(1, 0);
+    descData_.clear();
+    dueValid_.clear();
+    due_.clear();
+    dueNulls_ = 0;
+    done_.clear();
+    tagOffsets_.assign(1, 0);
+    tagIndices_.clear();
+}
+
+void ArrowWriter::finish() {
+    if (finished_) {
+        return;
+    }
+    if (rows_ > 0) {
+        flushBatch();
+    }
+    if (!dictionaryWritten_) {
+        writeDictionaryDelta();
+    }
+    // Конец потока сообщений, затем подвал со схемой и положением всех пакетов
+    std::string eos;
+    appendLe(eos, kContinuation);
+    appendLe(eos, std::int32_t{0});
+    writeBytes(eos.data(), eos.size());
+
+    auto blocks = [](const std::vector<Block>& list) {
+        std::string out;
+        for (const auto& block : list) {
+            appendLe(out, block.offset);
+            appendLe(out, block.metaDataLength);
+            appendLe(out, std::int32_t{0}); // выравнивание структуры Block
+            appendLe(out, block.bodyLength);
+        }
+        return out;
+    };
+    FlatBuilder b;
+    Ref schemaRef = schema(b);
+    Ref dictionaries = b.createStructVector(blocks(dictionaries_), dictionaries_.size());
+    Ref batches = b.createStructVector(blocks(batches_), batches_.size());
+    b.startTable();
+    b.add<std::int16_t>(0, kMetadataV5);
+    b.addOffset(1, schemaRef);
+    b.addOffset(2, dictionaries);
+    b.addOffset(3, batches);
+    std::string footer = b.finish(b.endTable());
+    writeBytes(footer.data(), footer.size());
+    std::string tail;
+    appendLe(tail, static_cast<std::int32_t>(footer.size()));
+    tail.append(kMagic, 6);
+    writeBytes(tail.data(), tail.size());
+    finished_ = true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "OutputWriter.hpp"
+#include "Task.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Пишет задачи в колоночный файл Apache Arrow IPC (.arrow, он же Feather v2).
+ *
+ * Схема (порядок как у export --format csv):
+ *  - id          — int64;
+ *  - description — utf8 (смещения int32 и байты строк);
+ *  - dueDate     — date32 (дни от 1970-01-01), null без даты или при нераспознанной дате;
+ *  - done        — bool (битовая карта);
+ *  - tags        — list<dictionary<int32, utf8>>: индексы в общий словарь тегов.
+ *
+ * Файл читается pyarrow.ipc.open_file / pyarrow.feather.read_table, pandas.read_feather,
+ * polars.read_ipc и т. п. Запись потоковая: строки копируются в столбцы текущего пакета
+ * (kBatchRows строк, буферы переиспользуются между пакетами), и заполненный пакет сразу
+ * уходит в OutputWriter. Новые теги пакета пишутся перед ним дельта-пакетом словаря,
+ * поэтому выделения памяти на строку нет — только на новый тег.
+ */
+class ArrowWriter {
+public:
+    static constexpr std::size_t kBatchRows = 64 * 1024; ///< Строк в пакете (record batch).
+
+    /**
+     * @brief Пишет заголовок и схему.
+     * @param out Приёмник; должен жить дольше писателя.
+     */
+    explicit ArrowWriter(OutputWriter& out);
+
+    ArrowWriter(const ArrowWriter&) = delete;
+    ArrowWriter& operator=(const ArrowWriter&) = delete;
+
+    /**
+     * @brief Добавляет строку; при заполнении пакета записывает его.
+     *
+     * Задача должна жить до finish(): словарь хранит ссылки на её теги.
+     */
+    void add(const Task& t);
+
+    /**
+     * @brief Записывает последний пакет и подвал файла (OutputWriter не сбрасывается).
+     */
+    void finish();
+
+private:
+    /// Положение сообщения в файле для подвала.
+    struct Block {
+        std::int64_t offset;
+        std::int32_t metaDataLength;
+        std::int64_t bodyLength;
+    };
+
+    void writeBytes(const void* data, std::size_t size);
+    Block writeMessage(const std::string& meta, const std::vector<std::string_view>& body);
+    void flushBatch();
+    void writeDictionaryDelta();
+
+    OutputWriter& out_;
+    std::int64_t offset_ = 0; ///< Байт записано с начала файла.
+    std::vector<Block> dictionaries_;
+    std::vector<Block> batches_;
+
+    // Столбцы текущего пакета
+    std::size_t rows_ = 0;
+    std::vector<std::int64_t> ids_;
+    std::vector<std::int32_t> descOffsets_;
+    std::string descData_;
+    std::vector<std::uint8_t> dueValid_;
+    std::vector<std::int32_t> due_;
+    std::size_t dueNulls_ = 0;
+    std::vector<std::uint8_t> done_;
+    std::vector<std::int32_t> tagOffsets_;
+    std::vector<std::int32_t> tagIndices_;
+
+    // Словарь тегов: ключи ссылаются на строки задач
+    std::unordered_map<std::string_view, std::int32_t> tagIds_;
+    std::vector<std::string_view> newTags_; ///< Теги, ещё не записанные в словарь.
+    std::vector<std::int32_t> dictOffsets_;
+    std::string dictData_;
+    bool dictionaryWritten_ = false;
+    bool finished_ = false;
+};
@@ -12,6 +12,7 @@ CLIOptions CLIParser::parse(int argc, char* argv[]) {
     // По умолчанию
     opt.format = "json";
     opt.dataFilePath = "tasks.json";
+    opt.output = "text";
 
     for (int i = 2; i < argc; ++i) {
         std::string token = argv[i];
@@ -25,17 +26,41 @@ CLIOptions CLIParser::parse(int argc, char* argv[]) {
             } else {
                 // Формат --key value или флаги без значения
                 std::string key = token.substr(2);
-                // Флаги для list: --all, --done, --pending
-                if (opt.command == "list" &&
-                    (key == "all" || key == "done" || key == "pending")) {
+                // Флаги для list: --all, --done, --pending (и --overdue только у list)
+                if (((opt.command == "list" || opt.command == "export") &&
+                     (key == "all" || key == "done" || key == "pending"))
+                    || (opt.command == "list" && key == "overdue")) {
                     opt.args["filter"] = key;
                 }
+                // Флаг для history: --replay
+                else if (opt.command == "history" && key == "replay") {
+                    opt.args["replay"] = "1";
+                }
+                // Флаги для import: --keep-ids, --history-per-task, --history-by-reference
+                else if (opt.command == "import" && (key == "keep-ids" || key == "history-per-task"
+                                                     || key == "history-by-reference")) {
+                    opt.args[key] = "1";
+                }
+                // Глобальный флаг: сжимать файл данных (у export — выгрузку) в gzip
+                else if (key == "compress") {
+                    opt.args["compress"] = "1";
+                }
                 // Опции с аргументом через пробел
-                else if ((opt.command == "export" && (key == "format" || key == "out"))
+                else if ((opt.command == "export" && (key == "format" || key == "out"
+                                                      || key == "delimiter" || key == "search"
+                                                      || key == "tag"))
+                      || (opt.command == "import" && (key == "format" || key == "in"))
                       || key == "data-file" 
                       || key == "store-format" 
+                      || key == "output"
+                      || key == "connect"
+                      || (opt.command == "serve" && (key == "socket" || key == "workers"))
                       || (opt.command == "add" && (key == "due" || key == "tags"))
-                      || (opt.command == "update-date" && key == "due")) {
+                      || (opt.command == "update-date" && key == "due")
+                      || (opt.command == "batch" && key == "checkpoint")
+                      || (opt.command == "history" && (key == "since" || key == "until"
+                                                       || key == "id" || key == "op"
+                                                       || key == "out"))) {
                     if (i + 1 >= argc) {
                         throw std::runtime_error("Missing value for option: " + token);
                     }
@@ -60,9 +85,23 @@ CLIOptions CLIParser::parse(int argc, char* argv[]) {
             } else if (opt.command == "list") {
                 // Позиционный фильтр
                 opt.args["filter"] = token;
-            } else if (opt.command == "export") {
-                throw std::runtime_error("Unexpected positional argument for export: " + token);
-            } else if (opt.command == "undo") {
+            } else if (opt.command == "search") {
+                if (!opt.args.count("query")) {
+                    opt.args["query"] = token;
+                } else {
+                    opt.args["query"] += " " + token;
+                }
+            } else if (opt.command == "export" || opt.command == "import") {
+                throw std::runtime_error("Unexpected positional argument for " + opt.command
+                                         + ": " + token);
+            } else if (opt.command == "batch") {
+                // Файл со списком команд ("-" или отсутствие — stdin)
+                if (opt.args.count("file")) {
+                    throw std::runtime_error("Unexpected positional argument for batch: " + token);
+                }
+                opt.args["file"] = token;
+            } else if (opt.command == "undo" || opt.command == "redo" || opt.command == "history"
+                       || opt.command == "serve") {
                 // Нет аргументов
             } else {
                 throw std::runtime_error("Unknown command or invalid argument: " + token);
@@ -76,10 +115,61 @@ CLIOptions CLIParser::parse(int argc, char* argv[]) {
     }
     if (opt.args.count("store-format")) {
         opt.format = opt.args["store-format"];
-        if (opt.format != "json" && opt.format != "sqlite") {
+        if (opt.format != "json" && opt.format != "ndjson" && opt.format != "sqlite") {
             throw std::runtime_error("Unsupported storage format: " + opt.format);
         }
     }
+    if (opt.args.count("output")) {
+        opt.output = opt.args["output"];
+        if (opt.output != "text" && opt.output != "json" && opt.output != "tsv") {
+            throw std::runtime_error("Unsupported output format: " + opt.output);
+        }
+    }
 
     return opt;
 }
+
+std::vector<std::string> CLIParser::splitCommandLine(const std::string& line) {
+    std::vector<std::string> words;
+    std::string word;
+    bool inWord = false;
+    char quote = 0;
+    for (std::size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quote == '\'') {
+            if (c == '\'') {
+                quote = 0;
+            } else {
+                word += c;
+            }
+        } else if (c == '\\' && i + 1 < line.size()) {
+            word += line[++i];
+            inWord = true;
+        } else if (quote == '"') {
+            if (c == '"') {
+                quote = 0;
+            } else {
+                word += c;
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            inWord = true;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            if (inWord) {
+                words.push_back(std::move(word));
+                word.clear();
+                inWord = false;
+            }
+        } else {
+            word += c;
+            inWord = true;
+        }
+    }
+    if (quote != 0) {
+        throw std::runtime_error("Unterminated quote in: " + line);
+    }
+    if (inWord) {
+        words.push_back(std::move(word));
+    }
+    return words;
+}
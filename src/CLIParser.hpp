@@ -9,9 +9,10 @@
  * @brief Структура, в которой хранятся результаты разбора аргументов CLI.
  */
 struct CLIOptions {
-    std::string command;                       ///< add, remove, list, done, update-date, export, undo
+    std::string command;                       ///< add, remove, list, search, done, update-date, export, undo, redo, history, batch, serve
     std::string dataFilePath;                  ///< путь к файлу (из --data-file)
-    std::string format;                        ///< формат хранения (json или sqlite)
+    std::string format;                        ///< формат хранения (json, ndjson или sqlite)
+    std::string output;                        ///< формат вывода list/search (text, json или tsv)
     std::unordered_map<std::string, std::string> args; ///< прочие аргументы, например: description, id, due, format, out, filter
 };
 
@@ -27,4 +28,15 @@ public:
      * @return заполненную структуру с командой и опциями
      */
     static CLIOptions parse(int argc, char* argv[]);
+
+    /**
+     * @brief Разбивает строку команды на аргументы (для batch).
+     *
+     * Разделители — пробелы и табуляции; '...' и "..." объединяют слова,
+     * обратная косая черта экранирует следующий символ (кроме как внутри '...').
+     * @param line строка вида: add "Buy milk" --due 2025-05-05
+     * @return список аргументов без имени программы
+     * @throws std::runtime_error если кавычка не закрыта
+     */
+    static std::vector<std::string> splitCommandLine(const std::string& line);
 };
@@ -0,0 +1,464 @@
+#include "CommandProcessor.hpp"
+#include "TaskImporter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+// Запись истории с состоянием задачи после операции
+HistoryRecord taskRecord(const std::string& op, const Task& task) {
+    HistoryRecord r;
+    r.op = op;
+    r.id = task.getId();
+    r.task = task;
+    return r;
+}
+
+constexpr std::size_t kImportBatch = 1024; ///< Задач в одной пакетной записи IMPORT.
+
+// Одна запись истории на весь импорт по ссылке: replay перечитывает исходный файл
+// (сверяя его отпечаток), а новые ID (потоки берут их блоками) восстанавливает
+// по отрезкам, сохранённым в порядке файла
+HistoryRecord importRecord(const std::string& path, const std::string& format, bool keepIds,
+                           const std::vector<Task>& tasks, nlohmann::json stamp) {
+    HistoryRecord r;
+    r.op = "IMPORT";
+    r.extra = nlohmann::json::object();
+    r.extra["in"] = std::filesystem::absolute(path).string();
+    r.extra["format"] = format;
+    r.extra["count"] = tasks.size();
+    r.extra["keepIds"] = keepIds;
+    r.extra["stamp"] = std::move(stamp);
+    if (!keepIds) {
+        std::vector<std::pair<TaskId, TaskId>> ranges;
+        for (const auto& t : tasks) {
+            if (!ranges.empty() && ranges.back().second + 1 == t.getId()) {
+                ranges.back().second = t.getId();
+            } else {
+                ranges.emplace_back(t.getId(), t.getId());
+            }
+        }
+        r.extra["ids"] = ranges;
+    }
+    return r;
+}
+
+// Запись истории об удалении задачи
+HistoryRecord removedRecord(const std::string& op, TaskId id) {
+    HistoryRecord r;
+    r.op = op;
+    r.id = id;
+    r.removed = true;
+    return r;
+}
+
+// Теги через запятую: "work,urgent"
+std::vector<std::string> splitTags(const std::string& tagsStr) {
+    std::vector<std::string> tags;
+    std::size_t pos = 0;
+    while (true) {
+        auto comma = tagsStr.find(',', pos);
+        if (comma == std::string::npos) {
+            tags.push_back(tagsStr.substr(pos));
+            break;
+        }
+        tags.push_back(tagsStr.substr(pos, comma - pos));
+        pos = comma + 1;
+    }
+    return tags;
+}
+
+// --all/--done/--pending (list, export)
+std::optional<bool> parseDoneFilter(const CLIOptions& opts) {
+    if (!opts.args.count("filter")) {
+        return std::nullopt;
+    }
+    const std::string& f = opts.args.at("filter");
+    if (f == "all") {
+        return std::nullopt;
+    } else if (f == "done") {
+        return true;
+    } else if (f == "pending") {
+        return false;
+    }
+    throw std::runtime_error("Unknown filter: " + f);
+}
+
+// Сегодняшняя дата YYYY-MM-DD по местному времени (для --overdue)
+std::string today() {
+    std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm buf;
+#if defined(_WIN32) || defined(_WIN64)
+    localtime_s(&buf, &now);
+#else
+    localtime_r(&now, &buf);
+#endif
+    char date[16];
+    std::strftime(date, sizeof(date), "%Y-%m-%d", &buf);
+    return date;
+}
+
+// Разделитель CSV: один символ или "tab"
+char parseDelimiter(const std::string& value) {
+    if (value == "tab" || value == "\\t") {
+        return '\t';
+    }
+    if (value.size() != 1 || value == "\"" || value == "\n" || value == "\r") {
+        throw std::runtime_error("Invalid CSV delimiter: " + value);
+    }
+    return value[0];
+}
+
+} // namespace
+
+CommandProcessor::CommandProcessor(TaskManager& manager, Storage& storage, UndoStack& undo,
+                                   HistoryLog& history, Logger& logger)
+    : manager_(manager), storage_(storage), undo_(undo), history_(history), logger_(logger) {}
+
+void CommandProcessor::execute(const CLIOptions& opts, OutputWriter& out) {
+    const std::string& cmd = opts.command;
+    if (cmd == "add") {
+        std::string desc = opts.args.at("description");
+        std::optional<std::string> due = std::nullopt;
+        if (opts.args.count("due")) {
+            due = opts.args.at("due");
+        }
+        std::vector<std::string> tags;
+        if (opts.args.count("tags")) {
+            tags = splitTags(opts.args.at("tags"));
+        }
+        TaskId newId = manager_.addTask(desc, due, tags);
+        const Task& added = manager_.getTask(newId);
+        stage(UndoAction::added(added, manager_.indexOf(newId)), taskRecord("ADD", added));
+        stageLog("ADD id=" + std::to_string(newId) + " description=\"" + desc + "\""
+                 + (due ? (" due=" + *due) : "")
+                 + (tags.empty() ? "" : " tags=[" + opts.args.at("tags") + "]"));
+        out.write("Task added with id ").writeInt(newId).put('\n');
+    } else if (cmd == "remove") {
+        TaskId id = std::stoll(opts.args.at("id"));
+        std::size_t idx = manager_.indexOf(id);
+        UndoAction action = UndoAction::removed(manager_.getTask(id), idx);
+        manager_.removeTask(id);
+        stage(std::move(action), removedRecord("REMOVE", id));
+        stageLog("REMOVE id=" + std::to_string(id));
+        out.write("Task ").writeInt(id).write(" removed\n");
+    } else if (cmd == "done") {
+        TaskId id = std::stoll(opts.args.at("id"));
+        Task before = manager_.getTask(id);
+        manager_.markDone(id);
+        const Task& after = manager_.getTask(id);
+        stage(UndoAction::updated(before, after, manager_.indexOf(id)), taskRecord("DONE", after));
+        stageLog("DONE id=" + std::to_string(id));
+        out.write("Task ").writeInt(id).write(" marked done\n");
+    } else if (isQuery(opts)) {
+        runQuery(manager_, opts, out);
+        if (cmd == "export") {
+            recordExport(opts.args.at("format"), opts.args.at("out"));
+        }
+    } else if (cmd == "update-date") {
+        TaskId id = std::stoll(opts.args.at("id"));
+        std::string newDue = opts.args.at("due");
+        Task before = manager_.getTask(id);
+        manager_.updateDueDate(id, newDue);
+        const Task& after = manager_.getTask(id);
+        stage(UndoAction::updated(before, after, manager_.indexOf(id)),
+              taskRecord("UPDATE-DATE", after));
+        stageLog("UPDATE-DATE id=" + std::to_string(id) + " due=" + newDue);
+        out.write("Task ").writeInt(id).write(" due-date updated to ").write(newDue).put('\n');
+    } else if (cmd == "import") {
+        const std::string& path = opts.args.at("in");
+        std::string format = opts.args.count("format") ? opts.args.at("format")
+                                                       : TaskImporter::formatFromPath(path);
+        bool keepIds = opts.args.count("keep-ids") > 0;
+        // Отпечаток снимается до чтения: правка файла во время импорта тоже будет замечена
+        bool byReference = opts.args.count("history-by-reference") && path != "-";
+        nlohmann::json stamp = byReference ? HistoryLog::fileStamp(path) : nlohmann::json();
+        std::vector<Task> imported = TaskImporter::readFile(path, format, keepIds ? nullptr : &manager_.ids(),
+                                                             manager_.arena());
+        if (keepIds) {
+            TaskSnapshot current = manager_.snapshot();
+            std::unordered_set<TaskId> ids;
+            ids.reserve(current.size() + imported.size());
+            for (const auto& t : current) {
+                ids.insert(t.getId());
+            }
+            for (const auto& t : imported) {
+                if (!ids.insert(t.getId()).second) {
+                    throw std::runtime_error("Task id " + std::to_string(t.getId()) + " already exists");
+                }
+            }
+        }
+        // Пакет не попадает в стек отмены. В историю — сами задачи пакетными записями по
+        // kImportBatch штук, по --history-per-task — запись на задачу, по
+        // --history-by-reference — одна запись со ссылкой на файл и его отпечатком
+        std::size_t count = imported.size();
+        if (opts.args.count("history-per-task")) {
+            for (const auto& t : imported) {
+                stageHistory(taskRecord("IMPORT", t));
+            }
+        } else if (byReference && count > 0) {
+            stageHistory(importRecord(path, format, keepIds, imported, std::move(stamp)));
+        } else {
+            for (std::size_t i = 0; i < count; i += kImportBatch) {
+                HistoryRecord r;
+                r.op = "IMPORT";
+                r.tasks.assign(imported.begin() + static_cast<std::ptrdiff_t>(i),
+                               imported.begin() + static_cast<std::ptrdiff_t>(std::min(count, i + kImportBatch)));
+                stageHistory(std::move(r));
+            }
+        }
+        if (count > 0) {
+            manager_.appendTasks(std::move(imported));
+            dirty_ = true;
+        }
+        stageLog("IMPORT format=" + format + " in=" + path + " count=" + std::to_string(count));
+        out.write("Imported ").writeInt(static_cast<long long>(count)).write(" tasks from ")
+            .write(path).put('\n');
+    } else if (cmd == "undo" || cmd == "redo") {
+        // Журнал отмены переписывается целиком, поэтому вся операция — под исключительной
+        // блокировкой: до неё подхватываем задачи и записи отмены других процессов,
+        // а сохраняем, не отпуская блокировку
+        std::unique_lock<Storage> exclusive(storage_, std::defer_lock);
+        if (!storage_.locked()) {
+            exclusive.lock();
+        }
+        // Стек отмены должен видеть все предыдущие команды пакета
+        commit();
+        reloadIfChanged();
+        bool isUndo = cmd == "undo";
+        if (isUndo ? !undo_.canUndo() : !undo_.canRedo()) {
+            out.write(isUndo ? "Nothing to undo\n" : "Nothing to redo\n");
+            return;
+        }
+        if (isUndo) {
+            UndoAction undone = undo_.undo(manager_);
+            stageHistory(undone.before ? taskRecord("UNDO", *undone.before)
+                                       : removedRecord("UNDO", undone.after->getId()));
+            stageLog("UNDO");
+            out.write("Last action undone\n");
+        } else {
+            UndoAction redone = undo_.redo(manager_);
+            stageHistory(redone.after ? taskRecord("REDO", *redone.after)
+                                      : removedRecord("REDO", redone.before->getId()));
+            stageLog("REDO");
+            out.write("Last undone action redone\n");
+        }
+        dirty_ = true;
+        commit();
+    } else if (cmd == "history") {
+        // Выборка и восстановление должны видеть записи предыдущих команд пакета
+        commit();
+        if (opts.args.count("replay")) {
+            // Восстановление хранилища на момент --until (по умолчанию — сейчас)
+            std::int64_t until = opts.args.count("until")
+                                     ? HistoryLog::parseTime(opts.args.at("until"))
+                                     : HistoryLog::nowMs();
+            std::string path = opts.args.at("out");
+            std::vector<Task> rebuilt = history_.replay(until);
+            Storage(path, opts.format, opts.args.count("compress") > 0).save(rebuilt);
+            out.write("Replayed ").writeInt(static_cast<long long>(rebuilt.size()))
+                .write(" tasks as of ").write(HistoryLog::formatTime(until))
+                .write(" into ").write(path).put('\n');
+        } else {
+            HistoryFilter filter;
+            if (opts.args.count("since")) filter.sinceMs = HistoryLog::parseTime(opts.args.at("since"));
+            if (opts.args.count("until")) filter.untilMs = HistoryLog::parseTime(opts.args.at("until"));
+            if (opts.args.count("id")) filter.id = std::stoll(opts.args.at("id"));
+            if (opts.args.count("op")) filter.op = opts.args.at("op");
+            bool asJson = opts.output == "json";
+            history_.query(filter, [&](const HistoryRecord& r) {
+                if (asJson) {
+                    out.write(r.toJson().dump()).put('\n');
+                    return;
+                }
+                out.write(HistoryLog::formatTime(r.timestampMs)).put(' ').write(r.op);
+                if (r.id != 0) out.write(" id=").writeInt(r.id);
+                if (r.task) out.put(' ').write(r.task->toJson().dump());
+                if (!r.tasks.empty()) out.write(" tasks=").writeInt(static_cast<long long>(r.tasks.size()));
+                if (r.removed) out.write(" removed");
+                if (!r.extra.empty()) out.put(' ').write(r.extra.dump());
+                out.put('\n');
+            });
+        }
+    } else if (cmd == "batch") {
+        throw std::runtime_error("Nested batch is not supported");
+    } else {
+        throw std::runtime_error("Unknown command: " + cmd);
+    }
+}
+
+bool CommandProcessor::isQuery(const CLIOptions& opts) {
+    return opts.command == "list" || opts.command == "search" || opts.command == "export";
+}
+
+void CommandProcessor::runQuery(const TaskManager& view, const CLIOptions& opts,
+                                OutputWriter& out) {
+    const std::string& cmd = opts.command;
+    if (cmd == "list") {
+        bool overdue = opts.args.count("filter") && opts.args.at("filter") == "overdue";
+        std::vector<Task> tasks = overdue ? view.listOverdue(today())
+                                          : view.listTasks(parseDoneFilter(opts));
+        TaskPrinter printer(out, parseOutputFormat(opts.output));
+        for (const auto& t : tasks) {
+            printer.print(t);
+        }
+        printer.finish();
+    } else if (cmd == "search") {
+        // Текстовый вывод search — прежний "[id] [x] описание": его разбирают скрипты
+        TaskPrinter printer(out, parseOutputFormat(opts.output), false);
+        for (const auto& t : view.searchByDescription(opts.args.at("query"))) {
+            printer.print(t);
+        }
+        printer.finish();
+    } else if (cmd == "export") {
+        const std::string& path = opts.args.at("out");
+        ExportOptions exportOptions;
+        exportOptions.done = parseDoneFilter(opts);
+        if (opts.args.count("delimiter")) {
+            exportOptions.delimiter = parseDelimiter(opts.args.at("delimiter"));
+        }
+        if (opts.args.count("search")) {
+            exportOptions.search = opts.args.at("search");
+        }
+        if (opts.args.count("tag")) {
+            exportOptions.tag = opts.args.at("tag");
+        }
+        exportOptions.compress = opts.args.count("compress") > 0;
+        view.exportAll(opts.args.at("format"), path, exportOptions);
+        out.write("Exported to ").write(path).put('\n');
+    } else {
+        throw std::invalid_argument("Not a query command: " + cmd);
+    }
+}
+
+void CommandProcessor::recordExport(const std::string& format, const std::string& path) {
+    HistoryRecord rec;
+    rec.op = "EXPORT";
+    rec.extra = {{"format", format}, {"out", path}};
+    stageHistory(std::move(rec));
+    stageLog("EXPORT format=" + format + " out=" + path);
+}
+
+const TaskManager& CommandProcessor::manager() const noexcept {
+    return manager_;
+}
+
+void CommandProcessor::commit() {
+    if (!dirty_ && pendingUndo_.empty() && pendingHistory_.empty() && pendingLog_.empty()) {
+        return;
+    }
+    // Сохранение и дописывание журналов — под одной исключительной блокировкой:
+    // иначе другой процесс может вклиниться между ними, перезаписать журнал отмены
+    // или дописать историю, пока индекс считается по старому размеру файла
+    std::unique_lock<Storage> exclusive(storage_, std::defer_lock);
+    if (!storage_.locked()) {
+        exclusive.lock();
+    }
+    if (dirty_) {
+        storage_.save(manager_.snapshot(), manager_.ids().next());
+        dirty_ = false;
+    }
+    for (auto& action : pendingUndo_) {
+        undo_.push(std::move(action));
+    }
+    pendingUndo_.clear();
+    history_.appendAll(std::move(pendingHistory_));
+    pendingHistory_.clear();
+    for (const auto& line : pendingLog_) {
+        logger_.log(line);
+    }
+    pendingLog_.clear();
+}
+
+void CommandProcessor::reload() {
+    // Загруженные задачи перемещаются в менеджер вместе со своим ресурсом (ареной);
+    // генератор ID поднимается до сохранённой границы, а не только до наибольшего ID
+    manager_.setAllTasks(storage_.load(manager_.arena()));
+    manager_.ids().observe(storage_.nextId() - 1);
+    // Журнал отмены мог дописать другой процесс вместе с файлом данных
+    undo_.invalidate();
+    dirty_ = false;
+    pendingUndo_.clear();
+    pendingHistory_.clear();
+    pendingLog_.clear();
+}
+
+bool CommandProcessor::reloadIfChanged() {
+    if (dirty_ || !storage_.changedOnDisk()) {
+        return false;
+    }
+    reload();
+    return true;
+}
+
+bool CommandProcessor::dirty() const noexcept {
+    return dirty_;
+}
+
+BatchResult CommandProcessor::runBatch(std::istream& in, OutputWriter& out, std::ostream& err,
+                                       std::size_t checkpointEvery) {
+    BatchResult result;
+    std::string line;
+    std::size_t lineNo = 0;
+    std::size_t sinceCheckpoint = 0;
+    std::vector<char*> argv;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        try {
+            std::vector<std::string> words = CLIParser::splitCommandLine(line);
+            // parse() ожидает имя программы в argv[0]
+            static char progName[] = "ToDoManager";
+            argv.assign(1, progName);
+            for (auto& w : words) {
+                argv.push_back(&w[0]);
+            }
+            CLIOptions opts = CLIParser::parse(static_cast<int>(argv.size()), argv.data());
+            if (opts.args.count("data-file") || opts.args.count("store-format")) {
+                throw std::runtime_error("--data-file and --store-format are set for the whole batch");
+            }
+            execute(opts, out);
+            ++result.executed;
+        } catch (const std::exception& ex) {
+            // Ошибку печатаем после уже выведенного, чтобы сохранить порядок
+            out.flush();
+            err << "line " << lineNo << ": Error: " << ex.what() << "\n";
+            ++result.failed;
+        }
+        if (checkpointEvery > 0 && ++sinceCheckpoint >= checkpointEvery) {
+            sinceCheckpoint = 0;
+            if (dirty_ || !pendingHistory_.empty()) {
+                commit();
+                ++result.checkpoints;
+            }
+        }
+    }
+    commit();
+    return result;
+}
+
+void CommandProcessor::stage(UndoAction action, HistoryRecord record) {
+    dirty_ = true;
+    pendingUndo_.push_back(std::move(action));
+    stageHistory(std::move(record));
+}
+
+void CommandProcessor::stageHistory(HistoryRecord record) {
+    // Время ставит appendAll() под блокировкой commit(): метки в файле не убывают,
+    // даже если процессы сохраняются не в том порядке, в каком выполняли команды
+    pendingHistory_.push_back(std::move(record));
+}
+
+void CommandProcessor::stageLog(std::string line) {
+    pendingLog_.push_back(std::move(line));
+}
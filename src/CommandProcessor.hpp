@@ -0,0 +1,144 @@
+#pragma once
+
+#include "CLIParser.hpp"
+#include "HistoryLog.hpp"
+#include "Logger.hpp"
+#include "OutputWriter.hpp"
+#include "Storage.hpp"
+#include "TaskManager.hpp"
+#include "UndoStack.hpp"
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Итоги выполнения пакета команд.
+ */
+struct BatchResult {
+    std::size_t executed = 0;    ///< Успешно выполнено команд.
+    std::size_t failed = 0;      ///< Команд, завершившихся ошибкой.
+    std::size_t checkpoints = 0; ///< Промежуточных сохранений (без финального).
+};
+
+/**
+ * @brief Выполняет команды CLI над одним TaskManager в памяти.
+ *
+ * Изменения накапливаются: файл данных сохраняется, а записи отмены, истории и
+ * текстового журнала дописываются только в commit(). Так одиночный запуск делает одно сохранение
+ * на команду, а batch — одно на весь пакет (плюс необязательные контрольные точки).
+ * Журналы отмены и истории не опережают файл данных: если процесс упадёт до commit(),
+ * они не будут ссылаться на несохранённые изменения. Если commit() бросил
+ * StaleDataError (файл изменил другой процесс), после reload() команду можно
+ * выполнить заново — отклонённая попытка не оставляет следов в журналах.
+ * undo и redo переписывают журнал отмены, поэтому выполняются и сохраняются сразу,
+ * под исключительной блокировкой хранилища.
+ */
+class CommandProcessor {
+public:
+    /**
+     * @brief Конструктор; все объекты должны жить дольше процессора.
+     * @param manager Задачи в памяти (загруженные из storage или через reload()).
+     * @param storage Хранилище, в которое сохраняет commit().
+     * @param undo    Стек отмены.
+     * @param history Структурированная история.
+     * @param logger  Текстовый журнал операций.
+     */
+    CommandProcessor(TaskManager& manager, Storage& storage, UndoStack& undo,
+                     HistoryLog& history, Logger& logger);
+
+    /**
+     * @brief Выполняет одну команду; изменения остаются в памяти до commit().
+     * @param opts Разобранная команда (dataFilePath и format не используются).
+     * @param out  Куда писать вывод команды.
+     * @throws std::exception При ошибке команды (состояние в памяти не меняется).
+     */
+    void execute(const CLIOptions& opts, OutputWriter& out);
+
+    /**
+     * @brief Сохраняет накопленные изменения, затем дописывает записи отмены и истории.
+     *
+     * Всё это делается под исключительной блокировкой хранилища (если её ещё не
+     * держит вызывающий, как batch), чтобы журналы разных процессов не перемешивались.
+     * @throws StaleDataError Если файл данных изменил другой процесс (изменения остаются в памяти).
+     * @throws std::runtime_error При ошибке записи.
+     */
+    void commit();
+
+    /**
+     * @brief Перечитывает задачи из хранилища, отбрасывая несохранённые изменения.
+     *
+     * Задачи загружаются в арену менеджера (TaskManager::arena()), если она задана.
+     * Стек отмены забывает прочитанный журнал и при следующем undo/redo перечитает его.
+     * @throws std::runtime_error При ошибке чтения.
+     */
+    void reload();
+
+    /**
+     * @brief Перечитывает задачи, если файл изменил другой процесс и своих
+     *        несохранённых изменений нет.
+     * @return true, если задачи перечитаны.
+     */
+    bool reloadIfChanged();
+
+    /**
+     * @brief Есть ли изменения, ещё не сохранённые commit().
+     */
+    bool dirty() const noexcept;
+
+    /**
+     * @brief Команда только читает задачи (list, search, export) и может выполняться
+     *        через runQuery() над снимком в другом потоке.
+     */
+    static bool isQuery(const CLIOptions& opts);
+
+    /**
+     * @brief Выполняет команду-запрос над заданным списком задач.
+     *
+     * Не трогает журналы, поэтому безопасна для снимка TaskManager в фоновом потоке;
+     * для export запись в историю затем делает recordExport().
+     * @throws std::exception При ошибке команды или если команда не запрос.
+     */
+    static void runQuery(const TaskManager& view, const CLIOptions& opts, OutputWriter& out);
+
+    /**
+     * @brief Записывает в журналы выполненный экспорт (история попадёт в файл при commit()).
+     */
+    void recordExport(const std::string& format, const std::string& path);
+
+    /**
+     * @brief Задачи в памяти (например, для снимка).
+     */
+    const TaskManager& manager() const noexcept;
+
+    /**
+     * @brief Выполняет команды из потока, по одной на строку, и сохраняет результат один раз.
+     *
+     * Пустые строки и строки, начинающиеся с '#', пропускаются. Ошибка в строке
+     * печатается в err как "line N: Error: ..." и не прерывает пакет.
+     * @param in              Источник команд.
+     * @param out             Вывод команд.
+     * @param err             Сообщения об ошибках.
+     * @param checkpointEvery Сохранять после каждых N строк (0 — только в конце).
+     * @return Итоги выполнения.
+     * @throws std::runtime_error При ошибке сохранения.
+     */
+    BatchResult runBatch(std::istream& in, OutputWriter& out, std::ostream& err,
+                         std::size_t checkpointEvery = 0);
+
+private:
+    void stage(UndoAction action, HistoryRecord record);
+    void stageHistory(HistoryRecord record);
+    void stageLog(std::string line);
+
+    TaskManager& manager_;
+    Storage& storage_;
+    UndoStack& undo_;
+    HistoryLog& history_;
+    Logger& logger_;
+
+    bool dirty_ = false;                         ///< Задачи изменены после commit().
+    std::vector<UndoAction> pendingUndo_;        ///< Записи отмены до commit().
+    std::vector<HistoryRecord> pendingHistory_;  ///< Записи истории до commit().
+    std::vector<std::string> pendingLog_;        ///< Строки текстового журнала до commit().
+};
@@ -0,0 +1,466 @@
+#include "Compression.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#if defined(_WIN32) || defined(_WIN64)
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef TODO_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace gzip {
+
+namespace {
+
+constexpr std::size_t kIoSize = 256 * 1024; ///< Буфер сжатых данных.
+
+/// Блок конвейера; finish — закрыть gzip-член после данных блока.
+struct Block {
+    std::string data;
+    bool finish = false;
+};
+
+/**
+ * Ограниченная очередь блоков между вызывающим потоком и потоком конвейера.
+ * Обработанные блоки возвращаются в пул, чтобы не выделять память на каждый блок.
+ */
+class BlockQueue {
+public:
+    // Ждёт места в очереди; бросает ошибку, которую сообщил поток конвейера
+    void push(Block block) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [&] { return queue_.size() < kQueueDepth || error_; });
+        rethrowLocked();
+        queue_.push_back(std::move(block));
+        ++inFlight_;
+        cv_.notify_all();
+    }
+
+    // false — очередь закрыта и пуста
+    bool pop(Block& block) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [&] { return !queue_.empty() || closed_; });
+        if (queue_.empty()) {
+            return false;
+        }
+        block = std::move(queue_.front());
+        queue_.pop_front();
+        cv_.notify_all();
+        return true;
+    }
+
+    // Блок обработан: вернуть строку в пул
+    void done(Block block) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        block.data.clear();
+        free_.push_back(std::move(block.data));
+        --inFlight_;
+        cv_.notify_all();
+    }
+
+    std::string take() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (free_.empty()) {
+            return {};
+        }
+        std::string s = std::move(free_.back());
+        free_.pop_back();
+        return s;
+    }
+
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [&] { return inFlight_ == 0 || error_; });
+        rethrowLocked();
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        closed_ = true;
+        cv_.notify_all();
+    }
+
+    void fail(std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!error_) {
+            error_ = error;
+        }
+        cv_.notify_all();
+    }
+
+    void rethrow() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        rethrowLocked();
+    }
+
+    bool failed() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return static_cast<bool>(error_);
+    }
+
+private:
+    void rethrowLocked() {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<Block> queue_;
+    std::vector<std::string> free_;
+    std::size_t inFlight_ = 0; ///< Переданные, но ещё не обработанные блоки.
+    bool closed_ = false;
+    std::exception_ptr error_;
+};
+
+#ifndef TODO_HAVE_ZLIB
+[[noreturn]] void noZlib() {
+    throw std::runtime_error("gzip compression is not available: built without zlib");
+}
+#else
+int openRead(const std::string& path) {
+#if defined(_WIN32) || defined(_WIN64)
+    return _open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+}
+
+void closeFd(int fd) {
+#if defined(_WIN32) || defined(_WIN64)
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+long readSome(int fd, char* buf, std::size_t size) {
+    while (true) {
+#if defined(_WIN32) || defined(_WIN64)
+        long n = _read(fd, buf, static_cast<unsigned>(size));
+#else
+        long n = static_cast<long>(::read(fd, buf, size));
+#endif
+        if (n >= 0 || errno != EINTR) {
+            return n;
+        }
+    }
+}
+
+void writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+#if defined(_WIN32) || defined(_WIN64)
+        long n = _write(fd, data, static_cast<unsigned>(size));
+#else
+        long n = static_cast<long>(::write(fd, data, size));
+#endif
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("Write error: ") + std::strerror(errno));
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+#endif
+
+} // namespace
+
+bool available() noexcept {
+#ifdef TODO_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool hasExtension(const std::string& path) {
+    return path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0;
+}
+
+std::string stripExtension(const std::string& path) {
+    return hasExtension(path) ? path.substr(0, path.size() - 3) : path;
+}
+
+bool isCompressed(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    unsigned char magic[2] = {};
+    ifs.read(reinterpret_cast<char*>(magic), 2);
+    return ifs.gcount() == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+}
+
+std::string readHead(const std::string& path, std::size_t size) {
+    std::string head(size, '\0');
+#ifdef TODO_HAVE_ZLIB
+    // gzread читает и несжатые файлы как есть
+    gzFile in = gzopen(path.c_str(), "rb");
+    if (!in) {
+        return {};
+    }
+    int n = gzread(in, &head[0], static_cast<unsigned>(size));
+    gzclose(in);
+    head.resize(n > 0 ? static_cast<std::size_t>(n) : 0);
+#else
+    std::ifstream ifs(path, std::ios::binary);
+    ifs.read(&head[0], static_cast<std::streamsize>(size));
+    head.resize(static_cast<std::size_t>(ifs.gcount()));
+#endif
+    return head;
+}
+
+std::string readAll(const std::string& path) {
+    ReadBuf buf(path);
+    std::string out;
+    std::istream in(&buf);
+    in.exceptions(std::ios::badbit);
+    char chunk[64 * 1024];
+    while (in.read(chunk, sizeof(chunk)) || in.gcount() > 0) {
+        out.append(chunk, static_cast<std::size_t>(in.gcount()));
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------- Writer
+
+struct Writer::Impl {
+#ifdef TODO_HAVE_ZLIB
+    Impl(int fd, int level) : fd(fd) {
+        if (deflateInit2(&zs, level, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("Cannot initialize gzip compression");
+        }
+        worker = std::thread([this] { run(); });
+    }
+
+    ~Impl() {
+        queue.close();
+        worker.join();
+        deflateEnd(&zs);
+    }
+
+    void run() {
+        Block block;
+        while (queue.pop(block)) {
+            if (!queue.failed()) {
+                try {
+                    compress(block);
+                } catch (...) {
+                    queue.fail(std::current_exception());
+                }
+            }
+            queue.done(std::move(block));
+        }
+    }
+
+    void compress(const Block& block) {
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data.data()));
+        zs.avail_in = static_cast<uInt>(block.data.size());
+        int flush = block.finish ? Z_FINISH : Z_NO_FLUSH;
+        int ret;
+        do {
+            zs.next_out = reinterpret_cast<Bytef*>(out);
+            zs.avail_out = sizeof(out);
+            ret = deflate(&zs, flush);
+            if (ret == Z_STREAM_ERROR) {
+                throw std::runtime_error("gzip compression failed");
+            }
+            writeAll(fd, out, sizeof(out) - zs.avail_out);
+        } while (zs.avail_out == 0);
+        if (block.finish) {
+            deflateReset(&zs);
+        }
+    }
+
+    int fd;
+    z_stream zs{};
+    char out[kIoSize];
+    BlockQueue queue;
+    std::thread worker;
+#endif
+    bool pending = false;  ///< Есть данные после последнего finish().
+    bool finished = false; ///< Хотя бы один gzip-член записан.
+};
+
+Writer::Writer(int fd, int level) {
+#ifdef TODO_HAVE_ZLIB
+    impl_ = std::make_unique<Impl>(fd, level);
+#else
+    (void)fd;
+    (void)level;
+    noZlib();
+#endif
+}
+
+Writer::~Writer() = default;
+
+void Writer::write(const char* data, std::size_t size) {
+#ifdef TODO_HAVE_ZLIB
+    // Большие куски делим, чтобы очередь держала не больше kQueueDepth блоков по kBlockSize
+    while (size > 0) {
+        std::size_t n = std::min(size, kBlockSize);
+        Block block{impl_->queue.take(), false};
+        block.data.assign(data, n);
+        impl_->queue.push(std::move(block));
+        impl_->pending = true;
+        data += n;
+        size -= n;
+    }
+#else
+    (void)data;
+    (void)size;
+#endif
+}
+
+void Writer::finish() {
+#ifdef TODO_HAVE_ZLIB
+    if (impl_->pending || !impl_->finished) {
+        impl_->queue.push(Block{std::string(), true});
+        impl_->pending = false;
+        impl_->finished = true;
+    }
+    impl_->queue.waitIdle();
+#endif
+}
+
+// ---------------------------------------------------------------- ReadBuf
+
+struct ReadBuf::Impl {
+#ifdef TODO_HAVE_ZLIB
+    explicit Impl(const std::string& path) : path(path) {
+        fd = openRead(path);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) {
+            closeFd(fd);
+            throw std::runtime_error("Cannot initialize gzip decompression");
+        }
+        worker = std::thread([this] { run(); });
+    }
+
+    ~Impl() {
+        // Читатель мог бросить чтение на середине: разблокируем поток конвейера
+        queue.fail(std::make_exception_ptr(std::runtime_error("gzip reader closed")));
+        worker.join();
+        inflateEnd(&zs);
+        closeFd(fd);
+    }
+
+    void run() {
+        try {
+            inflateAll();
+        } catch (...) {
+            queue.fail(std::current_exception());
+        }
+        queue.close();
+    }
+
+    void inflateAll() {
+        std::string block = queue.take();
+        block.resize(kBlockSize);
+        std::size_t used = 0;
+        bool streamEnd = false;
+        bool anyInput = false;
+        while (true) {
+            long n = readSome(fd, in, sizeof(in));
+            if (n < 0) {
+                throw std::runtime_error("Read error: " + path);
+            }
+            if (n == 0) {
+                break;
+            }
+            anyInput = true;
+            zs.next_in = reinterpret_cast<Bytef*>(in);
+            zs.avail_in = static_cast<uInt>(n);
+            while (zs.avail_in > 0) {
+                if (streamEnd) {
+                    // Следующий gzip-член того же файла
+                    inflateReset(&zs);
+                    streamEnd = false;
+                }
+                zs.next_out = reinterpret_cast<Bytef*>(&block[used]);
+                zs.avail_out = static_cast<uInt>(kBlockSize - used);
+                int ret = inflate(&zs, Z_NO_FLUSH);
+                if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                    throw std::runtime_error("Corrupted gzip data in " + path);
+                }
+                used = kBlockSize - zs.avail_out;
+                streamEnd = ret == Z_STREAM_END;
+                if (used == kBlockSize) {
+                    queue.push(Block{std::move(block), false});
+                    block = queue.take();
+                    block.resize(kBlockSize);
+                    used = 0;
+                }
+            }
+        }
+        if (anyInput && !streamEnd) {
+            throw std::runtime_error("Truncated gzip data in " + path);
+        }
+        block.resize(used);
+        if (used > 0) {
+            queue.push(Block{std::move(block), false});
+        }
+    }
+
+    std::string path;
+    int fd = -1;
+    z_stream zs{};
+    char in[kIoSize];
+    BlockQueue queue;
+    std::thread worker;
+#endif
+    bool hasBlock = false; ///< current_ взят из очереди и должен вернуться в пул.
+};
+
+ReadBuf::ReadBuf(const std::string& path) {
+#ifdef TODO_HAVE_ZLIB
+    impl_ = std::make_unique<Impl>(path);
+#else
+    (void)path;
+    noZlib();
+#endif
+}
+
+ReadBuf::~ReadBuf() = default;
+
+ReadBuf::int_type ReadBuf::underflow() {
+#ifdef TODO_HAVE_ZLIB
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    if (impl_->hasBlock) {
+        impl_->queue.done(Block{std::move(current_), false});
+        impl_->hasBlock = false;
+    }
+    Block block;
+    if (!impl_->queue.pop(block)) {
+        impl_->queue.rethrow();
+        return traits_type::eof();
+    }
+    current_ = std::move(block.data);
+    impl_->hasBlock = true;
+    setg(&current_[0], &current_[0], &current_[0] + current_.size());
+    return traits_type::to_int_type(*gptr());
+#else
+    return traits_type::eof();
+#endif
+}
+
+} // namespace gzip
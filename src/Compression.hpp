@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+/**
+ * @brief Прозрачное сжатие gzip (zlib) для файлов данных и экспорта.
+ *
+ * Сжатие и распаковка идут конвейером в отдельном потоке: пока он сжимает один
+ * блок (или читает и распаковывает следующий), вызывающий поток готовит данные или
+ * разбирает уже распакованные. Очередь ограничена kQueueDepth блоками, поэтому
+ * память не растёт, если одна сторона медленнее. Файл может состоять из нескольких
+ * gzip-членов подряд — так его пишет Writer после каждого finish().
+ * Без zlib (сборка без TODO_HAVE_ZLIB) конструкторы бросают std::runtime_error.
+ */
+namespace gzip {
+
+constexpr std::size_t kQueueDepth = 4;          ///< Блоков в очереди конвейера.
+constexpr std::size_t kBlockSize = 1024 * 1024; ///< Размер распакованного блока при чтении.
+
+/**
+ * @brief Есть ли в сборке поддержка zlib.
+ */
+bool available() noexcept;
+
+/**
+ * @brief Оканчивается ли путь на ".gz".
+ */
+bool hasExtension(const std::string& path);
+
+/**
+ * @brief Путь без ".gz" (tasks.csv.gz → tasks.csv), чтобы определить формат по расширению.
+ */
+std::string stripExtension(const std::string& path);
+
+/**
+ * @brief Сжат ли файл: проверяет сигнатуру gzip (1f 8b), а не расширение.
+ * @return false, если файла нет.
+ */
+bool isCompressed(const std::string& path);
+
+/**
+ * @brief Читает начало файла, распаковывая его, если он сжат.
+ * @param path Путь к файлу.
+ * @param size Сколько байт прочитать (меньше, если файл короче).
+ * @return Прочитанные байты (пусто, если файла нет).
+ */
+std::string readHead(const std::string& path, std::size_t size);
+
+/**
+ * @brief Распаковывает файл целиком в память (распаковка — в потоке конвейера).
+ * @throws std::runtime_error Если файл не открылся или повреждён.
+ */
+std::string readAll(const std::string& path);
+
+/**
+ * @brief Сжимает поток байт в файловый дескриптор в фоновом потоке.
+ */
+class Writer {
+public:
+    /**
+     * @brief Запускает поток сжатия.
+     * @param fd    Открытый дескриптор; владение не передаётся, он должен жить дольше писателя.
+     * @param level Уровень сжатия zlib (1 — быстрее, 9 — плотнее). По умолчанию 1: файл
+     *              данных переписывается при каждом сохранении, а текст задач и так сжимается
+     *              в 10+ раз — уровень 6 дал бы ~10% размера ценой вдвое более долгой записи.
+     * @throws std::runtime_error Если сборка без zlib.
+     */
+    explicit Writer(int fd, int level = 1);
+
+    /**
+     * @brief Останавливает поток; без finish() последний gzip-член останется незавершённым.
+     */
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    /**
+     * @brief Передаёт данные потоку сжатия (копирует их; ждёт, если очередь полна).
+     * @throws std::runtime_error Если предыдущий блок не удалось сжать или записать.
+     */
+    void write(const char* data, std::size_t size);
+
+    /**
+     * @brief Дожимает переданные данные, закрывает gzip-член и ждёт записи в дескриптор.
+     *
+     * После finish() можно писать дальше — данные пойдут в следующий член. Если
+     * с прошлого finish() ничего не передано, ничего не пишет (кроме самого первого раза:
+     * пустой файл тоже должен быть корректным gzip).
+     * @throws std::runtime_error При ошибке сжатия или записи.
+     */
+    void finish();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @brief Буфер потока, распаковывающий gzip-файл в фоновом потоке.
+ *
+ * Использование: gzip::ReadBuf buf(path); std::istream in(&buf);
+ * in.exceptions(std::ios::badbit) — тогда ошибка распаковки дойдёт до вызывающего,
+ * а не превратится в конец файла.
+ */
+class ReadBuf : public std::streambuf {
+public:
+    /**
+     * @brief Открывает файл и запускает поток распаковки.
+     * @throws std::runtime_error Если файл не открылся или сборка без zlib.
+     */
+    explicit ReadBuf(const std::string& path);
+    ~ReadBuf() override;
+
+    ReadBuf(const ReadBuf&) = delete;
+    ReadBuf& operator=(const ReadBuf&) = delete;
+
+protected:
+    int_type underflow() override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+    std::string current_; ///< Распакованный блок, который сейчас читается.
+};
+
+} // namespace gzip
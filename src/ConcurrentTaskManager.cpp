@@ -0,0 +1,74 @@
+#include "ConcurrentTaskManager.hpp"
+
+ConcurrentTaskManager::ConcurrentTaskManager()
+    : current_(std::make_shared<const TaskSnapshot>()) {}
+
+ConcurrentTaskManager::ConcurrentTaskManager(TaskSnapshot snapshot)
+    : current_(std::make_shared<const TaskSnapshot>(std::move(snapshot))) {
+    for (const auto& t : *current_) {
+        ids_->observe(t.getId());
+    }
+}
+
+TaskSnapshot ConcurrentTaskManager::snapshot() const {
+    return *std::atomic_load(&current_);
+}
+
+std::vector<Task> ConcurrentTaskManager::listTasks(const std::optional<bool>& showDone) const {
+    return TaskManager(snapshot(), ids_).listTasks(showDone);
+}
+
+std::vector<Task> ConcurrentTaskManager::searchByDescription(const std::string& substr) const {
+    return TaskManager(snapshot(), ids_).searchByDescription(substr);
+}
+
+Task ConcurrentTaskManager::getTask(TaskId id) const {
+    return TaskManager(snapshot(), ids_).getTask(id);
+}
+
+std::size_t ConcurrentTaskManager::size() const {
+    return std::atomic_load(&current_)->size();
+}
+
+void ConcurrentTaskManager::exportAll(const std::string& format, const std::string& outPath,
+                                      const ExportOptions& options) const {
+    TaskManager(snapshot(), ids_).exportAll(format, outPath, options);
+}
+
+TaskId ConcurrentTaskManager::addTask(const std::string& description,
+                                   const std::optional<std::string>& dueDate,
+                                   const std::vector<std::string>& tags) {
+    return update([&](TaskManager& m) { return m.addTask(description, dueDate, tags); });
+}
+
+void ConcurrentTaskManager::removeTask(TaskId id) {
+    update([&](TaskManager& m) { m.removeTask(id); });
+}
+
+void ConcurrentTaskManager::markDone(TaskId id) {
+    update([&](TaskManager& m) { m.markDone(id); });
+}
+
+void ConcurrentTaskManager::updateDueDate(TaskId id, const std::string& newDueDate) {
+    update([&](TaskManager& m) { m.updateDueDate(id, newDueDate); });
+}
+
+void ConcurrentTaskManager::addTag(TaskId id, const std::string& tag) {
+    update([&](TaskManager& m) { m.addTag(id, tag); });
+}
+
+void ConcurrentTaskManager::removeTag(TaskId id, const std::string& tag) {
+    update([&](TaskManager& m) { m.removeTag(id, tag); });
+}
+
+void ConcurrentTaskManager::setAllTasks(const std::vector<Task>& tasks) {
+    update([&](TaskManager& m) { m.setAllTasks(tasks); });
+}
+
+void ConcurrentTaskManager::setAllTasks(std::vector<Task>&& tasks) {
+    update([&](TaskManager& m) { m.setAllTasks(std::move(tasks)); });
+}
+
+void ConcurrentTaskManager::publish(const TaskManager& working) {
+    std::atomic_store(&current_, std::make_shared<const TaskSnapshot>(working.snapshot()));
+}
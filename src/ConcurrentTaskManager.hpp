@@ -0,0 +1,95 @@
+#pragma once
+
+#include "TaskManager.hpp"
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Потокобезопасный TaskManager с неблокирующимися читателями (RCU-подобная схема).
+ *
+ * Текущее состояние — неизменяемый снимок, опубликованный через атомарный shared_ptr.
+ * Читатель берёт снимок одной атомарной загрузкой и дальше работает с ним без блокировок,
+ * сколько бы ни длилась операция; запись не ждёт читателей. Писатели сериализуются
+ * мьютексом: изменение применяется к O(1)-копии снимка (PersistentVector копирует только
+ * затронутый блок) и публикуется новым снимком. Старый снимок освобождает последний
+ * читатель, который его держит.
+ *
+ * Генератор ID общий для всех рабочих копий: новые ID выдаются атомарно и без прохода
+ * по снимку.
+ *
+ * Чтение с фильтром — один проход по снимку: таблица столбцов (TaskTable) для каждого
+ * опубликованного снимка не строится.
+ */
+class ConcurrentTaskManager {
+public:
+    ConcurrentTaskManager();
+
+    /**
+     * @brief Создаёт менеджер с начальным списком задач.
+     * @param snapshot Начальное состояние.
+     */
+    explicit ConcurrentTaskManager(TaskSnapshot snapshot);
+
+    /**
+     * @brief Текущий снимок за O(1); никогда не блокируется писателями.
+     */
+    TaskSnapshot snapshot() const;
+
+    /**
+     * @brief Атомарно применяет изменение и публикует результат.
+     *
+     * Если mutation бросает исключение, опубликованное состояние не меняется.
+     * @param mutation Функция вида R(TaskManager&), выполняется под мьютексом писателей.
+     * @return Значение, которое вернула mutation.
+     */
+    template <typename Mutation>
+    auto update(Mutation&& mutation) -> std::invoke_result_t<Mutation&, TaskManager&> {
+        std::lock_guard<std::mutex> lock(writeMtx_);
+        TaskManager working(*std::atomic_load(&current_), ids_);
+        if constexpr (std::is_void_v<std::invoke_result_t<Mutation&, TaskManager&>>) {
+            mutation(working);
+            publish(working);
+        } else {
+            auto result = mutation(working);
+            publish(working);
+            return result;
+        }
+    }
+
+    /// @name Чтение (по текущему снимку, без блокировок)
+    /// @{
+    std::vector<Task> listTasks(const std::optional<bool>& showDone = std::nullopt) const;
+    std::vector<Task> searchByDescription(const std::string& substr) const;
+    /**
+     * @brief Копия задачи по ID (ссылку на задачу в снимке вернуть нельзя).
+     * @throws std::runtime_error Если задача не найдена.
+     */
+    Task getTask(TaskId id) const;
+    std::size_t size() const;
+    void exportAll(const std::string& format, const std::string& outPath,
+                   const ExportOptions& options = {}) const;
+    /// @}
+
+    /// @name Запись (каждый вызов публикует новый снимок)
+    /// @{
+    TaskId addTask(const std::string& description,
+                const std::optional<std::string>& dueDate = std::nullopt,
+                const std::vector<std::string>& tags = {});
+    void removeTask(TaskId id);
+    void markDone(TaskId id);
+    void updateDueDate(TaskId id, const std::string& newDueDate);
+    void addTag(TaskId id, const std::string& tag);
+    void removeTag(TaskId id, const std::string& tag);
+    void setAllTasks(const std::vector<Task>& tasks);
+    void setAllTasks(std::vector<Task>&& tasks);
+    /// @}
+
+private:
+    void publish(const TaskManager& working);
+
+    std::shared_ptr<const TaskSnapshot> current_; ///< Опубликованный снимок (atomic_load/store).
+    std::mutex writeMtx_;                         ///< Сериализует писателей.
+    std::shared_ptr<IdAllocator> ids_ = std::make_shared<IdAllocator>(); ///< Генератор ID.
+};
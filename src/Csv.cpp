@@ -0,0 +1,182 @@
+#include "Csv.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::uint64_t kOnes = 0x0101010101010101ULL;
+constexpr std::uint64_t kHighBits = 0x8080808080808080ULL;
+
+// Ненулевое, если в слове есть байт b (классический приём "has zero byte")
+inline std::uint64_t hasByte(std::uint64_t word, unsigned char b) noexcept {
+    std::uint64_t x = word ^ (kOnes * b);
+    return (x - kOnes) & ~x & kHighBits;
+}
+
+} // namespace
+
+CsvReader::CsvReader(std::istream& in, char delimiter)
+    : in_(in), delimiter_(delimiter), buffer_(kBufferSize) {
+    special_[static_cast<unsigned char>(delimiter)] = true;
+    special_[static_cast<unsigned char>('"')] = true;
+    special_[static_cast<unsigned char>('\n')] = true;
+    special_[static_cast<unsigned char>('\r')] = true;
+}
+
+bool CsvReader::fill() {
+    in_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    end_ = static_cast<std::size_t>(in_.gcount());
+    pos_ = 0;
+    return end_ > 0;
+}
+
+bool CsvReader::next(std::vector<std::string>& fields) {
+    if (pos_ == end_ && !fill()) {
+        return false;
+    }
+    recordLine_ = nextLine_;
+    std::size_t count = 0;
+    auto startField = [&]() -> std::string& {
+        if (count == fields.size()) {
+            fields.emplace_back();
+        }
+        std::string& field = fields[count++];
+        field.clear();
+        return field;
+    };
+
+    enum class State { Unquoted, Quoted, QuoteInQuoted };
+    State state = State::Unquoted;
+    bool fieldStart = true;
+    std::string* field = &startField();
+    while (true) {
+        if (pos_ == end_ && !fill()) {
+            if (state == State::Quoted) {
+                throw std::runtime_error("CSV: unterminated quoted field starting at line "
+                                         + std::to_string(recordLine_));
+            }
+            break;
+        }
+        if (state == State::Quoted) {
+            // Быстрый проход до кавычки; переводы строк внутри поля только считаем
+            std::size_t start = pos_;
+            while (pos_ < end_ && buffer_[pos_] != '"') {
+                if (buffer_[pos_] == '\n') {
+                    ++nextLine_;
+                }
+                ++pos_;
+            }
+            field->append(buffer_.data() + start, pos_ - start);
+            if (pos_ < end_) {
+                ++pos_;
+                state = State::QuoteInQuoted;
+            }
+            continue;
+        }
+        char c = buffer_[pos_];
+        if (state == State::QuoteInQuoted) {
+            state = State::Unquoted;
+            if (c == '"') {
+                // "" внутри кавычек — сама кавычка
+                field->push_back('"');
+                ++pos_;
+                state = State::Quoted;
+                continue;
+            }
+        }
+        if (!special_[static_cast<unsigned char>(c)]) {
+            // Быстрый проход по обычным символам поля
+            std::size_t start = pos_;
+            while (pos_ < end_ && !special_[static_cast<unsigned char>(buffer_[pos_])]) {
+                ++pos_;
+            }
+            field->append(buffer_.data() + start, pos_ - start);
+            fieldStart = false;
+            continue;
+        }
+        ++pos_;
+        if (c == delimiter_) {
+            field = &startField();
+            fieldStart = true;
+        } else if (c == '\n') {
+            ++nextLine_;
+            break;
+        } else if (c == '"') {
+            if (fieldStart) {
+                state = State::Quoted;
+                fieldStart = false;
+            } else {
+                // Кавычка посреди поля без кавычек — принимаем как есть
+                field->push_back('"');
+            }
+        }
+        // '\r' вне кавычек пропускаем: это часть \r\n
+    }
+    fields.resize(count);
+    return true;
+}
+
+std::size_t CsvReader::line() const noexcept {
+    return recordLine_;
+}
+
+CsvWriter::CsvWriter(OutputWriter& out, char delimiter)
+    : out_(out), delimiter_(delimiter) {}
+
+bool CsvWriter::needsQuoting(std::string_view value, char delimiter) noexcept {
+    const char* p = value.data();
+    std::size_t n = value.size();
+    std::size_t i = 0;
+    unsigned char d = static_cast<unsigned char>(delimiter);
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if (hasByte(word, '"') | hasByte(word, d) | hasByte(word, '\n') | hasByte(word, '\r')) {
+            return true;
+        }
+    }
+    for (; i < n; ++i) {
+        char c = p[i];
+        if (c == '"' || c == delimiter || c == '\n' || c == '\r') {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CsvWriter::separate() {
+    if (!firstInRecord_) {
+        out_.put(delimiter_);
+    }
+    firstInRecord_ = false;
+}
+
+CsvWriter& CsvWriter::field(std::string_view value) {
+    separate();
+    if (!needsQuoting(value, delimiter_)) {
+        out_.write(value);
+        return *this;
+    }
+    out_.put('"');
+    std::size_t runStart = 0;
+    for (std::size_t quote = value.find('"'); quote != std::string_view::npos;
+         quote = value.find('"', quote + 1)) {
+        // Кавычка удваивается: пишем кусок вместе с ней и ещё одну
+        out_.write(value.substr(runStart, quote + 1 - runStart)).put('"');
+        runStart = quote + 1;
+    }
+    out_.write(value.substr(runStart)).put('"');
+    return *this;
+}
+
+CsvWriter& CsvWriter::field(long long value) {
+    separate();
+    out_.writeInt(value);
+    return *this;
+}
+
+void CsvWriter::endRecord() {
+    out_.write("\r\n");
+    firstInRecord_ = true;
+}
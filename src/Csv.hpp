@@ -0,0 +1,98 @@
+#pragma once
+
+#include "OutputWriter.hpp"
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Потоковый разбор CSV (RFC 4180).
+ *
+ * Читает поток блоками по kBufferSize байт и отдаёт по одной записи. Поле в
+ * двойных кавычках может содержать разделитель, перевод строки и кавычку,
+ * записанную как "". Строки полей переиспользуются между записями, поэтому
+ * разбор большого файла почти не выделяет память. Конец строки — \n или \r\n.
+ */
+class CsvReader {
+public:
+    static constexpr std::size_t kBufferSize = 1024 * 1024; ///< Размер блока чтения.
+
+    /**
+     * @brief Конструктор.
+     * @param in        Источник; должен жить дольше читателя.
+     * @param delimiter Разделитель полей.
+     */
+    explicit CsvReader(std::istream& in, char delimiter = ',');
+
+    /**
+     * @brief Читает следующую запись.
+     * @param fields Сюда записываются поля (размер вектора — число полей).
+     * @return false, если поток закончился.
+     * @throws std::runtime_error Если кавычки не закрыты до конца файла.
+     */
+    bool next(std::vector<std::string>& fields);
+
+    /**
+     * @brief Номер строки файла, с которой началась последняя запись (с 1).
+     */
+    std::size_t line() const noexcept;
+
+private:
+    bool fill();
+
+    std::istream& in_;
+    char delimiter_;
+    std::vector<char> buffer_;
+    std::size_t pos_ = 0;        ///< Следующий непрочитанный байт buffer_.
+    std::size_t end_ = 0;        ///< Конец данных в buffer_.
+    std::size_t nextLine_ = 1;   ///< Строка, на которой стоит pos_.
+    std::size_t recordLine_ = 0; ///< Строка начала последней записи.
+    bool special_[256] = {};     ///< Символы, прерывающие быстрый проход по полю.
+};
+
+/**
+ * @brief Запись CSV по RFC 4180 поверх OutputWriter.
+ *
+ * Поле берётся в кавычки, только если содержит разделитель, кавычку, \r или \n;
+ * кавычки внутри удваиваются. Проверка идёт по 8 байт за шаг (SWAR), так что
+ * обычные поля копируются в буфер без посимвольного разбора. Записи
+ * заканчиваются на \r\n.
+ */
+class CsvWriter {
+public:
+    /**
+     * @brief Конструктор.
+     * @param out       Приёмник; должен жить дольше писателя.
+     * @param delimiter Разделитель полей.
+     */
+    explicit CsvWriter(OutputWriter& out, char delimiter = ',');
+
+    /**
+     * @brief Пишет строковое поле (с кавычками, если нужно).
+     */
+    CsvWriter& field(std::string_view value);
+
+    /**
+     * @brief Пишет целое поле.
+     */
+    CsvWriter& field(long long value);
+
+    /**
+     * @brief Завершает запись.
+     */
+    void endRecord();
+
+    /**
+     * @brief Нужно ли брать значение в кавычки при данном разделителе.
+     */
+    static bool needsQuoting(std::string_view value, char delimiter) noexcept;
+
+private:
+    void separate();
+
+    OutputWriter& out_;
+    char delimiter_;
+    bool firstInRecord_ = true;
+};
@@ -0,0 +1,188 @@
+#include "DatasetGenerator.hpp"
+#include "TaskTable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// xoshiro256** (Blackman, Vigna); состояние заполняется splitmix64 из зерна
+class Random {
+public:
+    explicit Random(std::uint64_t seed) noexcept {
+        for (auto& word : state_) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    std::uint64_t next() noexcept {
+        const std::uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        const std::uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    // Равномерно в [0, 1)
+    double uniform() noexcept { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    // Равномерно в [0, n)
+    std::uint64_t below(std::uint64_t n) noexcept {
+        return std::min(static_cast<std::uint64_t>(uniform() * static_cast<double>(n)), n - 1);
+    }
+
+    bool chance(double p) noexcept { return uniform() < p; }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+
+    std::uint64_t state_[4];
+};
+
+const char* const kWords[] = {
+    "buy",     "milk",    "call",   "review", "report", "fix",      "deploy",  "meeting",
+    "with",    "team",    "update", "draft",  "email",  "invoice",  "plan",    "sprint",
+    "book",    "tickets", "clean",  "garage", "pay",    "rent",     "write",   "tests",
+    "prepare", "slides",  "check",  "backup", "renew",  "passport", "release", "notes",
+};
+constexpr std::size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+// Обратный к days_from_civil (TaskTable::parseDate): дни от 1970-01-01 → YYYY-MM-DD
+void formatDate(std::int32_t days, char (&out)[11]) {
+    const int z = days + 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const int doe = z - era * 146097;
+    const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int mp = (5 * doy + 2) / 153;
+    const int d = doy - (153 * mp + 2) / 5 + 1;
+    const int m = mp < 10 ? mp + 3 : mp - 9;
+    const int y = yoe + era * 400 + (m <= 2);
+    auto digits = [&out](std::size_t pos, std::size_t len, int value) {
+        for (std::size_t i = pos + len; i-- > pos; value /= 10) {
+            out[i] = static_cast<char>('0' + value % 10);
+        }
+    };
+    digits(0, 4, y);
+    out[4] = '-';
+    digits(5, 2, m);
+    out[7] = '-';
+    digits(8, 2, d);
+    out[10] = '\0';
+}
+
+} // namespace
+
+DatasetGenerator::DatasetGenerator(DatasetOptions options) : options_(std::move(options)) {
+    if (options_.minDescription == 0 || options_.minDescription > options_.maxDescription) {
+        throw std::invalid_argument("Description length range is empty");
+    }
+    auto isFraction = [](double p) { return p >= 0.0 && p <= 1.0; };
+    if (!isFraction(options_.doneFraction) || !isFraction(options_.dueFraction)) {
+        throw std::invalid_argument("Done and due fractions must be within [0, 1]");
+    }
+    if (options_.maxTags > 0 && options_.tagVocabulary == 0) {
+        throw std::invalid_argument("Tags requested with an empty tag vocabulary");
+    }
+    if (options_.tagSkew < 0.0) {
+        throw std::invalid_argument("Tag skew must not be negative");
+    }
+    auto from = TaskTable::parseDate(options_.dueFrom);
+    if (!from) {
+        throw std::invalid_argument("Invalid due date (expected YYYY-MM-DD): " + options_.dueFrom);
+    }
+    dueFrom_ = *from;
+    if (options_.dueSpreadDays == 0) {
+        options_.dueSpreadDays = 1;
+    }
+
+    // P(rank k) ∝ 1 / k^s
+    tagCdf_.reserve(options_.tagVocabulary);
+    double total = 0.0;
+    for (std::size_t k = 1; k <= options_.tagVocabulary; ++k) {
+        total += 1.0 / std::pow(static_cast<double>(k), options_.tagSkew);
+        tagCdf_.push_back(total);
+    }
+    for (auto& p : tagCdf_) {
+        p /= total;
+    }
+}
+
+void DatasetGenerator::generate(const std::function<void(const Task&)>& sink) const {
+    Random random(options_.seed);
+    // Строки очередной задачи живут в буфере на стеке и освобождаются после sink
+    alignas(std::max_align_t) std::byte buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+    std::vector<std::size_t> ranks;
+    ranks.reserve(options_.maxTags);
+    const std::size_t lengthSpread = options_.maxDescription - options_.minDescription + 1;
+
+    for (std::size_t i = 1; i <= options_.count; ++i) {
+        {
+            Task::allocator_type alloc(&arena);
+            const std::size_t length = options_.minDescription + random.below(lengthSpread);
+            Task::String description(alloc);
+            description.reserve(length + 16);
+            while (description.size() < length) {
+                if (!description.empty()) {
+                    description.push_back(' ');
+                }
+                description.append(kWords[random.below(kWordCount)]);
+            }
+            description.resize(length);
+            if (description.back() == ' ') {
+                description.back() = '.';
+            }
+
+            std::optional<Task::String> due;
+            if (random.chance(options_.dueFraction)) {
+                char date[11];
+                formatDate(dueFrom_ + static_cast<std::int32_t>(random.below(options_.dueSpreadDays)),
+                           date);
+                due.emplace(date, alloc);
+            }
+            const bool done = random.chance(options_.doneFraction);
+
+            Task::TagList tags(alloc);
+            ranks.clear();
+            const std::size_t tagCount = options_.maxTags == 0 ? 0 : random.below(options_.maxTags + 1);
+            for (std::size_t k = 0; k < tagCount; ++k) {
+                auto it = std::upper_bound(tagCdf_.begin(), tagCdf_.end(), random.uniform());
+                std::size_t rank = std::min<std::size_t>(static_cast<std::size_t>(it - tagCdf_.begin()),
+                                                         tagCdf_.size() - 1) + 1;
+                // Повторный тег не добавляем: задача получит меньше тегов
+                if (std::find(ranks.begin(), ranks.end(), rank) == ranks.end()) {
+                    ranks.push_back(rank);
+                    tags.emplace_back(tagName(rank));
+                }
+            }
+
+            Task task(static_cast<TaskId>(i), std::in_place, std::move(description), std::move(due),
+                      std::move(tags));
+            if (done) {
+                task.markDone();
+            }
+            sink(task);
+        }
+        arena.release();
+    }
+}
+
+TaskId DatasetGenerator::nextId() const noexcept {
+    return static_cast<TaskId>(options_.count) + 1;
+}
+
+std::string DatasetGenerator::tagName(std::size_t rank) {
+    return "tag-" + std::to_string(rank);
+}
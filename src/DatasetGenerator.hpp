@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Task.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Параметры синтетического набора задач.
+ */
+struct DatasetOptions {
+    std::size_t count = 1000;           ///< Число задач (ID от 1 до count).
+    std::uint64_t seed = 1;             ///< Зерно: одинаковые параметры дают одинаковый набор.
+    std::size_t minDescription = 16;    ///< Минимальная длина описания в байтах.
+    std::size_t maxDescription = 80;    ///< Максимальная длина (равномерно в [min, max]).
+    std::size_t tagVocabulary = 1000;   ///< Число разных тегов: tag-1 … tag-N.
+    double tagSkew = 1.0;               ///< Показатель s закона Ципфа для тегов (0 — равномерно).
+    std::size_t maxTags = 3;            ///< Тегов у задачи: равномерно от 0 до maxTags, без повторов.
+    double doneFraction = 0.3;          ///< Доля выполненных задач.
+    double dueFraction = 0.5;           ///< Доля задач с дедлайном.
+    std::string dueFrom = "2025-01-01"; ///< Самый ранний дедлайн.
+    std::uint32_t dueSpreadDays = 365;  ///< Дедлайны равномерно в [dueFrom, dueFrom + spread).
+};
+
+/**
+ * @brief Детерминированный генератор задач для нагрузочных тестов и замеров.
+ *
+ * Псевдослучайные числа — xoshiro256** с зерном DatasetOptions::seed, а равномерные
+ * и ципфовские величины считаются здесь же, без std::*_distribution (их результат
+ * зависит от стандартной библиотеки): набор одинаков на всех платформах.
+ *
+ * Задачи не копятся в списке: generate() строит очередную задачу в буфере на стеке
+ * и отдаёт её в sink, поэтому набор любого размера пишется потоково
+ * (Storage::saveStream()) в памяти O(1).
+ */
+class DatasetGenerator {
+public:
+    /**
+     * @throws std::invalid_argument Если параметры противоречивы (min > max, доля вне [0, 1],
+     *         дата не YYYY-MM-DD, теги без словаря).
+     */
+    explicit DatasetGenerator(DatasetOptions options);
+
+    /**
+     * @brief Передаёт в sink задачи с ID 1 … count по порядку.
+     *
+     * Задача действительна только во время вызова sink.
+     */
+    void generate(const std::function<void(const Task&)>& sink) const;
+
+    /**
+     * @brief Граница ID набора (count + 1) для Storage::saveStream().
+     */
+    TaskId nextId() const noexcept;
+
+    /**
+     * @brief Имя тега с рангом rank (1 — самый частый).
+     */
+    static std::string tagName(std::size_t rank);
+
+private:
+    DatasetOptions options_;
+    std::vector<double> tagCdf_; ///< Накопленные вероятности рангов тегов.
+    std::int32_t dueFrom_ = 0;   ///< dueFrom в днях от 1970-01-01.
+};
@@ -0,0 +1,60 @@
+#include "FileLock.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+
+FileLock::FileLock(const std::string& path, Mode mode) {
+    HANDLE h = ::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                             OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open lock file: " + path);
+    }
+    OVERLAPPED ov{};
+    DWORD flags = mode == Mode::Exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0;
+    if (!::LockFileEx(h, flags, 0, MAXDWORD, MAXDWORD, &ov)) {
+        ::CloseHandle(h);
+        throw std::runtime_error("Cannot lock file: " + path);
+    }
+    handle_ = h;
+}
+
+FileLock::~FileLock() {
+    OVERLAPPED ov{};
+    ::UnlockFileEx(static_cast<HANDLE>(handle_), 0, MAXDWORD, MAXDWORD, &ov);
+    ::CloseHandle(static_cast<HANDLE>(handle_));
+}
+
+#else
+
+FileLock::FileLock(const std::string& path, Mode mode) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open lock file " + path + ": " + std::strerror(errno));
+    }
+    int op = mode == Mode::Exclusive ? LOCK_EX : LOCK_SH;
+    while (::flock(fd_, op) != 0) {
+        if (errno != EINTR) {
+            int err = errno;
+            ::close(fd_);
+            throw std::runtime_error("Cannot lock file " + path + ": " + std::strerror(err));
+        }
+    }
+}
+
+FileLock::~FileLock() {
+    // close() снимает flock
+    ::close(fd_);
+}
+
+#endif
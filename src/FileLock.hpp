@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Межпроцессная рекомендательная (advisory) блокировка файла.
+ *
+ * На POSIX — flock(), в Windows — LockFileEx(). Блокировка держится на открытом
+ * дескрипторе и снимается в деструкторе или при завершении процесса, поэтому
+ * упавший процесс не оставляет файл заблокированным. Блокируется отдельный файл
+ * (например, tasks.json.lock), а не сами данные: их заменяют переименованием.
+ * Внутри одного процесса повторный захват через другой FileLock не рекурсивен.
+ */
+class FileLock {
+public:
+    enum class Mode {
+        Shared,    ///< Читатели не мешают друг другу.
+        Exclusive  ///< Один писатель, без читателей.
+    };
+
+    /**
+     * @brief Открывает (создаёт при необходимости) файл блокировки и ждёт захвата.
+     * @param path Путь к файлу блокировки.
+     * @param mode Тип блокировки.
+     * @throws std::runtime_error Если файл не открылся или захват не удался.
+     */
+    FileLock(const std::string& path, Mode mode);
+
+    /**
+     * @brief Снимает блокировку и закрывает файл.
+     */
+    ~FileLock();
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+private:
+#if defined(_WIN32) || defined(_WIN64)
+    void* handle_ = nullptr; ///< HANDLE файла блокировки.
+#else
+    int fd_ = -1;            ///< Дескриптор файла блокировки.
+#endif
+};
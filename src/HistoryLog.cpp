@@ -0,0 +1,406 @@
+#include "HistoryLog.hpp"
+#include "OutputWriter.hpp"
+#include "TaskImporter.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+/// Точка разреженного индекса: время записи и её смещение в файле истории.
+struct IndexEntry {
+    std::int64_t timestampMs;
+    std::uint64_t offset;
+};
+
+constexpr std::size_t kWriteChunk = 1024 * 1024; ///< Порог сброса буфера appendAll().
+
+// Число дней от 1970-01-01 до заданной даты (алгоритм Говарда Хиннанта)
+std::int64_t daysFromCivil(std::int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+void civilFromDays(std::int64_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(static_cast<std::int64_t>(yoe) + era * 400 + (m <= 2));
+}
+
+// Задачи импорта, записанного по ссылке: исходный файл читается заново,
+// если он не изменился с момента импорта
+std::vector<Task> reimport(const HistoryRecord& r) {
+    std::string path = r.extra.at("in").get<std::string>();
+    bool keepIds = r.extra.value("keepIds", false);
+    std::vector<Task> tasks;
+    try {
+        if (HistoryLog::fileStamp(path) != r.extra.at("stamp")) {
+            throw std::runtime_error("file changed since the import");
+        }
+        IdAllocator scratch;
+        tasks = TaskImporter::readFile(path, r.extra.at("format").get<std::string>(),
+                                       keepIds ? nullptr : &scratch);
+    } catch (const std::exception& ex) {
+        throw std::runtime_error("Cannot replay import of " + path + ": " + ex.what());
+    }
+    if (tasks.size() != r.extra.at("count").get<std::size_t>()) {
+        throw std::runtime_error("Cannot replay import of " + path + ": file changed since the import");
+    }
+    if (keepIds) {
+        return tasks;
+    }
+    // ID, выданные при импорте, — отрезками в порядке файла
+    std::size_t i = 0;
+    std::vector<std::string> tags;
+    for (const auto& range : r.extra.at("ids")) {
+        TaskId last = range.at(1).get<TaskId>();
+        for (TaskId id = range.at(0).get<TaskId>(); id <= last && i < tasks.size(); ++id, ++i) {
+            const Task& t = tasks[i];
+            tags.assign(t.getTags().begin(), t.getTags().end());
+            const auto& due = t.getDueDate();
+            tasks[i] = Task::restore(id, t.getDescription(),
+                                     due ? std::optional<std::string_view>(*due) : std::nullopt,
+                                     t.isDone(), tags);
+        }
+    }
+    if (i != tasks.size()) {
+        throw std::runtime_error("Cannot replay import of " + path + ": id ranges do not match the file");
+    }
+    return tasks;
+}
+
+} // namespace
+
+nlohmann::json HistoryRecord::toJson() const {
+    nlohmann::json j = extra.is_object() ? extra : nlohmann::json::object();
+    j["ts"] = timestampMs;
+    j["op"] = op;
+    if (id != 0) {
+        j["id"] = id;
+    }
+    if (task) {
+        j["task"] = task->toJson();
+    }
+    if (!tasks.empty()) {
+        nlohmann::json batch = nlohmann::json::array();
+        for (const auto& t : tasks) {
+            batch.push_back(t.toJson());
+        }
+        j["tasks"] = std::move(batch);
+    }
+    if (removed) {
+        j["removed"] = true;
+    }
+    return j;
+}
+
+HistoryRecord HistoryRecord::fromJson(const nlohmann::json& j) {
+    HistoryRecord r;
+    r.timestampMs = j.at("ts").get<std::int64_t>();
+    r.op = j.at("op").get<std::string>();
+    r.id = j.value("id", TaskId{0});
+    if (j.contains("task")) {
+        r.task = Task::fromJson(j.at("task"));
+    }
+    if (j.contains("tasks")) {
+        for (const auto& t : j.at("tasks")) {
+            r.tasks.push_back(Task::fromJson(t));
+        }
+    }
+    r.removed = j.value("removed", false);
+    r.extra = nlohmann::json::object();
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const std::string& key = it.key();
+        if (key != "ts" && key != "op" && key != "id" && key != "task" && key != "tasks"
+            && key != "removed") {
+            r.extra[key] = it.value();
+        }
+    }
+    return r;
+}
+
+HistoryLog::HistoryLog(std::string path)
+    : path_(std::move(path)), indexPath_(path_ + ".idx") {}
+
+void HistoryLog::append(HistoryRecord record) {
+    std::vector<HistoryRecord> one;
+    one.push_back(std::move(record));
+    appendAll(std::move(one));
+}
+
+void HistoryLog::appendAll(std::vector<HistoryRecord> records) {
+    if (records.empty()) {
+        return;
+    }
+    std::ofstream ofs(path_, std::ios::app | std::ios::binary);
+    if (!ofs) {
+        throw std::runtime_error("Cannot open history file: " + path_);
+    }
+    ofs.seekp(0, std::ios::end);
+    auto offset = static_cast<std::uint64_t>(ofs.tellp());
+
+    // Смещение последней точки индекса; без неё первая запись получает точку
+    std::optional<std::uint64_t> lastIndexed;
+    std::ifstream idx(indexPath_, std::ios::binary | std::ios::ate);
+    if (idx && idx.tellg() >= static_cast<std::streamoff>(sizeof(IndexEntry)) && offset > 0) {
+        IndexEntry last{};
+        idx.seekg(-static_cast<std::streamoff>(sizeof(IndexEntry)), std::ios::end);
+        idx.read(reinterpret_cast<char*>(&last), sizeof(last));
+        if (idx) {
+            lastIndexed = last.offset;
+        }
+    }
+    idx.close();
+
+    // Записи копятся в буфере и уходят крупными кусками: файлы открываются один раз на пакет
+    std::vector<IndexEntry> entries;
+    std::uint64_t indexStart = offset;
+    std::string buffer;
+    OutputWriter writer(buffer);
+    std::int64_t now = nowMs();
+    for (auto& record : records) {
+        if (record.timestampMs == 0) {
+            record.timestampMs = now;
+        }
+        if (!lastIndexed || offset - *lastIndexed >= kIndexStride) {
+            entries.push_back(IndexEntry{record.timestampMs, offset});
+            lastIndexed = offset;
+        }
+        std::size_t before = buffer.size();
+        if (record.extra.is_object() && !record.extra.empty()) {
+            buffer += record.toJson().dump();
+        } else {
+            // Частый случай без доп. полей пишем напрямую, без дерева JSON
+            writer.write("{\"ts\":").writeInt(record.timestampMs);
+            writer.write(",\"op\":").writeJsonString(record.op);
+            if (record.id != 0) {
+                writer.write(",\"id\":").writeInt(record.id);
+            }
+            if (record.task) {
+                writer.write(",\"task\":").writeTaskJson(*record.task);
+            }
+            if (!record.tasks.empty()) {
+                writer.write(",\"tasks\":[");
+                for (std::size_t i = 0; i < record.tasks.size(); ++i) {
+                    if (i > 0) {
+                        writer.put(',');
+                    }
+                    writer.writeTaskJson(record.tasks[i]);
+                }
+                writer.put(']');
+            }
+            if (record.removed) {
+                writer.write(",\"removed\":true");
+            }
+            writer.put('}').flush();
+        }
+        buffer += '\n';
+        offset += buffer.size() - before;
+        if (buffer.size() >= kWriteChunk) {
+            ofs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    ofs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    ofs.flush();
+    if (!ofs) {
+        throw std::runtime_error("Failed to write history file: " + path_);
+    }
+
+    if (!entries.empty()) {
+        std::ofstream out(indexPath_, indexStart == 0 ? std::ios::binary | std::ios::trunc
+                                                      : std::ios::binary | std::ios::app);
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  static_cast<std::streamsize>(entries.size() * sizeof(IndexEntry)));
+    }
+}
+
+void HistoryLog::query(const HistoryFilter& filter,
+                       const std::function<void(const HistoryRecord&)>& visitor) const {
+    std::ifstream ifs(path_, std::ios::binary);
+    if (!ifs) {
+        // Истории ещё нет
+        return;
+    }
+    if (filter.sinceMs) {
+        ifs.seekg(static_cast<std::streamoff>(seekOffset(*filter.sinceMs)));
+    }
+    std::string line;
+    while (std::getline(ifs, line)) {
+        nlohmann::json j = nlohmann::json::parse(line, nullptr, false);
+        if (j.is_discarded() || !j.is_object() || !j.contains("ts")) {
+            continue;
+        }
+        HistoryRecord r = HistoryRecord::fromJson(j);
+        if (filter.untilMs && r.timestampMs > *filter.untilMs) {
+            break;
+        }
+        if (filter.sinceMs && r.timestampMs < *filter.sinceMs) {
+            continue;
+        }
+        if ((filter.id && r.id != *filter.id) || (filter.op && r.op != *filter.op)) {
+            continue;
+        }
+        visitor(r);
+    }
+}
+
+std::vector<Task> HistoryLog::replay(std::int64_t untilMs) const {
+    std::vector<std::optional<Task>> slots;
+    std::unordered_map<TaskId, std::size_t> slotById;
+    HistoryFilter filter;
+    filter.untilMs = untilMs;
+    auto put = [&](Task task) {
+        auto it = slotById.find(task.getId());
+        if (it != slotById.end()) {
+            slots[it->second] = std::move(task);
+        } else {
+            slotById[task.getId()] = slots.size();
+            slots.push_back(std::move(task));
+        }
+    };
+    query(filter, [&](const HistoryRecord& r) {
+        if (r.removed) {
+            auto it = slotById.find(r.id);
+            if (it != slotById.end()) {
+                slots[it->second].reset();
+                slotById.erase(it);
+            }
+        } else if (r.task) {
+            put(*r.task);
+        } else if (!r.tasks.empty()) {
+            for (const auto& task : r.tasks) {
+                put(task);
+            }
+        } else if (r.op == "IMPORT" && r.extra.contains("in")) {
+            for (auto& task : reimport(r)) {
+                put(std::move(task));
+            }
+        }
+    });
+    std::vector<Task> tasks;
+    tasks.reserve(slotById.size());
+    for (auto& slot : slots) {
+        if (slot) {
+            tasks.push_back(std::move(*slot));
+        }
+    }
+    return tasks;
+}
+
+nlohmann::json HistoryLog::fileStamp(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    // FNV-1a по всем байтам файла (как есть на диске, без распаковки .gz)
+    std::uint64_t hash = 14695981039346656037ULL;
+    std::uint64_t size = 0;
+    std::vector<char> chunk(kWriteChunk);
+    while (ifs) {
+        ifs.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        auto n = static_cast<std::size_t>(ifs.gcount());
+        for (std::size_t i = 0; i < n; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(chunk[i])) * 1099511628211ULL;
+        }
+        size += n;
+    }
+    if (ifs.bad()) {
+        throw std::runtime_error("Failed to read file: " + path);
+    }
+    auto mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::filesystem::last_write_time(path).time_since_epoch()).count();
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return {{"size", size}, {"mtime", static_cast<std::int64_t>(mtime)}, {"hash", hex}};
+}
+
+std::int64_t HistoryLog::nowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+std::int64_t HistoryLog::parseTime(const std::string& text) {
+    if (!text.empty() && text.find_first_not_of("0123456789") == std::string::npos) {
+        return std::stoll(text);
+    }
+    int y = 0, mo = 0, d = 0, h = 0, mi = 0, s = 0, ms = 0;
+    int consumed = 0;
+    if (std::sscanf(text.c_str(), "%4d-%2d-%2d%n", &y, &mo, &d, &consumed) != 3) {
+        throw std::invalid_argument("Invalid time: " + text);
+    }
+    std::string rest = text.substr(static_cast<std::size_t>(consumed));
+    if (!rest.empty() && (rest[0] == 'T' || rest[0] == ' ')) {
+        int n = 0;
+        if (std::sscanf(rest.c_str() + 1, "%2d:%2d:%2d%n", &h, &mi, &s, &n) != 3) {
+            throw std::invalid_argument("Invalid time: " + text);
+        }
+        rest = rest.substr(static_cast<std::size_t>(n) + 1);
+        if (!rest.empty() && rest[0] == '.') {
+            int frac = 0;
+            if (std::sscanf(rest.c_str() + 1, "%3d%n", &ms, &frac) != 1) {
+                throw std::invalid_argument("Invalid time: " + text);
+            }
+            for (int i = frac; i < 3; ++i) ms *= 10;
+            rest = rest.substr(static_cast<std::size_t>(frac) + 1);
+        }
+    }
+    if (rest == "Z") {
+        rest.clear();
+    }
+    if (!rest.empty() || mo < 1 || mo > 12 || d < 1 || d > 31) {
+        throw std::invalid_argument("Invalid time: " + text);
+    }
+    std::int64_t days = daysFromCivil(y, static_cast<unsigned>(mo), static_cast<unsigned>(d));
+    return ((days * 24 + h) * 60 + mi) * 60000 + s * 1000 + ms;
+}
+
+std::string HistoryLog::formatTime(std::int64_t ms) {
+    std::int64_t days = ms >= 0 ? ms / 86400000 : -((-ms + 86399999) / 86400000);
+    std::int64_t rem = ms - days * 86400000;
+    int y = 0;
+    unsigned m = 0, d = 0;
+    civilFromDays(days, y, m, d);
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%04d-%02u-%02uT%02d:%02d:%02d.%03dZ", y, m, d,
+                  static_cast<int>(rem / 3600000), static_cast<int>(rem / 60000 % 60),
+                  static_cast<int>(rem / 1000 % 60), static_cast<int>(rem % 1000));
+    return buf;
+}
+
+std::uint64_t HistoryLog::seekOffset(std::int64_t sinceMs) const {
+    std::ifstream idx(indexPath_, std::ios::binary);
+    if (!idx) {
+        return 0;
+    }
+    std::vector<IndexEntry> entries;
+    IndexEntry e{};
+    while (idx.read(reinterpret_cast<char*>(&e), sizeof(e))) {
+        entries.push_back(e);
+    }
+    // Последняя точка строго раньше sinceMs: все записи до неё заведомо не подходят
+    std::size_t lo = 0, hi = entries.size();
+    while (lo < hi) {
+        std::size_t mid = (lo + hi) / 2;
+        if (entries[mid].timestampMs < sinceMs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo == 0 ? 0 : entries[lo - 1].offset;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Task.hpp"
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Одна запись структурированной истории.
+ *
+ * В файле хранится как одна строка JSON:
+ * {"ts":<мс UTC>,"op":"ADD","id":3,"task":{...}}.
+ * Поле task содержит состояние задачи после операции; для удаления его нет.
+ * Пакетная запись IMPORT вместо task несёт массив tasks в том же компактном виде.
+ */
+struct HistoryRecord {
+    std::int64_t timestampMs = 0;   ///< Время операции, миллисекунды с эпохи UTC.
+    std::string op;                 ///< ADD, REMOVE, DONE, UPDATE-DATE, UNDO, REDO, EXPORT...
+    TaskId id = 0;                  ///< ID затронутой задачи (0, если нет).
+    std::optional<Task> task;       ///< Состояние задачи после операции.
+    bool removed = false;           ///< Операция удалила задачу.
+    std::vector<Task> tasks;        ///< Задачи пакетной записи IMPORT.
+    nlohmann::json extra;           ///< Прочие поля (например, format/out для EXPORT).
+
+    /**
+     * @brief Сериализует запись в JSON-объект.
+     */
+    nlohmann::json toJson() const;
+
+    /**
+     * @brief Восстанавливает запись из JSON-объекта.
+     * @throws nlohmann::json::exception Если нет обязательных полей ts и op.
+     */
+    static HistoryRecord fromJson(const nlohmann::json& j);
+};
+
+/**
+ * @brief Фильтр для выборки из истории.
+ */
+struct HistoryFilter {
+    std::optional<std::int64_t> sinceMs; ///< Не раньше этого момента (включительно).
+    std::optional<std::int64_t> untilMs; ///< Не позже этого момента (включительно).
+    std::optional<TaskId> id;            ///< Только записи об этой задаче.
+    std::optional<std::string> op;       ///< Только операции этого типа.
+};
+
+/**
+ * @brief Структурированная история операций в формате NDJSON с разреженным индексом времени.
+ *
+ * Рядом с файлом истории лежит индекс <path>.idx: пары (время, смещение), добавляемые
+ * примерно раз на kIndexStride байт истории. Запрос по времени находит в индексе
+ * ближайшую точку и читает файл только с неё. Записи предполагаются упорядоченными по времени.
+ */
+class HistoryLog {
+public:
+    static constexpr std::uint64_t kIndexStride = 64 * 1024; ///< Шаг индекса в байтах.
+
+    /**
+     * @brief Конструктор.
+     * @param path Путь к файлу истории (например, history.ndjson).
+     */
+    explicit HistoryLog(std::string path);
+
+    /**
+     * @brief Дописывает запись в конец истории (и, при необходимости, точку индекса).
+     * @param record Запись; если timestampMs == 0, подставляется текущее время.
+     * @throws std::runtime_error При ошибке записи.
+     */
+    void append(HistoryRecord record);
+
+    /**
+     * @brief Дописывает записи пакетом: файлы истории и индекса открываются один раз.
+     * @param records Записи в порядке времени; нулевое timestampMs заменяется текущим.
+     * @throws std::runtime_error При ошибке записи.
+     */
+    void appendAll(std::vector<HistoryRecord> records);
+
+    /**
+     * @brief Перебирает записи, подходящие под фильтр, в порядке записи.
+     * @param filter  Условия выборки.
+     * @param visitor Вызывается для каждой подходящей записи.
+     * @throws std::runtime_error При ошибке чтения.
+     */
+    void query(const HistoryFilter& filter,
+               const std::function<void(const HistoryRecord&)>& visitor) const;
+
+    /**
+     * @brief Восстанавливает список задач на заданный момент, проигрывая историю с начала.
+     *
+     * Пакетная запись IMPORT добавляет задачи из своего поля tasks. Запись IMPORT со
+     * ссылкой на файл (поля in/format/count) проигрывается повторным чтением исходного
+     * файла, если его размер, время изменения и хэш совпадают с fileStamp() на момент
+     * импорта; ID берутся из файла (keepIds) или из отрезков ids.
+     * @param untilMs Момент времени (включительно), миллисекунды с эпохи UTC.
+     * @return Список задач в порядке их появления.
+     * @throws std::runtime_error Если исходный файл импорта недоступен или изменился.
+     */
+    std::vector<Task> replay(std::int64_t untilMs) const;
+
+    /**
+     * @brief Отпечаток файла для записи импорта по ссылке.
+     * @param path Путь к файлу.
+     * @return Объект {size, mtime, hash}: размер, время изменения и FNV-1a содержимого.
+     * @throws std::runtime_error Если файл не удалось прочитать.
+     */
+    static nlohmann::json fileStamp(const std::string& path);
+
+    /**
+     * @brief Текущее время в миллисекундах с эпохи UTC.
+     */
+    static std::int64_t nowMs();
+
+    /**
+     * @brief Разбирает момент времени из командной строки.
+     * @param text \"YYYY-MM-DD\", \"YYYY-MM-DDTHH:MM:SS[.mmm][Z]\" (UTC) или число миллисекунд.
+     * @return Миллисекунды с эпохи UTC.
+     * @throws std::invalid_argument Если формат не распознан.
+     */
+    static std::int64_t parseTime(const std::string& text);
+
+    /**
+     * @brief Форматирует момент времени как YYYY-MM-DDTHH:MM:SS.mmmZ.
+     * @param ms Миллисекунды с эпохи UTC.
+     */
+    static std::string formatTime(std::int64_t ms);
+
+private:
+    std::uint64_t seekOffset(std::int64_t sinceMs) const;
+
+    std::string path_;      ///< Путь к файлу истории.
+    std::string indexPath_; ///< Путь к разреженному индексу.
+};
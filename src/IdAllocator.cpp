@@ -0,0 +1,33 @@
+#include "IdAllocator.hpp"
+
+IdAllocator::Block::Block(IdAllocator& ids, std::size_t size) noexcept
+    : ids_(&ids), size_(size == 0 ? 1 : size) {}
+
+TaskId IdAllocator::Block::take() noexcept {
+    if (next_ == end_) {
+        next_ = ids_->allocate(size_);
+        end_ = next_ + static_cast<TaskId>(size_);
+    }
+    return next_++;
+}
+
+IdAllocator::IdAllocator(TaskId next) noexcept : next_(next) {}
+
+TaskId IdAllocator::allocate() noexcept {
+    return next_.fetch_add(1, std::memory_order_relaxed);
+}
+
+TaskId IdAllocator::allocate(std::size_t count) noexcept {
+    return next_.fetch_add(static_cast<TaskId>(count), std::memory_order_relaxed);
+}
+
+void IdAllocator::observe(TaskId used) noexcept {
+    TaskId current = next_.load(std::memory_order_relaxed);
+    while (current <= used
+           && !next_.compare_exchange_weak(current, used + 1, std::memory_order_relaxed)) {
+    }
+}
+
+TaskId IdAllocator::next() const noexcept {
+    return next_.load(std::memory_order_relaxed);
+}
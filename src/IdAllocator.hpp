@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Идентификатор задачи (64 бита, как INTEGER PRIMARY KEY в SQLite).
+ */
+using TaskId = std::int64_t;
+
+/**
+ * @brief Генератор ID задач одного хранилища.
+ *
+ * Счётчик атомарный: allocate() безопасно вызывать из нескольких потоков. Выданные ID
+ * не повторяются, даже если задачу потом удалили: Storage сохраняет next() в файл
+ * данных, и после загрузки observe() поднимает счётчик до сохранённого значения.
+ *
+ * Загрузка и десериализация ID не расходуют: задачи приходят со своими ID, а загрузчик
+ * один раз сообщает наибольший из них через observe().
+ *
+ * Массовый импорт в несколько потоков берёт ID блоками (Block): одна атомарная
+ * операция на kBlockSize задач. Невыданный остаток блока пропадает — ID уникальны,
+ * но могут идти с пропусками.
+ */
+class IdAllocator {
+public:
+    static constexpr TaskId kFirstId = 1;           ///< Первый ID пустого хранилища.
+    static constexpr std::size_t kBlockSize = 1024; ///< ID в одном блоке Block.
+
+    /**
+     * @brief Блок ID для одного потока: берёт из генератора по kBlockSize ID за раз.
+     *
+     * Сам блок не потокобезопасен — у каждого потока свой.
+     */
+    class Block {
+    public:
+        explicit Block(IdAllocator& ids, std::size_t size = kBlockSize) noexcept;
+
+        /**
+         * @brief Следующий ID блока; когда блок исчерпан, берёт новый у генератора.
+         */
+        TaskId take() noexcept;
+
+    private:
+        IdAllocator* ids_;
+        std::size_t size_;
+        TaskId next_ = 0;
+        TaskId end_ = 0;
+    };
+
+    /**
+     * @param next Первый ID, который выдаст генератор.
+     */
+    explicit IdAllocator(TaskId next = kFirstId) noexcept;
+
+    IdAllocator(const IdAllocator&) = delete;
+    IdAllocator& operator=(const IdAllocator&) = delete;
+
+    /**
+     * @brief Выдаёт новый ID.
+     */
+    TaskId allocate() noexcept;
+
+    /**
+     * @brief Выдаёт count подряд идущих ID.
+     * @return Первый из них.
+     */
+    TaskId allocate(std::size_t count) noexcept;
+
+    /**
+     * @brief Отмечает ID как уже занятый: следующие будут больше него.
+     *
+     * Ничего не выдаёт; меньший ID, чем уже выданные, ничего не меняет.
+     */
+    void observe(TaskId used) noexcept;
+
+    /**
+     * @brief Следующий ID, который выдаст генератор (граница занятых; сохраняется в файл).
+     */
+    TaskId next() const noexcept;
+
+private:
+    std::atomic<TaskId> next_;
+};
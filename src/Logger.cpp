@@ -1,41 +1,715 @@
 #include "Logger.hpp"
+#include <algorithm>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <cstdlib>
 #include <stdexcept>
+#include <tuple>
+#include <vector>
+#ifdef TODO_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#if defined(_WIN32) || defined(_WIN64)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Пишет value ровно в width цифр (с ведущими нулями)
+char* writeDigits(char* out, unsigned long long value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return out + width;
+}
+
+// Пишет value без ведущих нулей
+char* writeNumber(char* out, unsigned long long value) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n > 0) {
+        *out++ = tmp[--n];
+    }
+    return out;
+}
+
+// Дописывает дробную часть секунды: '.' и digits знаков из наносекунд
+char* writeFraction(char* out, long long nanos, int digits) {
+    if (digits <= 0) {
+        return out;
+    }
+    for (int i = digits; i < 9; ++i) {
+        nanos /= 10;
+    }
+    *out++ = '.';
+    return writeDigits(out, static_cast<unsigned long long>(nanos), digits);
+}
+
+// Время из метки первой строки журнала "[YYYY-MM-DDTHH:MM:SS[.fff][Z]] ..."
+bool parseLineTime(const std::string& line, std::chrono::system_clock::time_point& out) {
+    std::tm tm{};
+    int consumed = 0;
+    if (std::sscanf(line.c_str(), "[%4d-%2d-%2dT%2d:%2d:%2d%n", &tm.tm_year, &tm.tm_mon,
+                    &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &consumed) != 6) {
+        return false;
+    }
+    std::size_t pos = static_cast<std::size_t>(consumed);
+    if (pos < line.size() && line[pos] == '.') {
+        ++pos;
+        while (pos < line.size() && line[pos] >= '0' && line[pos] <= '9') ++pos;
+    }
+    bool utc = pos < line.size() && line[pos] == 'Z';
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    std::time_t t = std::mktime(&tm);
+    if (t == static_cast<std::time_t>(-1)) {
+        return false;
+    }
+    if (utc) {
+        // mktime трактует поля как местное время; поправляем на смещение пояса
+        std::tm gm{};
+#if defined(_WIN32) || defined(_WIN64)
+        gmtime_s(&gm, &t);
+#else
+        gmtime_r(&t, &gm);
+#endif
+        gm.tm_isdst = -1;
+        t += t - std::mktime(&gm);
+    }
+    out = std::chrono::system_clock::from_time_t(t);
+    return true;
+}
+
+// Открывает файл на дозапись (создаёт, если его нет); -1 при ошибке
+int openAppend(const std::string& path) {
+#if defined(_WIN32) || defined(_WIN64)
+    return _open(path.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+#endif
+}
+
+// Пишет весь буфер (write может записать часть)
+bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+#if defined(_WIN32) || defined(_WIN64)
+        int n = _write(fd, data, static_cast<unsigned>(std::min<std::size_t>(size, 1u << 30)));
+#else
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Блокировка flock открытого файла; в Windows не нужна: открытый файл нельзя переименовать
+void lockFile(int fd, bool exclusive) {
+#if defined(_WIN32) || defined(_WIN64)
+    (void)fd;
+    (void)exclusive;
+#else
+    while (::flock(fd, exclusive ? LOCK_EX : LOCK_SH) != 0 && errno == EINTR) {
+    }
+#endif
+}
+
+void unlockFile(int fd) {
+#if defined(_WIN32) || defined(_WIN64)
+    (void)fd;
+#else
+    ::flock(fd, LOCK_UN);
+#endif
+}
+
+// Сжимает сегмент в <segment>.gz и удаляет исходник (без zlib оставляет как есть)
+void compressSegment(const std::string& segment) {
+#ifdef TODO_HAVE_ZLIB
+    std::string tmp = segment + ".gz.tmp";
+    FILE* in = std::fopen(segment.c_str(), "rb");
+    if (!in) {
+        return;
+    }
+    gzFile out = gzopen(tmp.c_str(), "wb6");
+    if (!out) {
+        std::fclose(in);
+        return;
+    }
+    std::vector<char> buf(64 * 1024);
+    bool ok = true;
+    std::size_t n;
+    while ((n = std::fread(buf.data(), 1, buf.size(), in)) > 0) {
+        if (gzwrite(out, buf.data(), static_cast<unsigned>(n)) != static_cast<int>(n)) {
+            ok = false;
+            break;
+        }
+    }
+    std::fclose(in);
+    ok = gzclose(out) == Z_OK && ok;
+    std::error_code ec;
+    if (ok) {
+        fs::rename(tmp, segment + ".gz", ec);
+        if (!ec) {
+            fs::remove(segment, ec);
+        }
+    } else {
+        fs::remove(tmp, ec);
+    }
+#else
+    (void)segment;
+#endif
+}
+
+// Удаляет самые старые сегменты <path>.<время>[.gz] сверх maxSegments
+void pruneSegments(const std::string& path, std::size_t maxSegments) {
+    fs::path logPath(path);
+    fs::path dir = logPath.has_parent_path() ? logPath.parent_path() : fs::path(".");
+    std::string prefix = logPath.filename().string() + ".";
+    std::vector<std::tuple<std::string, unsigned long, fs::path>> segments;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name[prefix.size()] < '0' || name[prefix.size()] > '9' ||
+            name.find(".tmp") != std::string::npos) {
+            continue;
+        }
+        // Ключ сортировки — время и номер -N без .gz, чтобы сжатые и несжатые шли по порядку
+        std::string key = name.substr(prefix.size());
+        if (key.size() > 3 && key.compare(key.size() - 3, 3, ".gz") == 0) {
+            key.resize(key.size() - 3);
+        }
+        unsigned long counter = 0;
+        std::size_t dash = key.find('-');
+        if (dash != std::string::npos) {
+            counter = std::strtoul(key.c_str() + dash + 1, nullptr, 10);
+            key.resize(dash);
+        }
+        segments.emplace_back(key, counter, entry.path());
+    }
+    if (segments.size() <= maxSegments) {
+        return;
+    }
+    std::sort(segments.begin(), segments.end());
+    for (std::size_t i = 0; i + maxSegments < segments.size(); ++i) {
+        fs::remove(std::get<2>(segments[i]), ec);
+    }
+}
+
+} // namespace
 
 Logger& Logger::instance(const std::string& logFilePath) {
     static Logger logger(logFilePath);
     return logger;
 }
 
-Logger::Logger(const std::string& logFilePath) {
-    ofs_.open(logFilePath, std::ios::app);
-    if (!ofs_) {
-        throw std::runtime_error("Cannot open log file: " + logFilePath);
-    }
+Logger::Logger(const std::string& logFilePath)
+    : path_(logFilePath), start_(std::chrono::steady_clock::now()) {
+    openFile();
 }
 
 Logger::~Logger() {
-    if (ofs_.is_open()) {
-        ofs_.close();
+    // Гарантированно дописываем всё, что успели принять
+    stopWorker();
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        writeBuffer();
     }
+    stopMaintenance();
+    closeFile();
 }
 
 void Logger::log(const std::string& message) {
+    if (!async_.load(std::memory_order_acquire)) {
+        char stamp[kMaxStampLength];
+        std::size_t n = formatTimestamp(stamp);
+        writeLine(stamp, n, message);
+        return;
+    }
+    while (!tryPush(message)) {
+        // Буфер заполнен — будим фоновый поток и ждём, пока он освободит место
+        wakeCv_.notify_one();
+        std::this_thread::yield();
+    }
+    if (sleeping_.load()) {
+        wakeCv_.notify_one();
+    }
+}
+
+void Logger::setOptions(const LoggerOptions& options) {
+    stopWorker();
+    // Новая политика не застаёт незаконченную ротацию и сжатие по старой; ждём до
+    // захвата mtx_, потому что ротация берёт его сама
+    waitMaintenance();
     std::lock_guard<std::mutex> lock(mtx_);
-    // Текущее время в формате ISO 8601
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
+    options_ = options;
+    if (options_.subsecondDigits < 0) options_.subsecondDigits = 0;
+    if (options_.subsecondDigits > 9) options_.subsecondDigits = 9;
+    ++generation_;
+    if (options_.async) {
+        startWorker();
+    }
+}
+
+void Logger::setPath(const std::string& logFilePath) {
+    stopWorker();
+    waitMaintenance();
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (logFilePath != path_) {
+        writeBuffer();
+        closeFile();
+        path_ = logFilePath;
+        lastSegmentStamp_.clear();
+        segmentCounter_ = 0;
+        openFile();
+    }
+    if (options_.async) {
+        startWorker();
+    }
+}
+
+void Logger::flush() {
+    if (!async_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        writeBuffer();
+    } else {
+        std::size_t target = tail_.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lk(wakeMtx_);
+        while (flushed_.load(std::memory_order_acquire) < target) {
+            flushRequested_.store(true);
+            wakeCv_.notify_one();
+            drainedCv_.wait_for(lk, std::chrono::milliseconds(10));
+        }
+    }
+    waitMaintenance();
+}
+
+std::size_t Logger::formatTimestamp(char* out) const {
+    using namespace std::chrono;
+    char* p = out;
+    if (options_.clock == TimestampClock::Monotonic) {
+        auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start_).count();
+        *p++ = '+';
+        p = writeNumber(p, static_cast<unsigned long long>(elapsed / 1000000000));
+        p = writeFraction(p, elapsed % 1000000000, options_.subsecondDigits);
+        return static_cast<std::size_t>(p - out);
+    }
+
+    // Кэш секундной части метки: свой в каждом потоке, поэтому без блокировок
+    struct StampCache {
+        const Logger* owner = nullptr;
+        unsigned generation = 0;
+        long long second = -1;
+        char text[20];
+    };
+    thread_local StampCache cache;
+
+    auto now = system_clock::now();
+    auto sinceEpoch = duration_cast<nanoseconds>(now.time_since_epoch()).count();
+    long long second = sinceEpoch / 1000000000;
+    long long nanos = sinceEpoch % 1000000000;
+    if (nanos < 0) {
+        nanos += 1000000000;
+        --second;
+    }
+    if (cache.owner != this || cache.generation != generation_ || cache.second != second) {
+        // Текущее время в формате ISO 8601
+        std::time_t t = static_cast<std::time_t>(second);
+        std::tm buf;
+#if defined(_WIN32) || defined(_WIN64)
+        if (options_.clock == TimestampClock::Utc) {
+            gmtime_s(&buf, &t);
+        } else {
+            localtime_s(&buf, &t);
+        }
+#else
+        if (options_.clock == TimestampClock::Utc) {
+            gmtime_r(&t, &buf);
+        } else {
+            localtime_r(&t, &buf);
+        }
+#endif
+        char* c = cache.text;
+        c = writeDigits(c, static_cast<unsigned long long>(buf.tm_year + 1900), 4);
+        *c++ = '-';
+        c = writeDigits(c, static_cast<unsigned long long>(buf.tm_mon + 1), 2);
+        *c++ = '-';
+        c = writeDigits(c, static_cast<unsigned long long>(buf.tm_mday), 2);
+        *c++ = 'T';
+        c = writeDigits(c, static_cast<unsigned long long>(buf.tm_hour), 2);
+        *c++ = ':';
+        c = writeDigits(c, static_cast<unsigned long long>(buf.tm_min), 2);
+        *c++ = ':';
+        writeDigits(c, static_cast<unsigned long long>(buf.tm_sec), 2);
+        cache.owner = this;
+        cache.generation = generation_;
+        cache.second = second;
+    }
+    std::memcpy(p, cache.text, 19);
+    p += 19;
+    p = writeFraction(p, nanos, options_.subsecondDigits);
+    if (options_.clock == TimestampClock::Utc) {
+        *p++ = 'Z';
+    }
+    return static_cast<std::size_t>(p - out);
+}
+
+void Logger::writeLine(const char* stamp, std::size_t stampLength, const std::string& message) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    appendLine(stamp, stampLength, message);
+    if (buffer_.size() >= options_.flushBytes) {
+        writeBuffer();
+    }
+    if (rotationDue()) {
+        // Ротирует поток обслуживания: вызывающий не ждёт переименования и сжатия
+        requestRotation();
+    }
+}
+
+void Logger::appendLine(const char* stamp, std::size_t stampLength, const std::string& message) {
+    buffer_.push_back('[');
+    buffer_.append(stamp, stampLength);
+    buffer_.append("] ", 2);
+    buffer_.append(message);
+    buffer_.push_back('\n');
+}
+
+bool Logger::tryPush(const std::string& message) {
+    std::size_t pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = ring_[pos & ringMask_];
+        std::size_t seq = slot.seq.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.stampLength = formatTimestamp(slot.stamp);
+                slot.message.assign(message);
+                slot.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // буфер заполнен
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::startWorker() {
+    std::size_t capacity = 2;
+    while (capacity < options_.queueCapacity) {
+        capacity <<= 1;
+    }
+    ring_.reset(new Slot[capacity]);
+    for (std::size_t i = 0; i < capacity; ++i) {
+        ring_[i].seq.store(i, std::memory_order_relaxed);
+    }
+    ringMask_ = capacity - 1;
+    tail_.store(0);
+    head_ = 0;
+    flushed_.store(0);
+    stop_.store(false);
+    async_.store(true, std::memory_order_release);
+    worker_ = std::thread(&Logger::workerLoop, this);
+}
+
+void Logger::stopWorker() {
+    if (!worker_.joinable()) {
+        return;
+    }
+    async_.store(false, std::memory_order_release);
+    stop_.store(true);
+    {
+        std::lock_guard<std::mutex> lk(wakeMtx_);
+        wakeCv_.notify_one();
+    }
+    worker_.join();
+}
+
+void Logger::workerLoop() {
+    using Clock = std::chrono::steady_clock;
+    std::size_t written = 0;
+    auto lastFlush = Clock::now();
+    for (;;) {
+        // Забираем из буфера всё, что есть, одной пачкой; строку пишем прямо из ячейки,
+        // чтобы её буфер сообщения переиспользовался на следующем круге
+        bool stopping = stop_.load();
+        bool flushed = false;
+        {
+            // Файл и буфер делим с ротацией в потоке обслуживания
+            std::lock_guard<std::mutex> lock(mtx_);
+            for (;;) {
+                Slot& slot = ring_[head_ & ringMask_];
+                if (slot.seq.load(std::memory_order_acquire) != head_ + 1) {
+                    break;
+                }
+                appendLine(slot.stamp, slot.stampLength, slot.message);
+                slot.seq.store(head_ + ringMask_ + 1, std::memory_order_release);
+                ++head_;
+                ++written;
+            }
+            auto now = Clock::now();
+            bool flushNow = buffer_.size() >= options_.flushBytes ||
+                            now - lastFlush >= options_.flushInterval ||
+                            flushRequested_.exchange(false) || stopping;
+            if (flushNow && written != flushed_.load(std::memory_order_relaxed)) {
+                writeBuffer();
+                lastFlush = now;
+                flushed = true;
+            }
+            if (rotationDue()) {
+                requestRotation();
+            }
+        }
+        if (flushed) {
+            flushed_.store(written, std::memory_order_release);
+            std::lock_guard<std::mutex> lk(wakeMtx_);
+            drainedCv_.notify_all();
+        }
+        if (stopping) {
+            // stop_ выставлен до последней выборки, поэтому буфер уже пуст
+            break;
+        }
+        std::unique_lock<std::mutex> lk(wakeMtx_);
+        sleeping_.store(true);
+        Slot& next = ring_[head_ & ringMask_];
+        if (next.seq.load(std::memory_order_acquire) != head_ + 1 && !stop_.load() &&
+            !flushRequested_.load()) {
+            wakeCv_.wait_for(lk, options_.flushInterval);
+        }
+        sleeping_.store(false);
+    }
+}
+
+void Logger::openFile() {
+    fd_ = openAppend(path_);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open log file: " + path_);
+    }
+    struct stat st {};
+    if (::fstat(fd_, &st) == 0) {
+        fileDevice_ = static_cast<std::uint64_t>(st.st_dev);
+        fileInode_ = static_cast<std::uint64_t>(st.st_ino);
+        fileBytes_ = static_cast<std::uint64_t>(st.st_size);
+    } else {
+        fileBytes_ = 0;
+    }
+    segmentStart_ = std::chrono::system_clock::now();
+    if (fileBytes_ > 0) {
+        // Возраст существующего файла считаем по метке его первой строки
+        std::ifstream ifs(path_);
+        std::string first;
+        if (std::getline(ifs, first)) {
+            parseLineTime(first, segmentStart_);
+        }
+    }
+}
+
+void Logger::closeFile() noexcept {
+    if (fd_ >= 0) {
+#if defined(_WIN32) || defined(_WIN64)
+        _close(fd_);
+#else
+        ::close(fd_);
+#endif
+        fd_ = -1;
+    }
+}
+
+bool Logger::replacedOnDisk() const {
+#if defined(_WIN32) || defined(_WIN64)
+    return false;
+#else
+    struct stat st {};
+    if (::stat(path_.c_str(), &st) != 0) {
+        return true;
+    }
+    return static_cast<std::uint64_t>(st.st_dev) != fileDevice_ ||
+           static_cast<std::uint64_t>(st.st_ino) != fileInode_;
+#endif
+}
+
+void Logger::writeBuffer() {
+    if (buffer_.empty()) {
+        return;
+    }
+    // Под общей блокировкой путь не может смениться: ротация берёт исключительную
+    lockFile(fd_, false);
+    while (replacedOnDisk()) {
+        // Журнал ротировал другой процесс — пишем в новый файл, а не в его сегмент
+        unlockFile(fd_);
+        closeFile();
+        openFile();
+        lockFile(fd_, false);
+    }
+    writeAll(fd_, buffer_.data(), buffer_.size());
+    struct stat st {};
+    if (::fstat(fd_, &st) == 0) {
+        // Размер с учётом строк других процессов
+        fileBytes_ = static_cast<std::uint64_t>(st.st_size);
+    }
+    unlockFile(fd_);
+    buffer_.clear();
+}
+
+bool Logger::rotationDue() const {
+    if (options_.rotateBytes > 0 && fileBytes_ >= options_.rotateBytes) {
+        return true;
+    }
+    return options_.rotateAge.count() > 0 && fileBytes_ > 0 &&
+           std::chrono::system_clock::now() - segmentStart_ >= options_.rotateAge;
+}
+
+void Logger::requestRotation() {
+    std::lock_guard<std::mutex> lk(maintMtx_);
+    if (rotateRequested_) {
+        return;
+    }
+    rotateRequested_ = true;
+    if (!maintenance_.joinable()) {
+        maintStop_ = false;
+        maintenance_ = std::thread(&Logger::maintenanceLoop, this);
+    }
+    maintCv_.notify_one();
+}
+
+std::string Logger::rotate() {
+    writeBuffer();
+    lockFile(fd_, true);
+    while (replacedOnDisk()) {
+        // Другой процесс уже ротировал журнал; его новый файл может быть ещё мал
+        unlockFile(fd_);
+        closeFile();
+        openFile();
+        if (!rotationDue()) {
+            return {};
+        }
+        lockFile(fd_, true);
+    }
+    struct stat st {};
+    if (::fstat(fd_, &st) == 0) {
+        fileBytes_ = static_cast<std::uint64_t>(st.st_size);
+    }
+    if (!rotationDue()) {
+        unlockFile(fd_);
+        return {};
+    }
+
+    std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
     std::tm buf;
 #if defined(_WIN32) || defined(_WIN64)
-    localtime_s(&buf, &in_time_t);
+    localtime_s(&buf, &now);
 #else
-    localtime_r(&in_time_t, &buf);
+    localtime_r(&now, &buf);
 #endif
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%S", &buf);
+    // Несколько ротаций за одну секунду различаются возрастающим суффиксом -N
+    segmentCounter_ = lastSegmentStamp_ == stamp ? segmentCounter_ + 1 : 0;
+    lastSegmentStamp_ = stamp;
+    std::string segment;
+    for (;; ++segmentCounter_) {
+        segment = path_ + "." + stamp;
+        if (segmentCounter_ > 0) {
+            segment += "-" + std::to_string(segmentCounter_);
+        }
+        if (!fs::exists(segment) && !fs::exists(segment + ".gz")) {
+            break;
+        }
+    }
+#if defined(_WIN32) || defined(_WIN64)
+    // Открытый файл в Windows не переименовать
+    closeFile();
+#endif
+    std::error_code ec;
+    fs::rename(path_, segment, ec);
+    // Закрытие снимает исключительную блокировку уже после переименования
+    closeFile();
+    openFile();
+    if (ec) {
+        // Не удалось переименовать — продолжаем писать в старый файл
+        return {};
+    }
+    return segment;
+}
 
-    std::ostringstream ss;
-    ss << std::put_time(&buf, "%Y-%m-%dT%H:%M:%S");
-    ofs_ << "[" << ss.str() << "] " << message << "\n";
-    ofs_.flush();
+void Logger::maintenanceLoop() {
+    std::unique_lock<std::mutex> lk(maintMtx_);
+    for (;;) {
+        maintCv_.wait(lk, [this] { return rotateRequested_ || maintStop_; });
+        if (!rotateRequested_) {
+            return;
+        }
+        rotateRequested_ = false;
+        maintBusy_ = true;
+        lk.unlock();
+
+        std::string segment;
+        std::string path;
+        bool compress = false;
+        std::size_t maxSegments = 0;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (rotationDue()) {
+                segment = rotate();
+            }
+            path = path_;
+            compress = options_.compressRotated;
+            maxSegments = options_.maxSegments;
+        }
+        // Сжатие и очистка — без mtx_: запись в новый файл их не ждёт
+        if (!segment.empty()) {
+            if (compress) {
+                compressSegment(segment);
+            }
+            pruneSegments(path, maxSegments);
+        }
+
+        lk.lock();
+        maintBusy_ = false;
+        idleCv_.notify_all();
+    }
+}
+
+void Logger::waitMaintenance() {
+    std::unique_lock<std::mutex> lk(maintMtx_);
+    idleCv_.wait(lk, [this] { return !rotateRequested_ && !maintBusy_; });
+}
+
+void Logger::stopMaintenance() {
+    {
+        std::unique_lock<std::mutex> lk(maintMtx_);
+        idleCv_.wait(lk, [this] { return !rotateRequested_ && !maintBusy_; });
+        maintStop_ = true;
+        maintCv_.notify_one();
+    }
+    if (maintenance_.joinable()) {
+        maintenance_.join();
+    }
 }
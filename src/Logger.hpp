@@ -1,11 +1,71 @@
 #pragma once
 
-#include <string>
-#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Источник времени для меток в журнале.
+ */
+enum class TimestampClock {
+    Local,    ///< Местное время: 2025-06-10T14:03:07.
+    Utc,      ///< Время UTC: 2025-06-10T11:03:07Z.
+    Monotonic ///< Секунды от создания Logger по монотонным часам: +12.345.
+};
+
+/**
+ * @brief Политика записи и сброса журнала.
+ */
+struct LoggerOptions {
+    /// Источник времени для меток.
+    TimestampClock clock = TimestampClock::Local;
+    /// Число знаков дробной части секунды в метке (0..9).
+    int subsecondDigits = 0;
+    /// Писать через кольцевой буфер и фоновый поток (иначе — синхронно под мьютексом).
+    bool async = false;
+    /// Ёмкость кольцевого буфера в строках (округляется вверх до степени двойки).
+    std::size_t queueCapacity = 8192;
+    /// Сбрасывать файл, когда накоплено столько байт (0 — после каждой строки).
+    std::size_t flushBytes = 0;
+    /// В асинхронном режиме сбрасывать файл не реже, чем раз в этот интервал.
+    std::chrono::milliseconds flushInterval{200};
+    /// Ротировать журнал, когда он вырос до этого размера в байтах (0 — не ротировать).
+    std::uint64_t rotateBytes = 0;
+    /// Ротировать журнал, когда его первая строка старше этого возраста (0 — не ротировать).
+    std::chrono::seconds rotateAge{0};
+    /// Сколько ротированных сегментов хранить (старые удаляются).
+    std::size_t maxSegments = 10;
+    /// Сжимать ротированные сегменты в .gz (если сборка с zlib).
+    bool compressRotated = true;
+};
 
 /**
  * @brief Синглтон-класс для потокобезопасного логирования операций.
+ *
+ * Секундная часть метки времени форматируется вручную и кэшируется (в каждом потоке
+ * своя копия), пока не сменится секунда; метка пишется в заранее выделенный буфер,
+ * поэтому на каждую строку журнала не приходится ни одной аллокации.
+ *
+ * В асинхронном режиме log() кладёт готовую строку в lock-free MPSC кольцевой буфер,
+ * а фоновый поток пишет строки пачками и сбрасывает файл по порогу размера или времени.
+ * При переключении режима и при завершении программы буфер гарантированно дописывается.
+ *
+ * Строки копятся в буфере и дописываются в файл одним write() с O_APPEND, поэтому
+ * в один журнал могут писать несколько процессов (CLI и демон). Запись идёт под общей
+ * блокировкой flock самого файла; если путь уже указывает на другой файл (его ротировал
+ * другой процесс), журнал открывается заново.
+ *
+ * При превышении размера или возраста журнал переименовывается в сегмент
+ * <путь>.<YYYYMMDDTHHMMSS> и открывается заново. Ротацию, сжатие сегмента в gzip и
+ * удаление сегментов сверх maxSegments выполняет фоновый поток обслуживания: log()
+ * только просит его об этом. Переименование идёт под исключительной блокировкой
+ * файла, так что ни один процесс не допишет строку в уже ротированный сегмент.
  */
 class Logger {
 public:
@@ -16,12 +76,35 @@ public:
      */
     static Logger& instance(const std::string& logFilePath = "history.log");
 
+    /**
+     * @brief Переключает журнал на другой файл; принятые сообщения дописываются в прежний.
+     *
+     * Не должна вызываться одновременно с log() из других потоков.
+     * @param logFilePath Новый путь к лог-файлу.
+     * @throws std::runtime_error Если файл не удалось открыть.
+     */
+    void setPath(const std::string& logFilePath);
+
     /**
      * @brief Записывает сообщение с временной меткой.
      * @param message Текст сообщения (без времени).
      */
     void log(const std::string& message);
 
+    /**
+     * @brief Меняет политику записи; уже принятые сообщения сначала дописываются,
+     *        а начатая ротация и сжатие сегмента завершаются.
+     *
+     * Не должна вызываться одновременно с log() из других потоков.
+     * @param options Новая политика.
+     */
+    void setOptions(const LoggerOptions& options);
+
+    /**
+     * @brief Дожидается записи всех принятых сообщений и запрошенной ротации.
+     */
+    void flush();
+
 private:
     Logger(const std::string& logFilePath);
     ~Logger();
@@ -29,6 +112,67 @@ private:
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
-    std::ofstream ofs_;  ///< Поток для записи в файл.
-    std::mutex mtx_;     ///< Мьютекс для синхронизации.
+    static constexpr std::size_t kMaxStampLength = 48; ///< Размер буфера метки времени.
+
+    /// Ячейка кольцевого буфера (схема Вьюкова: номер последовательности + данные).
+    struct Slot {
+        std::atomic<std::size_t> seq{0};
+        char stamp[kMaxStampLength];   ///< Метка времени (без завершающего нуля).
+        std::size_t stampLength = 0;   ///< Длина метки.
+        std::string message;           ///< Текст; ёмкость переиспользуется между кругами.
+    };
+
+    std::size_t formatTimestamp(char* out) const;
+    void writeLine(const char* stamp, std::size_t stampLength, const std::string& message);
+    bool tryPush(const std::string& message);
+    void startWorker();
+    void stopWorker();
+    void workerLoop();
+    void appendLine(const char* stamp, std::size_t stampLength, const std::string& message);
+    void openFile();
+    void closeFile() noexcept;
+    bool replacedOnDisk() const;
+    void writeBuffer();
+    bool rotationDue() const;
+    void requestRotation();
+    std::string rotate();
+    void maintenanceLoop();
+    void waitMaintenance();
+    void stopMaintenance();
+
+    std::string path_;            ///< Путь к лог-файлу.
+    int fd_ = -1;                 ///< Дескриптор лог-файла (O_APPEND).
+    std::uint64_t fileDevice_ = 0; ///< Устройство открытого файла.
+    std::uint64_t fileInode_ = 0; ///< Inode открытого файла (сверяется с путём).
+    std::string buffer_;          ///< Строки, ещё не записанные в файл.
+    std::uint64_t fileBytes_ = 0; ///< Размер лог-файла после последней записи.
+    std::chrono::system_clock::time_point segmentStart_; ///< Время первой строки файла.
+    std::string lastSegmentStamp_; ///< Метка времени последнего сегмента.
+    unsigned segmentCounter_ = 0; ///< Суффикс -N для сегментов в пределах одной секунды.
+    std::mutex mtx_;              ///< Мьютекс для синхронизации записи в файл.
+    LoggerOptions options_;       ///< Текущая политика записи.
+    unsigned generation_ = 0;     ///< Номер версии options_ (сбрасывает кэш меток).
+    std::chrono::steady_clock::time_point start_; ///< Точка отсчёта для Monotonic.
+
+    std::unique_ptr<Slot[]> ring_;          ///< Кольцевой буфер асинхронного режима.
+    std::size_t ringMask_ = 0;              ///< Ёмкость буфера минус один.
+    std::atomic<std::size_t> tail_{0};      ///< Следующая позиция для записи (производители).
+    std::size_t head_ = 0;                  ///< Следующая позиция для чтения (фоновый поток).
+    std::atomic<std::size_t> flushed_{0};   ///< Сколько строк записано и сброшено в файл.
+    std::atomic<bool> async_{false};        ///< Асинхронный режим включён.
+    std::atomic<bool> stop_{false};         ///< Запрос на остановку фонового потока.
+    std::atomic<bool> sleeping_{false};     ///< Фоновый поток ждёт новых строк.
+    std::atomic<bool> flushRequested_{false}; ///< Кто-то ждёт сброса в flush().
+    std::mutex wakeMtx_;                    ///< Мьютекс для ожидания фонового потока.
+    std::condition_variable wakeCv_;        ///< Будит фоновый поток.
+    std::condition_variable drainedCv_;     ///< Сообщает о дописанных строках в flush().
+    std::thread worker_;                    ///< Фоновый поток записи.
+
+    std::mutex maintMtx_;                   ///< Мьютекс очереди обслуживания.
+    std::condition_variable maintCv_;       ///< Будит поток обслуживания.
+    std::condition_variable idleCv_;        ///< Сообщает о завершённой ротации.
+    bool rotateRequested_ = false;          ///< Ротация запрошена, но ещё не начата.
+    bool maintBusy_ = false;                ///< Поток обслуживания ротирует или сжимает.
+    bool maintStop_ = false;                ///< Запрос на остановку потока обслуживания.
+    std::thread maintenance_;               ///< Фоновая ротация, сжатие и очистка сегментов.
 };
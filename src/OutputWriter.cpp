@@ -0,0 +1,280 @@
+#include "OutputWriter.hpp"
+#include "Compression.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#if defined(_WIN32) || defined(_WIN64)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+OutputFormat parseOutputFormat(const std::string& name) {
+    if (name == "text") {
+        return OutputFormat::Text;
+    } else if (name == "json") {
+        return OutputFormat::Json;
+    } else if (name == "tsv") {
+        return OutputFormat::Tsv;
+    }
+    throw std::invalid_argument("Unsupported output format: " + name);
+}
+
+OutputWriter::OutputWriter(int fd, std::size_t bufferSize)
+    : OutputWriter(fd, bufferSize, false, false) {}
+
+OutputWriter::OutputWriter(int fd, std::size_t bufferSize, bool ownsFd, bool compress)
+    : fd_(fd), ownsFd_(ownsFd), capacity_(bufferSize), buf_(new char[bufferSize]) {
+    if (compress) {
+        try {
+            gzip_ = std::make_unique<gzip::Writer>(fd);
+        } catch (...) {
+            if (ownsFd_) {
+#if defined(_WIN32) || defined(_WIN64)
+                _close(fd_);
+#else
+                ::close(fd_);
+#endif
+            }
+            throw;
+        }
+    }
+}
+
+OutputWriter::OutputWriter(std::string& target)
+    : target_(&target), capacity_(kBufferSize), buf_(new char[kBufferSize]) {}
+
+OutputWriter OutputWriter::toFile(const std::string& path, std::size_t bufferSize, bool compress) {
+#if defined(_WIN32) || defined(_WIN64)
+    int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file for export: " + path);
+    }
+    return OutputWriter(fd, bufferSize, true, compress);
+}
+
+OutputWriter::~OutputWriter() {
+    try {
+        flush();
+    } catch (...) {
+        // Деструктор не должен бросать исключения
+    }
+    gzip_.reset(); // поток сжатия пишет в fd_ — останавливаем его до закрытия
+    if (ownsFd_) {
+#if defined(_WIN32) || defined(_WIN64)
+        _close(fd_);
+#else
+        ::close(fd_);
+#endif
+    }
+}
+
+OutputWriter& OutputWriter::write(std::string_view s) {
+    if (s.size() > capacity_ - used_) {
+        flushBuffer();
+        if (s.size() >= capacity_) {
+            // Большой кусок пишем напрямую, без копирования в буфер
+            drain(s.data(), s.size());
+            return *this;
+        }
+    }
+    std::memcpy(buf_.get() + used_, s.data(), s.size());
+    used_ += s.size();
+    return *this;
+}
+
+OutputWriter& OutputWriter::put(char c) {
+    if (used_ == capacity_) {
+        flushBuffer();
+    }
+    buf_[used_++] = c;
+    return *this;
+}
+
+OutputWriter& OutputWriter::writeInt(long long value) {
+    char tmp[24];
+    char* end = tmp + sizeof(tmp);
+    char* p = end;
+    unsigned long long u = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                     : static_cast<unsigned long long>(value);
+    do {
+        *--p = static_cast<char>('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+    if (value < 0) {
+        *--p = '-';
+    }
+    return write(std::string_view(p, static_cast<std::size_t>(end - p)));
+}
+
+OutputWriter& OutputWriter::writeJsonString(std::string_view s) {
+    static const char kHex[] = "0123456789abcdef";
+    put('"');
+    std::size_t runStart = 0;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        write(s.substr(runStart, i - runStart));
+        runStart = i + 1;
+        switch (c) {
+            case '"': write("\\\""); break;
+            case '\\': write("\\\\"); break;
+            case '\n': write("\\n"); break;
+            case '\r': write("\\r"); break;
+            case '\t': write("\\t"); break;
+            default: {
+                char esc[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+                write(std::string_view(esc, sizeof(esc)));
+            }
+        }
+    }
+    write(s.substr(runStart));
+    return put('"');
+}
+
+OutputWriter& OutputWriter::writeTaskJson(const Task& t) {
+    write("{\"id\":").writeInt(t.getId());
+    write(",\"description\":").writeJsonString(t.getDescription());
+    write(t.isDone() ? ",\"done\":true" : ",\"done\":false");
+    if (t.getDueDate().has_value()) {
+        write(",\"dueDate\":").writeJsonString(*t.getDueDate());
+    }
+    const auto& tags = t.getTags();
+    if (!tags.empty()) {
+        write(",\"tags\":[");
+        for (std::size_t i = 0; i < tags.size(); ++i) {
+            if (i > 0) put(',');
+            writeJsonString(tags[i]);
+        }
+        put(']');
+    }
+    return put('}');
+}
+
+OutputWriter& OutputWriter::writeTsvField(std::string_view s) {
+    std::size_t runStart = 0;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        char c = s[i];
+        if (c != '\t' && c != '\n' && c != '\r' && c != '\\') {
+            continue;
+        }
+        write(s.substr(runStart, i - runStart));
+        runStart = i + 1;
+        switch (c) {
+            case '\t': write("\\t"); break;
+            case '\n': write("\\n"); break;
+            case '\r': write("\\r"); break;
+            default: write("\\\\"); break;
+        }
+    }
+    return write(s.substr(runStart));
+}
+
+void OutputWriter::flush() {
+    flushBuffer();
+    if (gzip_) {
+        gzip_->finish();
+    }
+}
+
+void OutputWriter::flushBuffer() {
+    if (used_ == 0) {
+        return;
+    }
+    std::size_t size = used_;
+    used_ = 0;
+    drain(buf_.get(), size);
+}
+
+void OutputWriter::drain(const char* data, std::size_t size) {
+    if (target_) {
+        target_->append(data, size);
+        return;
+    }
+    if (gzip_) {
+        gzip_->write(data, size);
+        return;
+    }
+    while (size > 0) {
+#if defined(_WIN32) || defined(_WIN64)
+        int n = _write(fd_, data, static_cast<unsigned int>(size));
+#else
+        ssize_t n = ::write(fd_, data, size);
+#endif
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("Output write failed: ") + std::strerror(errno));
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+TaskPrinter::TaskPrinter(OutputWriter& out, OutputFormat format, bool textDetails)
+    : out_(out), format_(format), textDetails_(textDetails) {
+    if (format_ == OutputFormat::Json) {
+        out_.put('[');
+    } else if (format_ == OutputFormat::Tsv) {
+        out_.write("id\tdone\tdueDate\tdescription\ttags\n");
+    }
+}
+
+void TaskPrinter::print(const Task& t) {
+    const auto& tags = t.getTags();
+    switch (format_) {
+        case OutputFormat::Text:
+            out_.put('[').writeInt(t.getId()).write("] ");
+            out_.write(t.isDone() ? "[x] " : "[ ] ").write(t.getDescription());
+            if (!textDetails_) {
+                out_.put('\n');
+                break;
+            }
+            if (t.getDueDate().has_value()) {
+                out_.write(" (due ").write(*t.getDueDate()).put(')');
+            }
+            if (!tags.empty()) {
+                out_.write(" {");
+                for (std::size_t i = 0; i < tags.size(); ++i) {
+                    if (i > 0) out_.put(',');
+                    out_.write(tags[i]);
+                }
+                out_.put('}');
+            }
+            out_.put('\n');
+            break;
+        case OutputFormat::Json:
+            out_.write(first_ ? "\n" : ",\n");
+            out_.writeTaskJson(t);
+            break;
+        case OutputFormat::Tsv:
+            out_.writeInt(t.getId()).write(t.isDone() ? "\t1\t" : "\t0\t");
+            if (t.getDueDate().has_value()) {
+                out_.writeTsvField(*t.getDueDate());
+            }
+            out_.put('\t').writeTsvField(t.getDescription()).put('\t');
+            for (std::size_t i = 0; i < tags.size(); ++i) {
+                if (i > 0) out_.put(',');
+                out_.writeTsvField(tags[i]);
+            }
+            out_.put('\n');
+            break;
+    }
+    first_ = false;
+}
+
+void TaskPrinter::finish() {
+    if (format_ == OutputFormat::Json) {
+        out_.write(first_ ? "]\n" : "\n]\n");
+    }
+    out_.flush();
+}
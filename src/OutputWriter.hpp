@@ -0,0 +1,174 @@
+#pragma once
+
+#include "Task.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Формат вывода задач в командах list и search.
+ */
+enum class OutputFormat {
+    Text, ///< Человекочитаемые строки: [id] [x] описание (due ...) {теги}.
+    Json, ///< JSON-массив объектов с теми же полями, что и Task::toJson().
+    Tsv   ///< Строка заголовка и по одной строке на задачу, поля через табуляцию.
+};
+
+/**
+ * @brief Преобразует имя формата (из --output) в OutputFormat.
+ * @param name \"text\", \"json\" или \"tsv\".
+ * @return Соответствующее значение OutputFormat.
+ * @throws std::invalid_argument Если формат не поддерживается.
+ */
+OutputFormat parseOutputFormat(const std::string& name);
+
+namespace gzip {
+class Writer;
+}
+
+/**
+ * @brief Буферизованный писатель для быстрого вывода большого числа строк.
+ *
+ * Накапливает данные в собственном буфере фиксированного размера и сбрасывает
+ * его одним системным вызовом write() на заполненный буфер, минуя iostream.
+ * Целые числа форматируются вручную, без аллокаций.
+ */
+class OutputWriter {
+public:
+    static constexpr std::size_t kBufferSize = 64 * 1024; ///< Размер буфера по умолчанию.
+
+    /**
+     * @brief Создаёт писатель в файловый дескриптор (например, 1 для stdout).
+     * @param fd         Открытый файловый дескриптор; владение не передаётся.
+     * @param bufferSize Размер буфера в байтах.
+     */
+    explicit OutputWriter(int fd, std::size_t bufferSize = kBufferSize);
+
+    /**
+     * @brief Создаёт писатель, дописывающий данные в строку.
+     * @param target Строка-приёмник; должна жить дольше писателя.
+     */
+    explicit OutputWriter(std::string& target);
+
+    /**
+     * @brief Создаёт писатель в файл (создаётся или обрезается); дескриптор закрывает деструктор.
+     *
+     * С compress данные сжимаются в gzip в отдельном потоке (gzip::Writer): заполненный
+     * буфер уходит на сжатие, а вызывающий тем временем наполняет следующий.
+     * @param path       Путь к файлу.
+     * @param bufferSize Размер буфера в байтах (для экспорта имеет смысл брать больше).
+     * @param compress   Сжимать в gzip.
+     * @throws std::runtime_error Если файл не открылся или сжатие недоступно.
+     */
+    static OutputWriter toFile(const std::string& path, std::size_t bufferSize = kBufferSize,
+                               bool compress = false);
+
+    /**
+     * @brief Сбрасывает остаток буфера (ошибки записи игнорируются).
+     */
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    /**
+     * @brief Записывает строку.
+     * @param s Данные для записи.
+     * @return Ссылка на писатель.
+     */
+    OutputWriter& write(std::string_view s);
+
+    /**
+     * @brief Записывает один символ.
+     * @param c Символ.
+     * @return Ссылка на писатель.
+     */
+    OutputWriter& put(char c);
+
+    /**
+     * @brief Записывает целое число в десятичном виде.
+     * @param value Число.
+     * @return Ссылка на писатель.
+     */
+    OutputWriter& writeInt(long long value);
+
+    /**
+     * @brief Записывает строку как JSON-строку (в кавычках, с экранированием).
+     * @param s Исходная строка в UTF-8.
+     * @return Ссылка на писатель.
+     */
+    OutputWriter& writeJsonString(std::string_view s);
+
+    /**
+     * @brief Записывает задачу компактным JSON-объектом (поля как у Task::toJson()).
+     *
+     * В отличие от toJson().dump() не строит промежуточное дерево nlohmann::json.
+     * @param t Задача.
+     * @return Ссылка на писатель.
+     */
+    OutputWriter& writeTaskJson(const Task& t);
+
+    /**
+     * @brief Записывает поле TSV, заменяя \\t, \\n, \\r и \\\\ escape-последовательностями.
+     * @param s Значение поля.
+     * @return Ссылка на писатель.
+     */
+    OutputWriter& writeTsvField(std::string_view s);
+
+    /**
+     * @brief Сбрасывает накопленный буфер в приёмник.
+     *
+     * Для сжатого файла ещё и дожимает gzip-член: после flush() файл — корректный gzip.
+     * @throws std::runtime_error При ошибке записи в дескриптор.
+     */
+    void flush();
+
+private:
+    OutputWriter(int fd, std::size_t bufferSize, bool ownsFd, bool compress);
+
+    void flushBuffer();
+    void drain(const char* data, std::size_t size);
+
+    int fd_ = -1;                    ///< Дескриптор-приёмник (или -1).
+    bool ownsFd_ = false;            ///< Закрыть fd_ в деструкторе.
+    std::string* target_ = nullptr;  ///< Строка-приёмник (или nullptr).
+    std::size_t capacity_;           ///< Размер буфера.
+    std::unique_ptr<char[]> buf_;    ///< Буфер вывода.
+    std::size_t used_ = 0;           ///< Заполненная часть буфера.
+    std::unique_ptr<gzip::Writer> gzip_; ///< Поток сжатия (или nullptr).
+};
+
+/**
+ * @brief Печатает последовательность задач в выбранном формате.
+ *
+ * Для JSON открывает массив в конструкторе и закрывает его в finish().
+ */
+class TaskPrinter {
+public:
+    /**
+     * @brief Создаёт принтер и выводит заголовок формата (если нужен).
+     * @param out         Писатель, в который идёт вывод.
+     * @param format      Формат вывода.
+     * @param textDetails В формате text печатать дедлайн и теги (search выводит только
+     *                    "[id] [x] описание", как и до появления --output).
+     */
+    TaskPrinter(OutputWriter& out, OutputFormat format, bool textDetails = true);
+
+    /**
+     * @brief Выводит одну задачу.
+     * @param t Задача.
+     */
+    void print(const Task& t);
+
+    /**
+     * @brief Завершает вывод (закрывает JSON-массив) и сбрасывает буфер.
+     */
+    void finish();
+
+private:
+    OutputWriter& out_;     ///< Приёмник вывода.
+    OutputFormat format_;   ///< Формат вывода.
+    bool textDetails_;      ///< Печатать дедлайн и теги в формате text.
+    bool first_ = true;     ///< Ещё не было выведено ни одной задачи.
+};
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Последовательность с разделяемой структурой (chunked copy-on-write vector).
+ *
+ * Элементы хранятся в блоках (chunks) по несколько сотен штук, а список блоков —
+ * в отдельном «хребте» (spine). И блоки, и хребет разделяются между копиями через
+ * shared_ptr, поэтому копирование (снимок) стоит O(1). Изменение копирует только хребет
+ * (по одному указателю на блок) и затронутый блок, если они разделены с другой копией;
+ * остальные блоки продолжают использоваться совместно.
+ *
+ * Снимок неизменяем, и его можно читать из любого потока. Сам объект, который
+ * изменяется, при этом нужно защищать внешней синхронизацией, как обычный std::vector.
+ *
+ * @tparam T Тип элемента (должен быть копируемым).
+ */
+template <typename T>
+class PersistentVector {
+public:
+    static constexpr std::size_t kChunkSize = 256; ///< Целевой размер блока.
+
+    using value_type = T;
+    using Chunk = std::vector<T>;
+
+    /**
+     * @brief Константный однонаправленный итератор по всем элементам.
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+
+        reference operator*() const {
+            return (*(*spine_)[chunk_])[offset_];
+        }
+        pointer operator->() const {
+            return &**this;
+        }
+        const_iterator& operator++() {
+            if (++offset_ == (*spine_)[chunk_]->size()) {
+                ++chunk_;
+                offset_ = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        bool operator==(const const_iterator& other) const {
+            return chunk_ == other.chunk_ && offset_ == other.offset_;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class PersistentVector;
+        const_iterator(const std::vector<std::shared_ptr<Chunk>>* spine, std::size_t chunk)
+            : spine_(spine), chunk_(chunk) {}
+
+        const std::vector<std::shared_ptr<Chunk>>* spine_ = nullptr;
+        std::size_t chunk_ = 0;
+        std::size_t offset_ = 0;
+    };
+
+    PersistentVector() = default;
+
+    /**
+     * @brief Создаёт последовательность из готового вектора.
+     * @param items Элементы (перемещаются в блоки).
+     */
+    explicit PersistentVector(std::vector<T> items) {
+        auto spine = std::make_shared<Spine>();
+        spine->reserve((items.size() + kChunkSize - 1) / kChunkSize);
+        for (std::size_t i = 0; i < items.size(); i += kChunkSize) {
+            std::size_t end = std::min(items.size(), i + kChunkSize);
+            auto chunk = std::make_shared<Chunk>();
+            chunk->reserve(end - i);
+            for (std::size_t k = i; k < end; ++k) {
+                chunk->push_back(std::move(items[k]));
+            }
+            spine->push_back(std::move(chunk));
+        }
+        size_ = items.size();
+        spine_ = std::move(spine);
+    }
+
+    /**
+     * @brief Количество элементов.
+     */
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    /**
+     * @brief Проверяет, пуста ли последовательность.
+     */
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    const_iterator begin() const noexcept {
+        return spine_ ? const_iterator(spine_.get(), 0) : const_iterator();
+    }
+
+    const_iterator end() const noexcept {
+        return spine_ ? const_iterator(spine_.get(), spine_->size()) : const_iterator();
+    }
+
+    /**
+     * @brief Доступ к элементу по индексу, O(число блоков).
+     * @param index Позиция элемента.
+     * @return const ссылка на элемент.
+     * @throws std::out_of_range Если индекс вне диапазона.
+     */
+    const T& operator[](std::size_t index) const {
+        auto [chunk, offset] = locate(index);
+        return (*(*spine_)[chunk])[offset];
+    }
+
+    /**
+     * @brief Возвращает изменяемую ссылку на элемент, предварительно скопировав
+     *        хребет и содержащий его блок, если они разделены с другими копиями.
+     * @param index Позиция элемента.
+     * @return Ссылка, действительная до следующего изменения.
+     * @throws std::out_of_range Если индекс вне диапазона.
+     */
+    T& mutableAt(std::size_t index) {
+        auto [chunk, offset] = locate(index);
+        return (*mutableChunk(chunk))[offset];
+    }
+
+    /**
+     * @brief Добавляет элемент в конец.
+     * @param value Новый элемент.
+     */
+    void push_back(T value) {
+        insert(size_, std::move(value));
+    }
+
+    /**
+     * @brief Конструирует элемент в конце последнего блока (без временного объекта).
+     * @param args Аргументы конструктора T.
+     * @return Ссылка на новый элемент, действительная до следующего изменения.
+     */
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        Spine& spine = mutableSpine();
+        if (spine.empty() || spine.back()->size() >= kChunkSize) {
+            auto chunk = std::make_shared<Chunk>();
+            chunk->reserve(kChunkSize);
+            T& item = chunk->emplace_back(std::forward<Args>(args)...);
+            spine.push_back(std::move(chunk));
+            ++size_;
+            return item;
+        }
+        T& item = mutableChunk(spine.size() - 1)->emplace_back(std::forward<Args>(args)...);
+        ++size_;
+        return item;
+    }
+
+    /**
+     * @brief Вставляет элемент перед позицией index.
+     * @param index Позиция (0..size()).
+     * @param value Новый элемент.
+     * @throws std::out_of_range Если index > size().
+     */
+    void insert(std::size_t index, T value) {
+        if (index > size_) {
+            throw std::out_of_range("PersistentVector::insert index out of range");
+        }
+        Spine& spine = mutableSpine();
+        if (spine.empty() || (index == size_ && spine.back()->size() >= kChunkSize)) {
+            // Начинаем новый блок, чтобы не копировать заполненный
+            auto chunk = std::make_shared<Chunk>();
+            chunk->reserve(kChunkSize);
+            chunk->push_back(std::move(value));
+            spine.push_back(std::move(chunk));
+            ++size_;
+            return;
+        }
+        std::size_t chunkIdx = 0;
+        std::size_t offset = index;
+        while (chunkIdx + 1 < spine.size() && offset > spine[chunkIdx]->size()) {
+            offset -= spine[chunkIdx]->size();
+            ++chunkIdx;
+        }
+        Chunk& chunk = *mutableChunk(chunkIdx);
+        chunk.insert(chunk.begin() + static_cast<std::ptrdiff_t>(offset), std::move(value));
+        ++size_;
+        if (chunk.size() >= 2 * kChunkSize) {
+            // Делим переполненный блок пополам
+            auto tail = std::make_shared<Chunk>(std::make_move_iterator(chunk.begin() + kChunkSize),
+                                                std::make_move_iterator(chunk.end()));
+            chunk.erase(chunk.begin() + kChunkSize, chunk.end());
+            spine.insert(spine.begin() + static_cast<std::ptrdiff_t>(chunkIdx) + 1,
+                         std::move(tail));
+        }
+    }
+
+    /**
+     * @brief Удаляет элемент.
+     * @param index Позиция элемента.
+     * @throws std::out_of_range Если индекс вне диапазона.
+     */
+    void erase(std::size_t index) {
+        auto [chunkIdx, offset] = locate(index);
+        Chunk& chunk = *mutableChunk(chunkIdx);
+        chunk.erase(chunk.begin() + static_cast<std::ptrdiff_t>(offset));
+        --size_;
+        if (chunk.empty()) {
+            Spine& spine = mutableSpine();
+            spine.erase(spine.begin() + static_cast<std::ptrdiff_t>(chunkIdx));
+        }
+    }
+
+    /**
+     * @brief Удаляет все элементы (разделённые блоки остаются у других копий).
+     */
+    void clear() noexcept {
+        spine_.reset();
+        size_ = 0;
+    }
+
+    /**
+     * @brief Разделяет ли копия с other всё содержимое (ни одна из них не менялась после копирования).
+     *
+     * Пока обе копии живы, изменение любой из них заводит свой хребет, поэтому
+     * совпадение хребтов означает одинаковые элементы.
+     */
+    bool sharesStorageWith(const PersistentVector& other) const noexcept {
+        return spine_ == other.spine_ && size_ == other.size_;
+    }
+
+    /**
+     * @brief Копирует элементы в обычный вектор.
+     * @return Вектор из size() элементов в исходном порядке.
+     */
+    std::vector<T> toVector() const {
+        std::vector<T> out;
+        out.reserve(size_);
+        for (const auto& item : *this) {
+            out.push_back(item);
+        }
+        return out;
+    }
+
+private:
+    using Spine = std::vector<std::shared_ptr<Chunk>>;
+
+    std::pair<std::size_t, std::size_t> locate(std::size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("PersistentVector index out of range");
+        }
+        std::size_t chunk = 0;
+        while (index >= (*spine_)[chunk]->size()) {
+            index -= (*spine_)[chunk]->size();
+            ++chunk;
+        }
+        return {chunk, index};
+    }
+
+    /**
+     * @brief Единственный ли это владелец: можно ли менять объект на месте.
+     *
+     * use_count() читается без упорядочивания, а последнюю копию могли отпустить в
+     * другом потоке (читатель снимка). Барьер acquire образует пару с release-уменьшением
+     * счётчика в её деструкторе, и запись на месте идёт строго после чтений той копии.
+     */
+    template <typename U>
+    static bool soleOwner(const std::shared_ptr<U>& p) noexcept {
+        if (p.use_count() > 1) {
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+
+    Spine& mutableSpine() {
+        if (!spine_) {
+            spine_ = std::make_shared<Spine>();
+        } else if (!soleOwner(spine_)) {
+            spine_ = std::make_shared<Spine>(*spine_);
+        }
+        return *spine_;
+    }
+
+    std::shared_ptr<Chunk>& mutableChunk(std::size_t chunkIdx) {
+        std::shared_ptr<Chunk>& chunk = mutableSpine()[chunkIdx];
+        if (!soleOwner(chunk)) {
+            auto copy = std::make_shared<Chunk>();
+            copy->reserve(std::max(chunk->size() + 1, kChunkSize));
+            copy->insert(copy->end(), chunk->begin(), chunk->end());
+            chunk = std::move(copy);
+        }
+        return chunk;
+    }
+
+    std::shared_ptr<Spine> spine_; ///< Список блоков (nullptr для пустой последовательности).
+    std::size_t size_ = 0;         ///< Общее число элементов.
+};
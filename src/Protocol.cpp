@@ -0,0 +1,131 @@
+#include "Protocol.hpp"
+#include <stdexcept>
+
+namespace protocol {
+
+namespace {
+
+void putU32(std::uint32_t value, std::string& out) {
+    char bytes[4] = {static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF),
+                     static_cast<char>((value >> 16) & 0xFF), static_cast<char>((value >> 24) & 0xFF)};
+    out.append(bytes, 4);
+}
+
+std::uint32_t getU32(const char* p) {
+    auto b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<std::uint32_t>(b[0]) | (static_cast<std::uint32_t>(b[1]) << 8) |
+           (static_cast<std::uint32_t>(b[2]) << 16) | (static_cast<std::uint32_t>(b[3]) << 24);
+}
+
+// Резервирует место под заголовок и возвращает его позицию
+std::size_t beginFrame(std::string& out) {
+    std::size_t pos = out.size();
+    out.append(kHeaderSize, '\0');
+    return pos;
+}
+
+void endFrame(std::string& out, std::size_t headerPos) {
+    std::size_t length = out.size() - headerPos - kHeaderSize;
+    if (length > kMaxFrameSize) {
+        throw std::runtime_error("Frame too large: " + std::to_string(length) + " bytes");
+    }
+    std::string header;
+    putU32(static_cast<std::uint32_t>(length), header);
+    out.replace(headerPos, kHeaderSize, header);
+}
+
+} // namespace
+
+void appendRequest(const std::vector<std::string>& args, std::string& out) {
+    std::size_t header = beginFrame(out);
+    for (const auto& arg : args) {
+        putU32(static_cast<std::uint32_t>(arg.size()), out);
+        out += arg;
+    }
+    endFrame(out, header);
+}
+
+std::vector<std::string> decodeRequest(std::string_view payload) {
+    std::vector<std::string> args;
+    std::size_t pos = 0;
+    while (pos < payload.size()) {
+        if (payload.size() - pos < 4) {
+            throw std::runtime_error("Malformed request frame");
+        }
+        std::uint32_t length = getU32(payload.data() + pos);
+        pos += 4;
+        if (payload.size() - pos < length) {
+            throw std::runtime_error("Malformed request frame");
+        }
+        args.emplace_back(payload.substr(pos, length));
+        pos += length;
+    }
+    return args;
+}
+
+void appendResponse(int status, std::string_view body, std::string& out) {
+    // Нагрузка кадра — байт статуса и кусок вывода
+    constexpr std::size_t kChunk = kMaxFrameSize - 1;
+    while (body.size() > kChunk) {
+        std::size_t header = beginFrame(out);
+        out += static_cast<char>(kStatusContinued);
+        out.append(body.data(), kChunk);
+        endFrame(out, header);
+        body.remove_prefix(kChunk);
+    }
+    std::size_t header = beginFrame(out);
+    out += static_cast<char>(status);
+    out += body;
+    endFrame(out, header);
+}
+
+Response decodeResponse(std::string_view payload) {
+    if (payload.empty()) {
+        throw std::runtime_error("Malformed response frame");
+    }
+    return Response{static_cast<unsigned char>(payload[0]), std::string(payload.substr(1))};
+}
+
+bool assembleResponse(std::string_view payload, Response& pending) {
+    if (payload.empty()) {
+        throw std::runtime_error("Malformed response frame");
+    }
+    pending.body.append(payload.data() + 1, payload.size() - 1);
+    pending.status = static_cast<unsigned char>(payload[0]);
+    return pending.status != kStatusContinued;
+}
+
+void FrameReader::feed(const char* data, std::size_t size) {
+    if (offset_ > 0 && offset_ == buffer_.size()) {
+        buffer_.clear();
+        offset_ = 0;
+    }
+    buffer_.append(data, size);
+}
+
+bool FrameReader::next(std::string& payload) {
+    if (buffer_.size() - offset_ < kHeaderSize) {
+        return false;
+    }
+    std::uint32_t length = getU32(buffer_.data() + offset_);
+    if (length > kMaxFrameSize) {
+        throw std::runtime_error("Frame too large: " + std::to_string(length) + " bytes");
+    }
+    if (buffer_.size() - offset_ - kHeaderSize < length) {
+        return false;
+    }
+    payload.assign(buffer_, offset_ + kHeaderSize, length);
+    offset_ += kHeaderSize + length;
+    if (offset_ > 64 * 1024 && offset_ * 2 > buffer_.size()) {
+        // Сдвигаем остаток, чтобы буфер не рос при долгом соединении
+        buffer_.erase(0, offset_);
+        offset_ = 0;
+    }
+    return true;
+}
+
+bool FrameReader::hasPartial() const noexcept {
+    return offset_ < buffer_.size();
+}
+
+} // namespace protocol
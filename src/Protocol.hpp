@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Кадрированный протокол между клиентом и демоном (serve).
+ *
+ * Каждое сообщение — кадр: 4 байта длины (little-endian) и полезная нагрузка.
+ * Запрос: аргументы командной строки без имени программы, каждый как
+ * [u32 длина][байты]. Ответ: 1 байт статуса (0 — успех, 1 — ошибка) и текст вывода.
+ * Вывод длиннее одного кадра (list большого хранилища) идёт несколькими кадрами:
+ * все, кроме последнего, несут статус kStatusContinued, последний — итоговый статус.
+ * По одному соединению можно отправить несколько запросов подряд; ответы
+ * приходят в том же порядке.
+ */
+namespace protocol {
+
+constexpr std::size_t kHeaderSize = 4;                 ///< Размер заголовка кадра.
+constexpr std::size_t kMaxFrameSize = 16 * 1024 * 1024; ///< Максимальная нагрузка кадра.
+constexpr int kStatusContinued = 2; ///< Кадр ответа — часть вывода, за ним следуют ещё кадры.
+
+/**
+ * @brief Ответ демона.
+ */
+struct Response {
+    int status = 0;   ///< 0 — успех, иначе код ошибки.
+    std::string body; ///< Вывод команды или текст ошибки.
+};
+
+/**
+ * @brief Дописывает в out кадр с аргументами запроса.
+ * @param args Аргументы команды (без имени программы).
+ * @param out  Буфер, к которому добавляется кадр.
+ */
+void appendRequest(const std::vector<std::string>& args, std::string& out);
+
+/**
+ * @brief Разбирает нагрузку кадра запроса.
+ * @param payload Нагрузка без заголовка.
+ * @return Аргументы команды.
+ * @throws std::runtime_error Если нагрузка повреждена.
+ */
+std::vector<std::string> decodeRequest(std::string_view payload);
+
+/**
+ * @brief Дописывает в out ответ: один кадр или, если вывод не помещается, несколько.
+ * @param status Статус (0 — успех).
+ * @param body   Вывод команды.
+ * @param out    Буфер, к которому добавляются кадры.
+ */
+void appendResponse(int status, std::string_view body, std::string& out);
+
+/**
+ * @brief Разбирает нагрузку одного кадра ответа.
+ * @throws std::runtime_error Если нагрузка пуста.
+ */
+Response decodeResponse(std::string_view payload);
+
+/**
+ * @brief Добавляет кадр ответа к собираемому ответу.
+ * @param payload Нагрузка кадра.
+ * @param pending Собираемый ответ: тело дописывается, статус берётся из последнего кадра.
+ * @return true, если кадр последний и ответ собран.
+ * @throws std::runtime_error Если нагрузка пуста.
+ */
+bool assembleResponse(std::string_view payload, Response& pending);
+
+/**
+ * @brief Собирает кадры из потока байт, приходящих произвольными кусками.
+ */
+class FrameReader {
+public:
+    /**
+     * @brief Добавляет принятые байты.
+     */
+    void feed(const char* data, std::size_t size);
+
+    /**
+     * @brief Извлекает следующий полный кадр.
+     * @param payload Сюда записывается нагрузка кадра.
+     * @return false, если полного кадра ещё нет.
+     * @throws std::runtime_error Если заявленная длина больше kMaxFrameSize.
+     */
+    bool next(std::string& payload);
+
+    /**
+     * @brief Есть ли принятые, но ещё не разобранные байты.
+     */
+    bool hasPartial() const noexcept;
+
+private:
+    std::string buffer_;     ///< Принятые байты.
+    std::size_t offset_ = 0; ///< Начало неразобранной части buffer_.
+};
+
+} // namespace protocol
@@ -0,0 +1,543 @@
+#include "Server.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <csignal>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace {
+
+std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+sockaddr_un makeAddress(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+// Пишет буфер целиком, повторяя при EINTR и частичной записи (блокирующий сокет)
+bool writeAll(int fd, const std::string& data) {
+    std::size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+#endif
+
+#if defined(__linux__)
+
+constexpr std::uint64_t kListenTag = 0; ///< epoll data для слушающего сокета.
+constexpr std::uint64_t kWakeTag = 1;   ///< epoll data для eventfd.
+
+// Разбирает кадр запроса как командную строку
+CLIOptions parseRequest(const std::string& payload) {
+    std::vector<std::string> args = protocol::decodeRequest(payload);
+    std::vector<char*> argv;
+    static char progName[] = "ToDoManager";
+    argv.push_back(progName);
+    for (auto& a : args) {
+        argv.push_back(&a[0]);
+    }
+    CLIOptions opts = CLIParser::parse(static_cast<int>(argv.size()), argv.data());
+    if (opts.args.count("data-file") || opts.args.count("store-format")) {
+        throw std::runtime_error("--data-file and --store-format are set when the daemon starts");
+    }
+    if (opts.command == "serve" || opts.command == "batch") {
+        throw std::runtime_error("Command is not available through the daemon: " + opts.command);
+    }
+    return opts;
+}
+
+// Запрос отбирает задачи по столбцам TaskTable (а не выводит все подряд)
+bool filtersTasks(const CLIOptions& opts) {
+    auto has = [&](const char* key) { return opts.args.count(key) > 0; };
+    bool doneFilter = has("filter") && opts.args.at("filter") != "all";
+    if (opts.command == "search") {
+        return true;
+    }
+    if (opts.command == "export") {
+        return doneFilter || has("search") || has("tag");
+    }
+    return doneFilter;
+}
+
+std::string errorFrame(const std::string& message) {
+    std::string frame;
+    protocol::appendResponse(1, "Error: " + message + "\n", frame);
+    return frame;
+}
+
+#endif
+
+} // namespace
+
+#if defined(__linux__)
+
+Server::Server(std::string socketPath, CommandProcessor& processor, std::size_t workers)
+    : socketPath_(std::move(socketPath)), processor_(processor), pool_(workers) {
+    sockaddr_un addr = makeAddress(socketPath_);
+    int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        throw systemError("Cannot create socket");
+    }
+    bool running = ::connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    ::close(probe);
+    if (running) {
+        throw std::runtime_error("Daemon is already running on " + socketPath_);
+    }
+    // Никто не отвечает — файл остался от упавшего демона
+    ::unlink(socketPath_.c_str());
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0 || ::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+        || ::listen(listenFd_, SOMAXCONN) != 0) {
+        std::runtime_error err = systemError("Cannot listen on " + socketPath_);
+        if (listenFd_ >= 0) {
+            ::close(listenFd_);
+        }
+        throw err;
+    }
+    // Доступ к задачам — только у владельца
+    ::chmod(socketPath_.c_str(), S_IRUSR | S_IWUSR);
+
+    epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.u64 = kListenTag;
+    bool ok = epollFd_ >= 0 && wakeFd_ >= 0
+              && ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &ev) == 0;
+    ev.data.u64 = kWakeTag;
+    if (!ok || ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev) != 0) {
+        std::runtime_error err = systemError("Cannot set up epoll");
+        if (epollFd_ >= 0) ::close(epollFd_);
+        if (wakeFd_ >= 0) ::close(wakeFd_);
+        ::close(listenFd_);
+        ::unlink(socketPath_.c_str());
+        throw err;
+    }
+}
+
+Server::~Server() {
+    // Задачи пула пишут в wakeFd_, поэтому сначала дожидаемся их
+    pool_.shutdown();
+    for (auto& entry : connections_) {
+        ::close(entry.second->fd);
+    }
+    ::close(wakeFd_);
+    ::close(epollFd_);
+    ::close(listenFd_);
+    ::unlink(socketPath_.c_str());
+}
+
+void Server::run() {
+    // Запись в сокет ушедшего клиента не должна завершать демон
+    std::signal(SIGPIPE, SIG_IGN);
+    epoll_event events[128];
+    while (!stopping_.load(std::memory_order_acquire)) {
+        int n = ::epoll_wait(epollFd_, events, 128, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("epoll_wait failed");
+        }
+        for (int i = 0; i < n; ++i) {
+            std::uint64_t tag = events[i].data.u64;
+            if (tag == kListenTag) {
+                acceptAll();
+                continue;
+            }
+            if (tag == kWakeTag) {
+                std::uint64_t counter;
+                while (::read(wakeFd_, &counter, sizeof(counter)) > 0) {
+                }
+                drainCompletions();
+                continue;
+            }
+            auto it = connections_.find(tag);
+            if (it == connections_.end()) {
+                continue;
+            }
+            Connection& conn = *it->second;
+            if (events[i].events & EPOLLERR) {
+                conn.broken = true;
+            }
+            // Сначала отправляем накопленное: это может снять паузу чтения
+            if (events[i].events & EPOLLOUT) {
+                deliver(conn);
+            }
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) || conn.paused) {
+                readInput(conn);
+            }
+            touched_.push_back(conn.id);
+        }
+        commitAndDeliver();
+    }
+    if (!fatal_.empty()) {
+        throw std::runtime_error(fatal_);
+    }
+}
+
+void Server::stop() noexcept {
+    stopping_.store(true, std::memory_order_release);
+    std::uint64_t one = 1;
+    // write() в eventfd допустим в обработчике сигнала
+    ssize_t ignored = ::write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void Server::acceptAll() {
+    while (true) {
+        int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // EAGAIN — очередь разобрана; прочие ошибки (EMFILE) переживём до следующего события
+            return;
+        }
+        auto conn = std::make_unique<Connection>();
+        conn->id = nextConnId_++;
+        conn->fd = fd;
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.u64 = conn->id;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_.emplace(conn->id, std::move(conn));
+    }
+}
+
+bool Server::backlogged(const Connection& conn) const noexcept {
+    return conn.out.size() - conn.outOffset > kMaxPendingOutput
+           || conn.pending.size() >= kMaxPipeline;
+}
+
+void Server::readInput(Connection& conn) {
+    char buf[64 * 1024];
+    std::string payload;
+    while (!conn.broken) {
+        // Сначала разбираем уже принятые кадры
+        try {
+            while (!backlogged(conn) && conn.reader.next(payload)) {
+                dispatch(conn, payload);
+            }
+        } catch (const std::exception&) {
+            // Повреждённый кадр — дальше поток не разобрать
+            conn.broken = true;
+            return;
+        }
+        if (backlogged(conn)) {
+            // Клиент не успевает читать ответы: перестаём читать его запросы
+            conn.paused = true;
+            return;
+        }
+        conn.paused = false;
+        if (conn.eof) {
+            return;
+        }
+        ssize_t n = ::read(conn.fd, buf, sizeof(buf));
+        if (n > 0) {
+            conn.reader.feed(buf, static_cast<std::size_t>(n));
+        } else if (n == 0) {
+            conn.eof = true;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;
+        } else if (errno != EINTR) {
+            conn.broken = true;
+        }
+    }
+}
+
+void Server::dispatch(Connection& conn, const std::string& payload) {
+    std::uint64_t seq = conn.firstSeq + conn.pending.size();
+    conn.pending.emplace_back();
+    Pending& slot = conn.pending.back();
+    try {
+        if (!syncedThisRound_) {
+            // Раз за пачку подхватываем изменения, сохранённые другими процессами
+            syncedThisRound_ = true;
+            processor_.reloadIfChanged();
+        }
+        CLIOptions opts = parseRequest(payload);
+        if (CommandProcessor::isQuery(opts)) {
+            // Чтение — в пуле над O(1)-копией менеджера; реактор тем временем обслуживает
+            // остальных. Таблицу столбцов, если её ещё нет, строит пул и отдаёт реактору
+            TaskManager view = processor_.manager();
+            pool_.submit([this, id = conn.id, seq, opts = std::move(opts),
+                          view = std::move(view)]() mutable {
+                Completion done{id, seq, {}, {}, {}, std::nullopt};
+                std::string body;
+                try {
+                    if (filtersTasks(opts)) {
+                        // Таблица понадобится и следующим запросам
+                        view.table();
+                        done.view = view;
+                    }
+                    {
+                        OutputWriter writer(body);
+                        CommandProcessor::runQuery(view, opts, writer);
+                    }
+                    protocol::appendResponse(0, body, done.frame);
+                    if (opts.command == "export") {
+                        done.exportFormat = opts.args.at("format");
+                        done.exportPath = opts.args.at("out");
+                    }
+                } catch (const std::exception& ex) {
+                    done.frame = errorFrame(ex.what());
+                }
+                {
+                    std::lock_guard<std::mutex> lock(completionsMtx_);
+                    completions_.push_back(std::move(done));
+                }
+                std::uint64_t one = 1;
+                ssize_t ignored = ::write(wakeFd_, &one, sizeof(one));
+                (void)ignored;
+            });
+            return;
+        }
+        std::string body;
+        {
+            OutputWriter writer(body);
+            processor_.execute(opts, writer);
+        }
+        protocol::appendResponse(0, body, slot.frame);
+        slot.uncommitted = true;
+    } catch (const std::exception& ex) {
+        slot.frame = errorFrame(ex.what());
+    }
+    slot.ready = true;
+}
+
+void Server::drainCompletions() {
+    std::vector<Completion> done;
+    {
+        std::lock_guard<std::mutex> lock(completionsMtx_);
+        done.swap(completions_);
+    }
+    for (auto& c : done) {
+        if (c.view) {
+            // Таблица, построенная пулом, годится, если задачи с тех пор не менялись
+            processor_.manager().adoptTable(*c.view);
+        }
+        if (!c.exportPath.empty()) {
+            processor_.recordExport(c.exportFormat, c.exportPath);
+        }
+        auto it = connections_.find(c.connId);
+        if (it == connections_.end()) {
+            // Клиент ушёл, не дождавшись ответа
+            continue;
+        }
+        Connection& conn = *it->second;
+        Pending& slot = conn.pending[static_cast<std::size_t>(c.seq - conn.firstSeq)];
+        slot.frame = std::move(c.frame);
+        slot.ready = true;
+        touched_.push_back(conn.id);
+    }
+}
+
+void Server::commitAndDeliver() {
+    while (!touched_.empty()) {
+        // Одно сохранение на пачку событий; ответы на изменения — только после него
+        std::string failure;
+        bool wasDirty = processor_.dirty();
+        try {
+            processor_.commit();
+        } catch (const std::exception& ex) {
+            // Если упали только журналы, файл данных уже сохранён и ответы верны
+            if (!wasDirty || processor_.dirty()) {
+                failure = ex.what();
+                // Файл сохранил другой процесс: изменения пачки отбрасываются, клиент повторит
+                failure += dynamic_cast<const StaleDataError*>(&ex)
+                               ? "; changes discarded, retry the command"
+                               : "; changes discarded";
+            }
+            // Память должна совпасть с файлом, иначе следующее сохранение запишет отвергнутое
+            rollback();
+        }
+        syncedThisRound_ = false;
+        std::vector<std::uint64_t> touched;
+        touched.swap(touched_);
+        for (std::uint64_t id : touched) {
+            auto it = connections_.find(id);
+            if (it == connections_.end()) {
+                continue;
+            }
+            Connection& conn = *it->second;
+            for (auto& slot : conn.pending) {
+                if (slot.uncommitted) {
+                    slot.uncommitted = false;
+                    if (!failure.empty()) {
+                        slot.frame = errorFrame("Cannot save changes: " + failure);
+                    }
+                }
+            }
+            if (deliver(conn) && conn.paused) {
+                // Ответы ушли — продолжаем читать приостановленное соединение;
+                // новые изменения сохранятся на следующем круге
+                readInput(conn);
+                touched_.push_back(conn.id);
+            }
+            if (conn.broken
+                || (conn.eof && conn.pending.empty() && conn.outOffset == conn.out.size())) {
+                // Закрытие fd само убирает его из epoll
+                ::close(conn.fd);
+                connections_.erase(it);
+            }
+        }
+    }
+}
+
+void Server::rollback() {
+    try {
+        processor_.reload();
+    } catch (const std::exception& ex) {
+        // Отвергнутые изменения остались в памяти: дальше обслуживать нельзя
+        fatal_ = std::string("Cannot reload data file after a failed save: ") + ex.what();
+        stopping_.store(true, std::memory_order_release);
+    }
+}
+
+bool Server::deliver(Connection& conn) {
+    while (!conn.pending.empty() && conn.pending.front().ready
+           && !conn.pending.front().uncommitted) {
+        conn.out += conn.pending.front().frame;
+        conn.pending.pop_front();
+        ++conn.firstSeq;
+    }
+    while (conn.outOffset < conn.out.size()) {
+        ssize_t n = ::write(conn.fd, conn.out.data() + conn.outOffset,
+                            conn.out.size() - conn.outOffset);
+        if (n > 0) {
+            conn.outOffset += static_cast<std::size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Допишем по EPOLLOUT
+            return !backlogged(conn);
+        } else {
+            conn.broken = true;
+            return false;
+        }
+    }
+    conn.out.clear();
+    conn.outOffset = 0;
+    return !backlogged(conn);
+}
+
+#else
+
+// Реактор построен на epoll и eventfd, которые есть только в Linux
+Server::Server(std::string socketPath, CommandProcessor& processor, std::size_t workers)
+    : socketPath_(std::move(socketPath)), processor_(processor), pool_(workers) {
+    throw std::runtime_error("serve is not supported on this platform");
+}
+Server::~Server() = default;
+void Server::run() {}
+void Server::stop() noexcept {}
+
+#endif
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+Client::Client(const std::string& socketPath) {
+    sockaddr_un addr = makeAddress(socketPath);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0) {
+        throw systemError("Cannot create socket");
+    }
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::runtime_error err = systemError("Cannot connect to " + socketPath);
+        ::close(fd_);
+        throw err;
+    }
+}
+
+Client::~Client() {
+    ::close(fd_);
+}
+
+protocol::Response Client::call(const std::vector<std::string>& args) {
+    return pipeline({args}).front();
+}
+
+std::vector<protocol::Response> Client::pipeline(
+    const std::vector<std::vector<std::string>>& requests) {
+    std::string frames;
+    for (const auto& args : requests) {
+        protocol::appendRequest(args, frames);
+    }
+    if (!writeAll(fd_, frames)) {
+        throw systemError("Cannot send request");
+    }
+    std::vector<protocol::Response> responses;
+    responses.reserve(requests.size());
+    std::string payload;
+    protocol::Response pending;
+    char buf[64 * 1024];
+    while (responses.size() < requests.size()) {
+        if (reader_.next(payload)) {
+            // Большой вывод приходит несколькими кадрами
+            if (protocol::assembleResponse(payload, pending)) {
+                responses.push_back(std::move(pending));
+                pending = protocol::Response{};
+            }
+            continue;
+        }
+        ssize_t n = ::read(fd_, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error("Connection closed by daemon");
+        }
+        reader_.feed(buf, static_cast<std::size_t>(n));
+    }
+    return responses;
+}
+
+#else
+
+Client::Client(const std::string&) {
+    throw std::runtime_error("--connect is not supported on this platform");
+}
+Client::~Client() = default;
+protocol::Response Client::call(const std::vector<std::string>&) {
+    return {};
+}
+std::vector<protocol::Response> Client::pipeline(const std::vector<std::vector<std::string>>&) {
+    return {};
+}
+
+#endif
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "CommandProcessor.hpp"
+#include "Protocol.hpp"
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Резидентный демон (serve): держит задачи в памяти и принимает команды
+ *        через Unix-сокет по протоколу из Protocol.hpp.
+ *
+ * Все соединения обслуживает один поток-реактор на edge-triggered epoll с
+ * неблокирующими сокетами. Клиент может отправлять запросы, не дожидаясь ответов
+ * (pipelining): всё, что пришло за одно чтение, разбирается сразу, а ответы
+ * собираются и отправляются одной записью, строго в порядке запросов.
+ *
+ * Изменяющие команды выполняются в реакторе; файл данных сохраняется один раз на
+ * каждую пачку событий, и ответы на изменения уходят только после сохранения.
+ * Перед пачкой демон подхватывает изменения файла другими процессами; если файл
+ * изменили во время пачки или сохранить не удалось, её изменения отбрасываются
+ * перечитыванием файла, и клиенты получают ошибку; если не удалось и перечитать,
+ * демон останавливается, чтобы не сохранить отвергнутые изменения позже.
+ * list, search и export выполняются в пуле потоков над O(1)-снимком задач; там же
+ * строится таблица столбцов для фильтров, которую реактор затем берёт себе.
+ * Если клиент не читает ответы, его соединение перестаёт читаться (не более
+ * kMaxPendingOutput байт и kMaxPipeline запросов в очереди), остальные клиенты не ждут.
+ * --data-file и --store-format задаются при запуске демона.
+ */
+class Server {
+public:
+    static constexpr std::size_t kMaxPendingOutput = 1024 * 1024; ///< Лимит неотправленного вывода.
+    static constexpr std::size_t kMaxPipeline = 1024;             ///< Лимит запросов без ответа.
+
+    /**
+     * @brief Создаёт сокет и начинает слушать его.
+     *
+     * Оставшийся от упавшего демона файл сокета удаляется; если по нему
+     * отвечает работающий демон, бросается исключение.
+     * @param socketPath Путь к Unix-сокету.
+     * @param processor  Исполнитель команд (должен жить дольше сервера).
+     * @param workers    Потоков для запросов на чтение (0 — по числу ядер).
+     * @throws std::runtime_error Если сокет не удалось создать.
+     */
+    Server(std::string socketPath, CommandProcessor& processor, std::size_t workers = 0);
+
+    /**
+     * @brief Закрывает соединения и удаляет файл сокета.
+     */
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /**
+     * @brief Обслуживает клиентов, пока не будет вызван stop().
+     * @throws std::runtime_error Если после неудачного сохранения не удалось перечитать
+     *         файл данных: задачи в памяти больше не совпадают с ним, и демон останавливается.
+     */
+    void run();
+
+    /**
+     * @brief Просит run() завершиться; можно вызывать из другого потока или обработчика сигнала.
+     */
+    void stop() noexcept;
+
+private:
+    /// Ответ в очереди соединения (готовый или ожидающий пула).
+    struct Pending {
+        bool ready = false;       ///< frame заполнен.
+        bool uncommitted = false; ///< Ответ на изменение, ещё не сохранённое в файл.
+        std::string frame;        ///< Кадр ответа.
+    };
+
+    struct Connection {
+        std::uint64_t id = 0;
+        int fd = -1;
+        protocol::FrameReader reader;
+        std::deque<Pending> pending;  ///< Ответы в порядке запросов.
+        std::uint64_t firstSeq = 0;   ///< Номер запроса pending.front().
+        std::string out;              ///< Собранные, но не отправленные ответы.
+        std::size_t outOffset = 0;    ///< Сколько байт out уже отправлено.
+        bool paused = false;          ///< Чтение приостановлено из-за лимитов.
+        bool eof = false;             ///< Клиент закрыл свою сторону.
+        bool broken = false;          ///< Ошибка сокета или протокола.
+    };
+
+    /// Результат запроса, выполненного в пуле.
+    struct Completion {
+        std::uint64_t connId;
+        std::uint64_t seq;
+        std::string frame;
+        std::string exportFormat; ///< Непусто, если выполнен export.
+        std::string exportPath;
+        std::optional<TaskManager> view; ///< Копия, построившая таблицу столбцов для реактора.
+    };
+
+    void acceptAll();
+    void readInput(Connection& conn);
+    bool backlogged(const Connection& conn) const noexcept;
+    void dispatch(Connection& conn, const std::string& payload);
+    void drainCompletions();
+    void commitAndDeliver();
+    bool deliver(Connection& conn);
+    void rollback();
+
+    std::string socketPath_;
+    CommandProcessor& processor_;
+    int listenFd_ = -1;
+    int epollFd_ = -1;
+    int wakeFd_ = -1;                    ///< eventfd: stop() и готовые ответы пула.
+    std::atomic<bool> stopping_{false};
+    std::uint64_t nextConnId_ = 2;       ///< 0 и 1 заняты сокетом и eventfd.
+    std::unordered_map<std::uint64_t, std::unique_ptr<Connection>> connections_;
+    std::vector<std::uint64_t> touched_; ///< Соединения с новыми ответами в этой пачке.
+    bool syncedThisRound_ = false;       ///< Файл данных уже сверен в этой пачке.
+    std::string fatal_;                  ///< Почему демон остановился (память разошлась с файлом).
+
+    std::mutex completionsMtx_;
+    std::vector<Completion> completions_; ///< Ответы пула для реактора.
+    ThreadPool pool_;                     ///< Потоки для list/search/export.
+};
+
+/**
+ * @brief Тонкий клиент: пересылает аргументы командной строки демону.
+ */
+class Client {
+public:
+    /**
+     * @brief Подключается к демону.
+     * @param socketPath Путь к Unix-сокету.
+     * @throws std::runtime_error Если демон недоступен.
+     */
+    explicit Client(const std::string& socketPath);
+    ~Client();
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    /**
+     * @brief Отправляет команду и ждёт ответа.
+     * @param args Аргументы команды без имени программы.
+     * @return Статус и вывод команды.
+     * @throws std::runtime_error При обрыве соединения.
+     */
+    protocol::Response call(const std::vector<std::string>& args);
+
+    /**
+     * @brief Отправляет несколько команд одной записью и ждёт всех ответов.
+     * @param requests Команды по порядку.
+     * @return Ответы в том же порядке.
+     * @throws std::runtime_error При обрыве соединения.
+     */
+    std::vector<protocol::Response> pipeline(const std::vector<std::vector<std::string>>& requests);
+
+private:
+    int fd_ = -1;
+    protocol::FrameReader reader_;
+};
@@ -1,26 +1,108 @@
 #include "Storage.hpp"
+#include "Compression.hpp"
+#include "OutputWriter.hpp"
+#include "TaskImporter.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <stdexcept>
-#include <sstream>           // для разбора строк тегов
+#include <string_view>
 #include <sqlite3.h>        // если используем SQLite
 #include <json.hpp>
 
-Storage::Storage(const std::string& dataFilePath, const std::string& format)
-    : dataFilePath_(dataFilePath), format_(format) {}
+namespace {
 
-std::vector<Task> Storage::load() {
-    if (format_ == "json") {
-        std::ifstream ifs(dataFilePath_);
-        if (!ifs) {
-            // Файл не существует или не открылся — возвращаем пустой список
+// Выполняет SQL без результата; при ошибке закрывает БД и бросает исключение
+void execSql(sqlite3* db, const char* sql) {
+    char* errmsg = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &errmsg) != SQLITE_OK) {
+        std::string err = errmsg ? errmsg : sqlite3_errmsg(db);
+        sqlite3_free(errmsg);
+        sqlite3_close(db);
+        throw std::runtime_error("SQLite error: " + err);
+    }
+}
+
+// Поколение SQLite-хранилища хранится в заголовке БД (PRAGMA user_version)
+std::uint64_t sqliteGeneration(sqlite3* db) {
+    sqlite3_stmt* stmt = nullptr;
+    std::uint64_t generation = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, nullptr) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW) {
+        generation = static_cast<std::uint32_t>(sqlite3_column_int(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    return generation;
+}
+
+// Граница ID SQLite-хранилища (таблица meta); без таблицы — IdAllocator::kFirstId
+TaskId sqliteNextId(sqlite3* db) {
+    sqlite3_stmt* stmt = nullptr;
+    TaskId nextId = IdAllocator::kFirstId;
+    if (sqlite3_prepare_v2(db, "SELECT value FROM meta WHERE key = 'nextId';", -1, &stmt, nullptr) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW) {
+        nextId = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return nextId;
+}
+
+// Число после ключа key в начале файла; std::nullopt, если ключа там нет
+std::optional<std::uint64_t> headerNumber(const std::string& head, const char* key) {
+    std::size_t at = head.find(key);
+    if (at == std::string::npos) {
+        return std::nullopt;
+    }
+    std::size_t value = head.find_first_of("0123456789", at);
+    std::size_t end = value == std::string::npos ? value : head.find_first_not_of("0123456789", value);
+    if (end == std::string::npos) {
+        return std::nullopt;
+    }
+    return std::strtoull(head.c_str() + value, nullptr, 10);
+}
+
+constexpr std::size_t kWriteBufferSize = 1024 * 1024; ///< Буфер записи JSON и NDJSON.
+
+std::string staleMessage(const std::string& path) {
+    return "Data file " + path + " was changed by another process";
+}
+
+} // namespace
+
+Storage::Storage(const std::string& dataFilePath, const std::string& format, bool compress)
+    : dataFilePath_(dataFilePath), format_(format),
+      compress_(compress || gzip::hasExtension(dataFilePath)) {}
+
+std::vector<Task> Storage::load(TaskArena* arena) {
+    std::unique_ptr<FileLock> guard;
+    if (!held_) {
+        guard = std::make_unique<FileLock>(lockPath(), FileLock::Mode::Shared);
+    }
+    if (format_ == "json" || format_ == "ndjson") {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(dataFilePath_, ec)) {
+            // Файл не существует — возвращаем пустой список
+            generation_ = 0;
+            nextId_ = IdAllocator::kFirstId;
+            loadFailed_ = false;
             return {};
         }
-        nlohmann::json arr;
-        ifs >> arr;
+        // Старый JSON-формат (массив без поколения), заголовок NDJSON и gzip загрузчик понимает сам
+        compress_ = compress_ || gzip::isCompressed(dataFilePath_);
         std::vector<Task> tasks;
-        for (const auto& item : arr) {
-            tasks.push_back(Task::fromJson(item));
+        Header header;
+        try {
+            tasks = TaskImporter::loadFile(dataFilePath_, format_, 0, arena);
+            header = readHeader();
+        } catch (...) {
+            // Непрочитанный файл нельзя перезаписывать: save() откажет до успешного load()
+            loadFailed_ = true;
+            throw;
         }
+        generation_ = header.generation;
+        nextId_ = header.nextId;
+        loadFailed_ = false;
         return tasks;
     } else if (format_ == "sqlite") {
         sqlite3* db = nullptr;
@@ -28,35 +110,48 @@ std::vector<Task> Storage::load() {
             throw std::runtime_error("Cannot open SQLite database: " + dataFilePath_);
         }
         std::vector<Task> tasks;
+        generation_ = sqliteGeneration(db);
+        nextId_ = sqliteNextId(db);
         const char* query = R"(
             SELECT id, description, dueDate, done, tags
             FROM tasks;
         )";
         sqlite3_stmt* stmt = nullptr;
         if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK) {
+            // Новая БД: таблицы ещё нет, её создаст первое сохранение
+            bool noTable = std::string(sqlite3_errmsg(db)).rfind("no such table", 0) == 0;
             sqlite3_close(db);
+            if (noTable) {
+                return tasks;
+            }
             throw std::runtime_error("Failed to prepare SQLite statement");
         }
+        Task::allocator_type alloc = arena ? arena->resource() : std::pmr::get_default_resource();
+        std::vector<std::string> tagsVec;
         while (sqlite3_step(stmt) == SQLITE_ROW) {
-            nlohmann::json j;
-            j["id"] = sqlite3_column_int(stmt, 0);
-            j["description"] = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-            j["done"] = sqlite3_column_int(stmt, 3) == 1;
-            if (sqlite3_column_text(stmt, 2)) {
-                j["dueDate"] = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-            }
+            TaskId id = sqlite3_column_int64(stmt, 0);
+            auto text = [&](int col) -> std::optional<std::string_view> {
+                const unsigned char* p = sqlite3_column_text(stmt, col);
+                if (!p) {
+                    return std::nullopt;
+                }
+                return std::string_view(reinterpret_cast<const char*>(p),
+                                        static_cast<std::size_t>(sqlite3_column_bytes(stmt, col)));
+            };
             // Разбор тегов из строки вида "tag1;tag2;tag3"
-            if (sqlite3_column_text(stmt, 4)) {
-                std::string tagsStr = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-                std::vector<std::string> tagsVec;
-                std::istringstream ss(tagsStr);
-                std::string tag;
-                while (std::getline(ss, tag, ';')) {
-                    if (!tag.empty()) tagsVec.push_back(tag);
+            tagsVec.clear();
+            if (auto tagsStr = text(4)) {
+                std::size_t pos = 0;
+                while (pos < tagsStr->size()) {
+                    std::size_t semi = std::min(tagsStr->find(';', pos), tagsStr->size());
+                    if (semi > pos) {
+                        tagsVec.emplace_back(tagsStr->substr(pos, semi - pos));
+                    }
+                    pos = semi + 1;
                 }
-                j["tags"] = tagsVec;
             }
-            tasks.push_back(Task::fromJson(j));
+            tasks.push_back(Task::restore(id, text(1).value_or(std::string_view()), text(2),
+                                          sqlite3_column_int(stmt, 3) == 1, tagsVec, alloc));
         }
         sqlite3_finalize(stmt);
         sqlite3_close(db);
@@ -66,22 +161,89 @@ std::vector<Task> Storage::load() {
     }
 }
 
-void Storage::save(const std::vector<Task>& tasks) {
-    if (format_ == "json") {
-        nlohmann::json arr = nlohmann::json::array();
-        for (const auto& t : tasks) {
-            arr.push_back(t.toJson());
+void Storage::save(const std::vector<Task>& tasks, TaskId nextId) {
+    saveRange(tasks, nextId);
+}
+
+void Storage::save(const PersistentVector<Task>& tasks, TaskId nextId) {
+    saveRange(tasks, nextId);
+}
+
+void Storage::saveStream(const TaskStream& tasks, TaskId nextId) {
+    saveWith(tasks, nextId);
+}
+
+TaskId Storage::nextId() const noexcept {
+    return nextId_;
+}
+
+template <typename Range>
+void Storage::saveRange(const Range& tasks, TaskId nextId) {
+    for (const auto& t : tasks) {
+        nextId = std::max(nextId, t.getId() + 1);
+    }
+    saveWith(
+        [&tasks](const auto& sink) {
+            for (const auto& t : tasks) {
+                sink(t);
+            }
+        },
+        nextId);
+}
+
+template <typename ForEach>
+void Storage::saveWith(const ForEach& forEach, TaskId nextId) {
+    std::unique_ptr<FileLock> guard;
+    if (!held_) {
+        guard = std::make_unique<FileLock>(lockPath(), FileLock::Mode::Exclusive);
+    }
+    if (format_ == "json" || format_ == "ndjson") {
+        if (loadFailed_) {
+            throw std::runtime_error("Refusing to overwrite " + dataFilePath_
+                                     + ": it could not be loaded");
+        }
+        std::uint64_t onDisk = readGeneration();
+        if (generation_ && *generation_ != onDisk) {
+            throw StaleDataError(staleMessage(dataFilePath_));
         }
-        std::ofstream ofs(dataFilePath_);
-        if (!ofs) {
-            throw std::runtime_error("Cannot open file for saving: " + dataFilePath_);
+        // Пишем во временный файл и подменяем: читатели не увидят файл наполовину
+        std::string tmpPath = dataFilePath_ + ".tmp";
+        // Потоковая запись по одной компактной задаче на строку: такой файл быстро
+        // пишется и делится на куски для параллельной загрузки
+        OutputWriter out = OutputWriter::toFile(tmpPath, kWriteBufferSize, compress_);
+        out.write("{\"generation\":").writeInt(static_cast<long long>(onDisk + 1));
+        out.write(",\"nextId\":").writeInt(nextId);
+        if (format_ == "json") {
+            out.write(",\"tasks\":[");
+            bool first = true;
+            forEach([&](const Task& t) {
+                out.write(first ? "\n" : ",\n");
+                out.writeTaskJson(t);
+                first = false;
+            });
+            out.write("\n]}\n");
+        } else {
+            out.write("}\n");
+            forEach([&](const Task& t) { out.writeTaskJson(t).put('\n'); });
         }
-        ofs << std::setw(4) << arr;
+        out.flush();
+        std::filesystem::rename(tmpPath, dataFilePath_);
+        generation_ = onDisk + 1;
+        nextId_ = nextId;
     } else if (format_ == "sqlite") {
         sqlite3* db = nullptr;
         if (sqlite3_open(dataFilePath_.c_str(), &db) != SQLITE_OK) {
             throw std::runtime_error("Cannot open SQLite database: " + dataFilePath_);
         }
+        sqlite3_busy_timeout(db, 5000);
+        // Проверка поколения и перезапись — одной транзакцией с блокировкой записи
+        execSql(db, "BEGIN IMMEDIATE;");
+        std::uint64_t onDisk = sqliteGeneration(db);
+        if (generation_ && *generation_ != onDisk) {
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            sqlite3_close(db);
+            throw StaleDataError(staleMessage(dataFilePath_));
+        }
         const char* sqlCreate = R"(
             CREATE TABLE IF NOT EXISTS tasks (
                 id INTEGER PRIMARY KEY,
@@ -91,20 +253,13 @@ void Storage::save(const std::vector<Task>& tasks) {
                 tags TEXT
             );
         )";
-        char* errmsg = nullptr;
-        if (sqlite3_exec(db, sqlCreate, nullptr, nullptr, &errmsg) != SQLITE_OK) {
-            std::string err = errmsg;
-            sqlite3_free(errmsg);
-            sqlite3_close(db);
-            throw std::runtime_error("SQLite error: " + err);
-        }
+        execSql(db, sqlCreate);
+        execSql(db, "CREATE TABLE IF NOT EXISTS meta (key TEXT PRIMARY KEY, value INTEGER NOT NULL);");
+        std::string storeNextId = "INSERT OR REPLACE INTO meta (key, value) VALUES ('nextId', "
+                                  + std::to_string(nextId) + ");";
+        execSql(db, storeNextId.c_str());
         // Очищаем таблицу для перезаписи
-        if (sqlite3_exec(db, "DELETE FROM tasks;", nullptr, nullptr, &errmsg) != SQLITE_OK) {
-            std::string err = errmsg;
-            sqlite3_free(errmsg);
-            sqlite3_close(db);
-            throw std::runtime_error("SQLite error: " + err);
-        }
+        execSql(db, "DELETE FROM tasks;");
         const char* sqlIns = R"(
             INSERT INTO tasks (id, description, dueDate, done, tags)
             VALUES (?, ?, ?, ?, ?);
@@ -114,8 +269,8 @@ void Storage::save(const std::vector<Task>& tasks) {
             sqlite3_close(db);
             throw std::runtime_error("Failed to prepare SQLite insert statement");
         }
-        for (const auto& t : tasks) {
-            sqlite3_bind_int(stmt, 1, t.getId());
+        forEach([&](const Task& t) {
+            sqlite3_bind_int64(stmt, 1, t.getId());
             sqlite3_bind_text(stmt, 2, t.getDescription().c_str(), -1, SQLITE_TRANSIENT);
             if (t.getDueDate().has_value()) {
                 sqlite3_bind_text(stmt, 3, t.getDueDate()->c_str(), -1, SQLITE_TRANSIENT);
@@ -138,10 +293,84 @@ void Storage::save(const std::vector<Task>& tasks) {
                 throw std::runtime_error("Failed to insert task into SQLite");
             }
             sqlite3_reset(stmt);
-        }
+        });
         sqlite3_finalize(stmt);
+        std::string bump = "PRAGMA user_version = "
+                           + std::to_string(static_cast<std::int32_t>(onDisk + 1)) + ";";
+        execSql(db, bump.c_str());
+        execSql(db, "COMMIT;");
         sqlite3_close(db);
+        generation_ = static_cast<std::uint32_t>(onDisk + 1);
+        nextId_ = nextId;
     } else {
         throw std::invalid_argument("Unsupported format in Storage: " + format_);
     }
 }
+
+void Storage::lock() {
+    held_ = std::make_unique<FileLock>(lockPath(), FileLock::Mode::Exclusive);
+}
+
+void Storage::unlock() noexcept {
+    held_.reset();
+}
+
+bool Storage::locked() const noexcept {
+    return held_ != nullptr;
+}
+
+bool Storage::changedOnDisk() {
+    std::unique_ptr<FileLock> guard;
+    if (!held_) {
+        guard = std::make_unique<FileLock>(lockPath(), FileLock::Mode::Shared);
+    }
+    return !generation_ || *generation_ != readGeneration();
+}
+
+std::uint64_t Storage::readGeneration() {
+    if (format_ == "sqlite") {
+        sqlite3* db = nullptr;
+        if (sqlite3_open_v2(dataFilePath_.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+            sqlite3_close(db);
+            return 0;
+        }
+        std::uint64_t generation = sqliteGeneration(db);
+        sqlite3_close(db);
+        return generation;
+    }
+    return readHeader().generation;
+}
+
+Storage::Header Storage::readHeader() {
+    // save() пишет заголовок первыми ключами — обычно хватает начала файла
+    Header header;
+    std::string head = gzip::readHead(dataFilePath_, 256);
+    std::size_t first = head.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos || head[first] == '[') {
+        return header;
+    }
+    if (auto generation = headerNumber(head, "\"generation\"")) {
+        header.generation = *generation;
+        if (auto nextId = headerNumber(head, "\"nextId\"")) {
+            header.nextId = static_cast<TaskId>(*nextId);
+        }
+        return header;
+    }
+    nlohmann::json doc;
+    if (gzip::isCompressed(dataFilePath_)) {
+        gzip::ReadBuf buf(dataFilePath_);
+        std::istream in(&buf);
+        in.exceptions(std::ios::badbit);
+        in >> doc;
+    } else {
+        std::ifstream ifs(dataFilePath_, std::ios::binary);
+        ifs >> doc;
+    }
+    header.generation = doc.value("generation", std::uint64_t{0});
+    header.nextId = doc.value("nextId", IdAllocator::kFirstId);
+    return header;
+}
+
+std::string Storage::lockPath() const {
+    return dataFilePath_ + ".lock";
+}
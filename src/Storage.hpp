@@ -1,36 +1,161 @@
 #pragma once
 
+#include "FileLock.hpp"
+#include "PersistentVector.hpp"
 #include "Task.hpp"
+#include "TaskArena.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 /**
- * @brief Класс для загрузки и сохранения списка задач (JSON или SQLite).
+ * @brief Файл данных изменил другой процесс после load(): сохранение отклонено.
+ *
+ * Вызывающий должен перечитать данные, повторить операцию и сохранить снова.
+ */
+class StaleDataError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Класс для загрузки и сохранения списка задач (JSON, NDJSON или SQLite).
+ *
+ * NDJSON: первая строка — заголовок {"generation": N}, дальше по одной компактной
+ * задаче на строку (как export --format ndjson). Файл пишется потоково, а читать его
+ * можно кусками по границам строк.
+ *
+ * Несколько процессов могут работать с одним файлом: load() читает под общей
+ * блокировкой <файл>.lock, save() пишет под исключительной. В файле хранится
+ * номер поколения (JSON: {"generation": N, "tasks": [...]}, NDJSON: строка-заголовок,
+ * SQLite: PRAGMA user_version); save() увеличивает его и отказывается перезаписывать
+ * файл, если поколение изменилось с момента последнего load() (оптимистичная конкуренция).
+ * Старый JSON-формат — массив задач — читается как поколение 0.
+ *
+ * Рядом с поколением хранится граница ID — следующий ID генератора хранилища
+ * (JSON/NDJSON: ключ "nextId" заголовка, SQLite: таблица meta). По ней ID удалённых
+ * задач не выдаются повторно. В файлах без неё граница — наибольший ID плюс один.
  */
 class Storage {
 public:
     /**
      * @brief Конструктор.
+     *
+     * JSON и NDJSON сохраняются сжатыми в gzip, если задан compress, путь оканчивается
+     * на .gz или загруженный файл уже был сжат (сжатие «прилипает» к файлу). load()
+     * распознаёт сжатый файл по сигнатуре, а не по расширению. SQLite не сжимается.
      * @param dataFilePath Путь к файлу хранения (например, tasks.json или tasks.db).
-     * @param format       \"json\" или \"sqlite\".
+     * @param format       \"json\", \"ndjson\" или \"sqlite\".
+     * @param compress     Сжимать файл при сохранении.
      */
-    Storage(const std::string& dataFilePath, const std::string& format);
+    Storage(const std::string& dataFilePath, const std::string& format, bool compress = false);
 
     /**
-     * @brief Загружает все задачи из файла.
+     * @brief Загружает все задачи из файла и запоминает его поколение и границу ID (nextId()).
+     * @param arena Арена для строк задач (nullptr — ресурс по умолчанию); должна пережить задачи.
      * @return Вектор считанных задач (пустой, если файл отсутствует).
      * @throws std::runtime_error При ошибках доступа к файлу или БД.
      */
-    std::vector<Task> load();
+    std::vector<Task> load(TaskArena* arena = nullptr);
 
     /**
      * @brief Сохраняет список задач в файл (перезаписывает).
-     * @param tasks Вектор задач для сохранения.
+     *
+     * Если load() не вызывался, файл перезаписывается без проверки поколения.
+     * @param tasks  Вектор задач для сохранения.
+     * @param nextId Граница ID (IdAllocator::next()); в файл попадает не меньше наибольшего ID + 1.
+     * @throws StaleDataError Если файл изменили после load().
+     * @throws std::runtime_error При ошибках записи или если последний load() не смог разобрать файл.
+     */
+    void save(const std::vector<Task>& tasks, TaskId nextId = IdAllocator::kFirstId);
+
+    /**
+     * @brief Сохраняет снимок задач (TaskManager::snapshot()) без копирования в вектор.
+     * @param tasks  Снимок задач для сохранения.
+     * @param nextId Граница ID (IdAllocator::next()).
+     * @throws StaleDataError Если файл изменили после load().
      * @throws std::runtime_error При ошибках записи.
      */
-    void save(const std::vector<Task>& tasks);
+    void save(const PersistentVector<Task>& tasks, TaskId nextId = IdAllocator::kFirstId);
+
+    /**
+     * @brief Источник задач для saveStream(): передаёт задачи по порядку в sink.
+     */
+    using TaskStream = std::function<void(const std::function<void(const Task&)>& sink)>;
+
+    /**
+     * @brief Сохраняет задачи из источника за один проход, не собирая их в список.
+     *
+     * Задача нужна только на время вызова sink, поэтому источник может строить задачи
+     * на ходу (DatasetGenerator). Граница ID по задачам не уточняется: её задаёт вызывающий.
+     * @param tasks  Источник задач.
+     * @param nextId Граница ID: больше любого ID из источника.
+     * @throws StaleDataError Если файл изменили после load().
+     * @throws std::runtime_error При ошибках записи.
+     */
+    void saveStream(const TaskStream& tasks, TaskId nextId);
+
+    /**
+     * @brief Граница ID, прочитанная последним load() или записанная последним save()
+     *        (IdAllocator::kFirstId, если в файле её нет).
+     */
+    TaskId nextId() const noexcept;
+
+    /**
+     * @brief Захватывает исключительную блокировку на весь цикл load/save.
+     *
+     * Пока она держится, load() и save() не берут свои блокировки, а другие
+     * процессы ждут. Вместе с unlock() позволяет использовать std::lock_guard<Storage>.
+     * @throws std::runtime_error Если захват не удался.
+     */
+    void lock();
+
+    /**
+     * @brief Снимает блокировку, захваченную lock().
+     */
+    void unlock() noexcept;
+
+    /**
+     * @brief Держится ли блокировка, захваченная lock().
+     */
+    bool locked() const noexcept;
+
+    /**
+     * @brief Изменил ли другой процесс файл после последнего load() или save().
+     */
+    bool changedOnDisk();
 
 private:
+    /**
+     * @brief Заголовок файла JSON/NDJSON.
+     */
+    struct Header {
+        std::uint64_t generation = 0;
+        TaskId nextId = IdAllocator::kFirstId;
+    };
+
+    template <typename Range>
+    void saveRange(const Range& tasks, TaskId nextId);
+
+    /**
+     * @brief Запись файла: forEach(sink) передаёт задачи в sink за один проход.
+     */
+    template <typename ForEach>
+    void saveWith(const ForEach& forEach, TaskId nextId);
+
+    std::uint64_t readGeneration();
+    Header readHeader();
+    std::string lockPath() const;
+
     std::string dataFilePath_; ///< Путь к файлу хранения.
-    std::string format_;       ///< Формат хранения: \"json\" или \"sqlite\".
+    std::string format_;       ///< Формат хранения: \"json\", \"ndjson\" или \"sqlite\".
+    bool compress_;            ///< Сохранять JSON/NDJSON в gzip.
+    std::optional<std::uint64_t> generation_; ///< Поколение файла при последнем load()/save().
+    TaskId nextId_ = IdAllocator::kFirstId;   ///< Граница ID при последнем load()/save().
+    std::unique_ptr<FileLock> held_;          ///< Блокировка, захваченная lock().
+    bool loadFailed_ = false;                 ///< Последний load() не разобрал файл: save() запрещён.
 };
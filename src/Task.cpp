@@ -1,23 +1,58 @@
 #include "Task.hpp"
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
 
-int Task::nextId_ = 1;
+Task::Task(TaskId id, const std::string& description, const std::vector<std::string>& tags,
+           const allocator_type& alloc)
+    : id_(id), description_(description, alloc), tags_(tags.begin(), tags.end(), alloc) {}
 
-Task::Task(const std::string& description, const std::vector<std::string>& tags)
-    : id_(nextId_++), description_(description), tags_(tags) {}
+Task::Task(TaskId id, const std::string& description, const std::string& dueDate,
+           const std::vector<std::string>& tags, const allocator_type& alloc)
+    : id_(id), description_(description, alloc), dueDate_(std::in_place, dueDate, alloc),
+      tags_(tags.begin(), tags.end(), alloc) {}
 
-Task::Task(const std::string& description, const std::string& dueDate, const std::vector<std::string>& tags)
-    : id_(nextId_++), description_(description), dueDate_(dueDate), tags_(tags) {}
+Task::Task(TaskId id, std::in_place_t, String&& description, std::optional<String>&& dueDate,
+           TagList&& tags)
+    : id_(id), description_(std::move(description)),
+      tags_(std::move(tags), description_.get_allocator()) {
+    if (dueDate) {
+        dueDate_.emplace(std::move(*dueDate), description_.get_allocator());
+    }
+}
+
+Task::Task(TaskId id, std::string_view description, const allocator_type& alloc)
+    : id_(id), description_(description, alloc), tags_(alloc) {}
+
+Task::Task(const Task& other, const allocator_type& alloc)
+    : id_(other.id_), description_(other.description_, alloc), done_(other.done_),
+      tags_(other.tags_, alloc) {
+    if (other.dueDate_) {
+        dueDate_.emplace(*other.dueDate_, alloc);
+    }
+}
+
+Task::Task(Task&& other, const allocator_type& alloc)
+    : id_(other.id_), description_(std::move(other.description_), alloc), done_(other.done_),
+      tags_(std::move(other.tags_), alloc) {
+    if (other.dueDate_) {
+        dueDate_.emplace(std::move(*other.dueDate_), alloc);
+    }
+}
 
-int Task::getId() const noexcept {
+Task::allocator_type Task::get_allocator() const noexcept {
+    return description_.get_allocator();
+}
+
+TaskId Task::getId() const noexcept {
     return id_;
 }
 
-const std::string& Task::getDescription() const noexcept {
+const Task::String& Task::getDescription() const noexcept {
     return description_;
 }
 
-const std::optional<std::string>& Task::getDueDate() const noexcept {
+const std::optional<Task::String>& Task::getDueDate() const noexcept {
     return dueDate_;
 }
 
@@ -25,57 +60,75 @@ bool Task::isDone() const noexcept {
     return done_;
 }
 
-const std::vector<std::string>& Task::getTags() const noexcept {
+const Task::TagList& Task::getTags() const noexcept {
     return tags_;
 }
 
-void Task::setDescription(const std::string& desc) {
-    description_ = desc;
+void Task::setDescription(std::string_view desc) {
+    description_.assign(desc.data(), desc.size());
 }
 
-void Task::setDueDate(const std::string& dueDate) {
-    dueDate_ = dueDate;
+void Task::setDueDate(std::string_view dueDate) {
+    if (dueDate_) {
+        dueDate_->assign(dueDate.data(), dueDate.size());
+    } else {
+        dueDate_.emplace(dueDate, description_.get_allocator());
+    }
 }
 
 void Task::markDone() {
     done_ = true;
 }
 
-void Task::addTag(const std::string& tag) {
-    tags_.push_back(tag);
+void Task::addTag(std::string_view tag) {
+    tags_.emplace_back(tag);
 }
 
-void Task::removeTag(const std::string& tag) {
+void Task::removeTag(std::string_view tag) {
     tags_.erase(std::remove(tags_.begin(), tags_.end(), tag), tags_.end());
 }
 
 nlohmann::json Task::toJson() const {
     nlohmann::json j;
     j["id"] = id_;
-    j["description"] = description_;
+    j["description"] = std::string_view(description_);
     j["done"] = done_;
     if (dueDate_) {
-        j["dueDate"] = *dueDate_;
+        j["dueDate"] = std::string_view(*dueDate_);
     }
     if (!tags_.empty()) {
-        j["tags"] = tags_;
+        auto& tags = j["tags"] = nlohmann::json::array();
+        for (const auto& tag : tags_) {
+            tags.push_back(std::string_view(tag));
+        }
     }
     return j;
 }
 
 Task Task::fromJson(const nlohmann::json& j) {
-    Task t(j.at("description").get<std::string>());
-    t.id_ = j.at("id").get<int>();
+    Task t(j.at("id").get<TaskId>(), j.at("description").get<std::string>());
     t.done_ = j.at("done").get<bool>();
     if (j.contains("dueDate")) {
-        t.dueDate_ = j.at("dueDate").get<std::string>();
+        t.setDueDate(j.at("dueDate").get<std::string>());
     }
     if (j.contains("tags")) {
-        t.tags_ = j.at("tags").get<std::vector<std::string>>();
+        for (const auto& tag : j.at("tags")) {
+            t.tags_.emplace_back(tag.get<std::string>());
+        }
+    }
+    return t;
+}
+
+Task Task::restore(TaskId id, std::string_view description, std::optional<std::string_view> dueDate,
+                   bool done, const std::vector<std::string>& tags, const allocator_type& alloc) {
+    Task t(id, description, alloc);
+    if (dueDate) {
+        t.dueDate_.emplace(*dueDate, alloc);
     }
-    // Убедимся, что nextId_ > всех прочитанных id
-    if (t.id_ >= Task::nextId_) {
-        Task::nextId_ = t.id_ + 1;
+    t.done_ = done;
+    t.tags_.reserve(tags.size());
+    for (const auto& tag : tags) {
+        t.tags_.emplace_back(tag);
     }
     return t;
 }
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "IdAllocator.hpp"
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <optional>
 #if __has_include(<nlohmann/json.hpp>)
@@ -12,44 +16,93 @@
 
 /**
  * @brief Класс, описывающий одну задачу.
+ *
+ * Описание, дата и теги лежат в std::pmr-строках: задача, собранная с распределителем
+ * (restore() или копирование с распределителем), размещает их в его ресурсе — например,
+ * в арене TaskArena при загрузке. Перемещение сохраняет ресурс, обычное копирование
+ * размещает копию в ресурсе по умолчанию (куче). Изменения задачи выделяют память
+ * в ресурсе её описания.
+ *
+ * ID задаче назначает вызывающий: новые берутся из IdAllocator хранилища
+ * (TaskManager::ids()), загруженные приходят из файла.
  */
 class Task {
 public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>; ///< Распределитель строк задачи.
+    using String = std::pmr::string;                             ///< Строка задачи.
+    using TagList = std::pmr::vector<String>;                    ///< Список тегов.
+
     /**
      * @brief Создаёт задачу без дедлайна.
+     * @param id Идентификатор задачи.
      * @param description Описание задачи.
      * @param tags Список тегов (по умолчанию пустой).
+     * @param alloc Распределитель для строк задачи.
      */
-    Task(const std::string& description,
-         const std::vector<std::string>& tags = {});
+    Task(TaskId id,
+         const std::string& description,
+         const std::vector<std::string>& tags = {},
+         const allocator_type& alloc = {});
 
     /**
      * @brief Создаёт задачу с дедлайном.
+     * @param id Идентификатор задачи.
      * @param description Описание задачи.
      * @param dueDate Дата завершения в формате YYYY-MM-DD.
      * @param tags Список тегов (по умолчанию пустой).
+     * @param alloc Распределитель для строк задачи.
      */
-    Task(const std::string& description,
+    Task(TaskId id,
+         const std::string& description,
          const std::string& dueDate,
-         const std::vector<std::string>& tags = {});
+         const std::vector<std::string>& tags = {},
+         const allocator_type& alloc = {});
+
+    /**
+     * @brief Создаёт задачу из готовых строк, забирая их без копирования.
+     *
+     * Задача использует распределитель описания; дата и теги того же ресурса
+     * перемещаются, другого — копируются в него. Метка std::in_place отличает этот
+     * конструктор от копирующих строки при вызове с литералами.
+     * @param id Идентификатор задачи.
+     * @param description Описание задачи.
+     * @param dueDate Дата завершения YYYY-MM-DD или std::nullopt.
+     * @param tags Список тегов.
+     */
+    Task(TaskId id, std::in_place_t, String&& description, std::optional<String>&& dueDate, TagList&& tags);
+
+    /**
+     * @brief Копирует задачу в ресурс распределителя alloc.
+     */
+    Task(const Task& other, const allocator_type& alloc);
+
+    /**
+     * @brief Перемещает задачу в ресурс alloc (при том же ресурсе — без копирования строк).
+     */
+    Task(Task&& other, const allocator_type& alloc);
+
+    /**
+     * @brief Распределитель, в ресурсе которого лежат строки задачи.
+     */
+    allocator_type get_allocator() const noexcept;
 
     /**
      * @brief Возвращает уникальный идентификатор задачи.
      * @return Целочисленный ID.
      */
-    int getId() const noexcept;
+    TaskId getId() const noexcept;
 
     /**
      * @brief Возвращает описание задачи.
      * @return Константная ссылка на строку с описанием.
      */
-    const std::string& getDescription() const noexcept;
+    const String& getDescription() const noexcept;
 
     /**
      * @brief Возвращает дедлайн задачи (если установлен).
      * @return optional со строкой YYYY-MM-DD или std::nullopt.
      */
-    const std::optional<std::string>& getDueDate() const noexcept;
+    const std::optional<String>& getDueDate() const noexcept;
 
     /**
      * @brief Проверяет, выполнена ли задача.
@@ -61,19 +114,19 @@ public:
      * @brief Возвращает список тегов задачи.
      * @return Вектор строк-тегов.
      */
-    const std::vector<std::string>& getTags() const noexcept;
+    const TagList& getTags() const noexcept;
 
     /**
      * @brief Изменяет текст описания задачи.
      * @param desc Новое описание.
      */
-    void setDescription(const std::string& desc);
+    void setDescription(std::string_view desc);
 
     /**
      * @brief Устанавливает или изменяет дедлайн задачи.
      * @param dueDate Новая дата дедлайна (YYYY-MM-DD).
      */
-    void setDueDate(const std::string& dueDate);
+    void setDueDate(std::string_view dueDate);
 
     /**
      * @brief Помечает задачу как выполненную.
@@ -84,13 +137,13 @@ public:
      * @brief Добавляет тег к задаче, если он ещё не добавлен.
      * @param tag Метка для добавления.
      */
-    void addTag(const std::string& tag);
+    void addTag(std::string_view tag);
 
     /**
      * @brief Удаляет тег из задачи, если он присутствует.
      * @param tag Метка для удаления.
      */
-    void removeTag(const std::string& tag);
+    void removeTag(std::string_view tag);
 
     /**
      * @brief Сериализует задачу в JSON-объект.
@@ -99,19 +152,36 @@ public:
     nlohmann::json toJson() const;
 
     /**
-     * @brief Создаёт объект Task из JSON-объекта.
+     * @brief Создаёт объект Task из JSON-объекта (с его ID; генератор не трогает).
      * @param j JSON-объект с теми же полями, что были в toJson().
      * @return Восстановленный объект Task.
      * @throws std::out_of_range Если в JSON отсутствуют обязательные поля id, description или done.
      */
     static Task fromJson(const nlohmann::json& j);
 
+    /**
+     * @brief Собирает задачу с уже известным ID (импорт, загрузка без JSON-объекта).
+     *
+     * Безопасна в нескольких потоках. О занятых ID вызывающий один раз сообщает
+     * генератору хранилища (IdAllocator::observe() с наибольшим ID).
+     * @param id          Идентификатор задачи.
+     * @param description Описание.
+     * @param dueDate     Дата дедлайна (YYYY-MM-DD) или std::nullopt.
+     * @param done        Выполнена ли задача.
+     * @param tags        Список тегов.
+     * @param alloc       Распределитель для строк задачи (по умолчанию — ресурс по умолчанию).
+     * @return Собранная задача.
+     */
+    static Task restore(TaskId id, std::string_view description,
+                        std::optional<std::string_view> dueDate, bool done,
+                        const std::vector<std::string>& tags, const allocator_type& alloc = {});
+
 private:
-    int id_;                             ///< Уникальный идентификатор задачи.
-    std::string description_;            ///< Описание задачи.
-    std::optional<std::string> dueDate_; ///< Дата дедлайна (формат YYYY-MM-DD).
-    bool done_ = false;                  ///< Статус выполнения.
-    std::vector<std::string> tags_;      ///< Список меток (тегов).
+    Task(TaskId id, std::string_view description, const allocator_type& alloc);
 
-    static int nextId_;                  ///< Генератор уникальных ID.
+    TaskId id_;                     ///< Уникальный идентификатор задачи.
+    String description_;            ///< Описание задачи.
+    std::optional<String> dueDate_; ///< Дата дедлайна (формат YYYY-MM-DD).
+    bool done_ = false;             ///< Статус выполнения.
+    TagList tags_;                  ///< Список меток (тегов).
 };
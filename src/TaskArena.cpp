@@ -0,0 +1,9 @@
+#include "TaskArena.hpp"
+
+TaskArena::TaskArena(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+std::pmr::memory_resource* TaskArena::resource() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Блоки растут геометрически от kInitialBlock
+    return &resources_.emplace_back(kInitialBlock, upstream_);
+}
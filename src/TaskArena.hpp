@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory_resource>
+#include <mutex>
+
+/**
+ * @brief Арена для строк и тегов задач: набор монотонных ресурсов std::pmr.
+ *
+ * Память арены не освобождается по одной строке: деструкторы задач ничего не делают,
+ * а всё выделенное возвращается одним release() в деструкторе арены. Поэтому загрузка
+ * миллиона задач — это несколько крупных выделений вместо миллионов мелких, а выход
+ * из процесса не проходит по куче строка за строкой.
+ *
+ * Подходит для короткоживущих процессов (одна команда CLI): память изменённых и удалённых
+ * задач возвращается только вместе с ареной. Долгоживущий демон арену не использует.
+ *
+ * Арена должна жить дольше всех задач, размещённых в ней (и снимков, где они лежат).
+ */
+class TaskArena {
+public:
+    static constexpr std::size_t kInitialBlock = 64 * 1024; ///< Первый блок каждого ресурса.
+
+    /**
+     * @param upstream Откуда ресурсы арены берут блоки (по умолчанию — ресурс по умолчанию
+     *                 на момент создания арены).
+     */
+    explicit TaskArena(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    TaskArena(const TaskArena&) = delete;
+    TaskArena& operator=(const TaskArena&) = delete;
+
+    /**
+     * @brief Создаёт новый монотонный ресурс, живущий до конца арены.
+     *
+     * Сам ресурс не потокобезопасен: каждый поток загрузки берёт свой.
+     * Вызов resource() из нескольких потоков безопасен.
+     */
+    std::pmr::memory_resource* resource();
+
+private:
+    std::pmr::memory_resource* upstream_;
+    std::mutex mutex_;
+    std::deque<std::pmr::monotonic_buffer_resource> resources_; ///< deque не перемещает элементы.
+};
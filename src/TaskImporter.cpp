@@ -0,0 +1,1078 @@
+#include "TaskImporter.hpp"
+#include "Compression.hpp"
+#include "Csv.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <utility>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::size_t kBytesPerTaskEstimate = 64; ///< Для резервирования по размеру файла.
+
+// Поля задачи, собранные из одной записи. Буферы строк переиспользуются от записи
+// к записи, а в задачу копируются в её ресурс, поэтому на запись нет выделений в куче
+struct TaskFields {
+    std::optional<long long> id;
+    std::string description;
+    bool hasDescription = false;
+    std::string dueDate;
+    bool hasDueDate = false;
+    bool done = false;
+    std::vector<std::string> tags;
+    bool generation = false; ///< Встретился ключ "generation" (заголовок хранилища NDJSON).
+
+    void clear() {
+        id.reset();
+        description.clear();
+        hasDescription = false;
+        dueDate.clear();
+        hasDueDate = false;
+        done = false;
+        tags.clear();
+        generation = false;
+    }
+};
+
+// "CSV import, line 12"; строка 0 — номер неизвестен
+std::string location(const char* source, std::size_t line) {
+    std::string where = std::string(source) + " import";
+    if (line > 0) {
+        where += ", line " + std::to_string(line);
+    }
+    return where;
+}
+
+// fresh == nullptr — задача сохраняет ID из файла, иначе получает новый из блока
+Task makeTask(const TaskFields& f, IdAllocator::Block* fresh, const char* source, std::size_t line,
+              const Task::allocator_type& alloc) {
+    if (!f.hasDescription) {
+        throw std::runtime_error(location(source, line) + ": missing description");
+    }
+    TaskId id = 0;
+    if (!fresh) {
+        if (!f.id || *f.id <= 0) {
+            throw std::runtime_error(location(source, line) + ": missing or invalid id");
+        }
+        id = *f.id;
+    } else {
+        id = fresh->take();
+    }
+    return Task::restore(id, f.description,
+                         f.hasDueDate ? std::optional<std::string_view>(f.dueDate) : std::nullopt,
+                         f.done, f.tags, alloc);
+}
+
+// SAX-обработчик: собирает поля задач, не строя дерево JSON
+class TaskSax final : public nlohmann::json_sax<nlohmann::json> {
+public:
+    TaskSax(std::vector<Task>& out, IdAllocator::Block* fresh, const char* source, bool topLevelTask,
+            const Task::allocator_type& alloc)
+        : out_(out), fresh_(fresh), source_(source), topLevelTask_(topLevelTask), alloc_(alloc) {}
+
+    void setLine(std::size_t line) noexcept { line_ = line; }
+
+    bool null() override { return true; }
+
+    bool boolean(bool val) override {
+        if (atTaskLevel() && field_ == Field::Done) {
+            fields_.done = val;
+        }
+        return true;
+    }
+
+    bool number_integer(number_integer_t val) override {
+        return integer(static_cast<long long>(val));
+    }
+
+    bool number_unsigned(number_unsigned_t val) override {
+        return integer(val > static_cast<number_unsigned_t>(std::numeric_limits<long long>::max())
+                           ? -1
+                           : static_cast<long long>(val));
+    }
+
+    bool number_float(number_float_t, const string_t&) override { return true; }
+
+    bool string(string_t& val) override {
+        if (atTaskLevel()) {
+            if (field_ == Field::Description) {
+                fields_.description.assign(val);
+                fields_.hasDescription = true;
+            } else if (field_ == Field::DueDate) {
+                fields_.dueDate.assign(val);
+                fields_.hasDueDate = true;
+            }
+        } else if (inTags()) {
+            fields_.tags.push_back(val);
+        }
+        return true;
+    }
+
+    bool binary(binary_t&) override { return true; }
+
+    bool start_object(std::size_t) override {
+        bool parentIsArray = !stack_.empty() && stack_.back() == Kind::Array;
+        stack_.push_back(Kind::Object);
+        if (taskDepth_ == 0 && (parentIsArray || (stack_.size() == 1 && topLevelTask_))) {
+            taskDepth_ = stack_.size();
+            fields_.clear();
+            field_ = Field::Other;
+        }
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        if (atTaskLevel()) {
+            field_ = val == "id"            ? Field::Id
+                     : val == "description" ? Field::Description
+                     : val == "dueDate"     ? Field::DueDate
+                     : val == "done"        ? Field::Done
+                     : val == "tags"        ? Field::Tags
+                                            : Field::Other;
+            if (val == "generation") {
+                fields_.generation = true;
+            }
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (stack_.size() == taskDepth_) {
+            // Заголовок {"generation": N} — не задача
+            if (!fields_.generation || fields_.hasDescription) {
+                out_.push_back(makeTask(fields_, fresh_, source_, line_, alloc_));
+            }
+            taskDepth_ = 0;
+        }
+        stack_.pop_back();
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        stack_.push_back(Kind::Array);
+        return true;
+    }
+
+    bool end_array() override {
+        stack_.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&,
+                     const nlohmann::detail::exception& ex) override {
+        throw std::runtime_error(location(source_, line_) + ": parse error at byte " + std::to_string(position)
+                                 + ": " + ex.what());
+    }
+
+private:
+    enum class Kind { Object, Array };
+    enum class Field { Id, Description, DueDate, Done, Tags, Other };
+
+    bool atTaskLevel() const noexcept { return taskDepth_ != 0 && stack_.size() == taskDepth_; }
+
+    bool inTags() const noexcept {
+        return taskDepth_ != 0 && stack_.size() == taskDepth_ + 1 && field_ == Field::Tags
+               && stack_.back() == Kind::Array;
+    }
+
+    bool integer(long long val) {
+        if (atTaskLevel()) {
+            if (field_ == Field::Id) {
+                fields_.id = val;
+            } else if (field_ == Field::Done) {
+                fields_.done = val != 0;
+            }
+        }
+        return true;
+    }
+
+    std::vector<Task>& out_;
+    IdAllocator::Block* fresh_; ///< Источник новых ID (nullptr — ID из файла).
+    const char* source_;        ///< Имя формата для сообщений об ошибках.
+    bool topLevelTask_;         ///< Объект верхнего уровня — задача (ndjson).
+    Task::allocator_type alloc_; ///< Ресурс для строк собранных задач.
+    std::size_t line_ = 0;      ///< Текущая строка файла (0 — неизвестна).
+    std::vector<Kind> stack_;
+    std::size_t taskDepth_ = 0; ///< Глубина открытого объекта задачи (0 — вне задачи).
+    Field field_ = Field::Other;
+    TaskFields fields_;
+};
+
+// Разборщик записей JSON поверх TaskSax. Один объект разбирает все записи куска:
+// в отличие от sax_parse на каждую запись, он не создаёт заново лексер и стеки,
+// а строки собирает в одном переиспользуемом буфере
+class RecordReader {
+public:
+    RecordReader(TaskSax& sax, const char* source) : sax_(sax), source_(source) {}
+
+    // Разбирает ровно одно значение JSON (пробелы вокруг допустимы); line — его строка в файле
+    void parse(std::string_view text, std::size_t line) {
+        text_ = text;
+        pos_ = 0;
+        line_ = line;
+        sax_.setLine(line);
+        skipWs();
+        value(0);
+        skipWs();
+        if (pos_ != text_.size()) {
+            fail("unexpected characters after the value");
+        }
+    }
+
+private:
+    static constexpr std::size_t kMaxDepth = 512; ///< Глубже — ошибка, а не переполнение стека.
+
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(location(source_, line_) + ": parse error at byte "
+                                 + std::to_string(pos_ + 1) + ": " + what);
+    }
+
+    bool at(char c) const noexcept { return pos_ < text_.size() && text_[pos_] == c; }
+
+    bool digit() const noexcept {
+        return pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9';
+    }
+
+    void skipWs() noexcept {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t'
+                                       || text_[pos_] == '\r' || text_[pos_] == '\n')) {
+            ++pos_;
+        }
+    }
+
+    void value(std::size_t depth) {
+        if (pos_ >= text_.size()) {
+            fail("unexpected end of input");
+        }
+        switch (text_[pos_]) {
+        case '{':
+            object(depth);
+            break;
+        case '[':
+            array(depth);
+            break;
+        case '"':
+            string();
+            sax_.string(buf_);
+            break;
+        case 't':
+            literal("true");
+            sax_.boolean(true);
+            break;
+        case 'f':
+            literal("false");
+            sax_.boolean(false);
+            break;
+        case 'n':
+            literal("null");
+            sax_.null();
+            break;
+        default:
+            number();
+        }
+    }
+
+    void object(std::size_t depth) {
+        if (depth >= kMaxDepth) {
+            fail("nesting too deep");
+        }
+        ++pos_;
+        sax_.start_object(static_cast<std::size_t>(-1));
+        skipWs();
+        if (at('}')) {
+            ++pos_;
+            sax_.end_object();
+            return;
+        }
+        for (;;) {
+            if (!at('"')) {
+                fail("expected a key");
+            }
+            string();
+            sax_.key(buf_);
+            skipWs();
+            if (!at(':')) {
+                fail("expected ':'");
+            }
+            ++pos_;
+            skipWs();
+            value(depth + 1);
+            skipWs();
+            if (at(',')) {
+                ++pos_;
+                skipWs();
+            } else if (at('}')) {
+                ++pos_;
+                sax_.end_object();
+                return;
+            } else {
+                fail("expected ',' or '}'");
+            }
+        }
+    }
+
+    void array(std::size_t depth) {
+        if (depth >= kMaxDepth) {
+            fail("nesting too deep");
+        }
+        ++pos_;
+        sax_.start_array(static_cast<std::size_t>(-1));
+        skipWs();
+        if (at(']')) {
+            ++pos_;
+            sax_.end_array();
+            return;
+        }
+        for (;;) {
+            value(depth + 1);
+            skipWs();
+            if (at(',')) {
+                ++pos_;
+                skipWs();
+            } else if (at(']')) {
+                ++pos_;
+                sax_.end_array();
+                return;
+            } else {
+                fail("expected ',' or ']'");
+            }
+        }
+    }
+
+    void literal(std::string_view word) {
+        if (text_.compare(pos_, word.size(), word) != 0) {
+            fail("invalid literal");
+        }
+        pos_ += word.size();
+    }
+
+    void number() {
+        std::size_t start = pos_;
+        if (at('-')) {
+            ++pos_;
+        }
+        if (!digit()) {
+            fail("invalid value");
+        }
+        if (at('0')) {
+            ++pos_;
+        } else {
+            while (digit()) ++pos_;
+        }
+        bool integral = true;
+        if (at('.')) {
+            ++pos_;
+            if (!digit()) {
+                fail("invalid number");
+            }
+            while (digit()) ++pos_;
+            integral = false;
+        }
+        if (at('e') || at('E')) {
+            ++pos_;
+            if (at('+') || at('-')) {
+                ++pos_;
+            }
+            if (!digit()) {
+                fail("invalid number");
+            }
+            while (digit()) ++pos_;
+            integral = false;
+        }
+        const char* first = text_.data() + start;
+        const char* last = text_.data() + pos_;
+        if (integral) {
+            long long v = 0;
+            if (std::from_chars(first, last, v).ec == std::errc()) {
+                sax_.number_integer(v);
+                return;
+            }
+            unsigned long long u = 0;
+            if (*first != '-' && std::from_chars(first, last, u).ec == std::errc()) {
+                sax_.number_unsigned(u);
+                return;
+            }
+        }
+        buf_.assign(first, last);
+        sax_.number_float(std::strtod(buf_.c_str(), nullptr), buf_);
+    }
+
+    // Строка с позиции открывающей кавычки — в buf_ (экранирование раскрыто)
+    void string() {
+        ++pos_;
+        buf_.clear();
+        for (;;) {
+            // Обычные символы копируются отрезками
+            std::size_t run = pos_;
+            while (pos_ < text_.size()) {
+                auto c = static_cast<unsigned char>(text_[pos_]);
+                if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80) {
+                    break;
+                }
+                ++pos_;
+            }
+            buf_.append(text_.data() + run, pos_ - run);
+            if (pos_ >= text_.size()) {
+                fail("unterminated string");
+            }
+            auto c = static_cast<unsigned char>(text_[pos_]);
+            if (c == '"') {
+                ++pos_;
+                return;
+            }
+            if (c == '\\') {
+                escape();
+            } else if (c < 0x20) {
+                fail("control character in string");
+            } else {
+                utf8();
+            }
+        }
+    }
+
+    void escape() {
+        if (pos_ + 1 >= text_.size()) {
+            fail("unterminated string");
+        }
+        char e = text_[pos_ + 1];
+        pos_ += 2;
+        switch (e) {
+        case '"': buf_ += '"'; break;
+        case '\\': buf_ += '\\'; break;
+        case '/': buf_ += '/'; break;
+        case 'b': buf_ += '\b'; break;
+        case 'f': buf_ += '\f'; break;
+        case 'n': buf_ += '\n'; break;
+        case 'r': buf_ += '\r'; break;
+        case 't': buf_ += '\t'; break;
+        case 'u': {
+            unsigned cp = hex4();
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                // Суррогатная пара: за старшей половиной обязана идти младшая
+                if (text_.compare(pos_, 2, "\\u") != 0) {
+                    fail("unpaired surrogate");
+                }
+                pos_ += 2;
+                unsigned low = hex4();
+                if (low < 0xDC00 || low > 0xDFFF) {
+                    fail("unpaired surrogate");
+                }
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                fail("unpaired surrogate");
+            }
+            appendUtf8(cp);
+            break;
+        }
+        default:
+            fail("invalid escape");
+        }
+    }
+
+    unsigned hex4() {
+        if (pos_ + 4 > text_.size()) {
+            fail("invalid \\u escape");
+        }
+        unsigned cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            char h = text_[pos_++];
+            cp <<= 4;
+            if (h >= '0' && h <= '9') {
+                cp |= static_cast<unsigned>(h - '0');
+            } else if (h >= 'a' && h <= 'f') {
+                cp |= static_cast<unsigned>(h - 'a' + 10);
+            } else if (h >= 'A' && h <= 'F') {
+                cp |= static_cast<unsigned>(h - 'A' + 10);
+            } else {
+                fail("invalid \\u escape");
+            }
+        }
+        return cp;
+    }
+
+    void appendUtf8(unsigned cp) {
+        if (cp < 0x80) {
+            buf_ += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            buf_ += static_cast<char>(0xC0 | (cp >> 6));
+            buf_ += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            buf_ += static_cast<char>(0xE0 | (cp >> 12));
+            buf_ += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            buf_ += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            buf_ += static_cast<char>(0xF0 | (cp >> 18));
+            buf_ += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            buf_ += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            buf_ += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // Один многобайтовый символ UTF-8 (проверка по RFC 3629, как в nlohmann::json)
+    void utf8() {
+        auto c = static_cast<unsigned char>(text_[pos_]);
+        std::size_t length = 0;
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+        } else if (c == 0xE0) {
+            length = 3;
+            low = 0xA0;
+        } else if ((c >= 0xE1 && c <= 0xEC) || c == 0xEE || c == 0xEF) {
+            length = 3;
+        } else if (c == 0xED) {
+            length = 3;
+            high = 0x9F;
+        } else if (c == 0xF0) {
+            length = 4;
+            low = 0x90;
+        } else if (c >= 0xF1 && c <= 0xF3) {
+            length = 4;
+        } else if (c == 0xF4) {
+            length = 4;
+            high = 0x8F;
+        } else {
+            fail("invalid UTF-8");
+        }
+        if (pos_ + length > text_.size()) {
+            fail("invalid UTF-8");
+        }
+        for (std::size_t i = 1; i < length; ++i) {
+            auto b = static_cast<unsigned char>(text_[pos_ + i]);
+            if (b < (i == 1 ? low : 0x80) || b > (i == 1 ? high : 0xBF)) {
+                fail("invalid UTF-8");
+            }
+        }
+        buf_.append(text_.data() + pos_, length);
+        pos_ += length;
+    }
+
+    TaskSax& sax_;
+    const char* source_;    ///< Имя формата для сообщений об ошибках.
+    std::string_view text_; ///< Текущая запись.
+    std::size_t pos_ = 0;   ///< Позиция в записи.
+    std::size_t line_ = 0;  ///< Строка файла, на которой начинается запись.
+    std::string buf_;       ///< Буфер строк и ключей, общий для всех записей.
+};
+
+// Индекс столбца CSV по имени из заголовка
+std::optional<std::size_t> column(const std::vector<std::string>& header, const char* name) {
+    for (std::size_t i = 0; i < header.size(); ++i) {
+        if (header[i] == name) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+void readCsv(std::istream& in, IdAllocator::Block* fresh, std::vector<Task>& out,
+             const Task::allocator_type& alloc) {
+    CsvReader reader(in);
+    std::vector<std::string> row;
+    if (!reader.next(row)) {
+        return;
+    }
+    auto idCol = column(row, "id");
+    auto descCol = column(row, "description");
+    auto dueCol = column(row, "dueDate");
+    auto doneCol = column(row, "done");
+    auto tagsCol = column(row, "tags");
+    if (!descCol) {
+        throw std::runtime_error("CSV import: header must contain a description column");
+    }
+    static const std::string empty;
+    TaskFields fields;
+    while (reader.next(row)) {
+        if (row.size() == 1 && row[0].empty()) {
+            continue; // пустая строка
+        }
+        auto cell = [&](const std::optional<std::size_t>& col) -> const std::string& {
+            return col && *col < row.size() ? row[*col] : empty;
+        };
+        fields.clear();
+        if (idCol && !cell(idCol).empty()) {
+            try {
+                fields.id = std::stoll(cell(idCol));
+            } catch (const std::exception&) {
+                throw std::runtime_error(location("CSV", reader.line()) + ": invalid id '"
+                                         + cell(idCol) + "'");
+            }
+        }
+        if (descCol && *descCol < row.size()) {
+            fields.description.swap(row[*descCol]);
+            fields.hasDescription = true;
+        }
+        if (!cell(dueCol).empty()) {
+            fields.dueDate.assign(cell(dueCol));
+            fields.hasDueDate = true;
+        }
+        const std::string& done = cell(doneCol);
+        if (done == "1" || done == "true") {
+            fields.done = true;
+        } else if (!done.empty() && done != "0" && done != "false") {
+            throw std::runtime_error(location("CSV", reader.line()) + ": invalid done value '"
+                                     + done + "'");
+        }
+        const std::string& tags = cell(tagsCol);
+        std::size_t pos = 0;
+        while (pos < tags.size()) {
+            std::size_t semi = tags.find(';', pos);
+            if (semi == std::string::npos) {
+                semi = tags.size();
+            }
+            if (semi > pos) {
+                fields.tags.emplace_back(tags, pos, semi - pos);
+            }
+            pos = semi + 1;
+        }
+        out.push_back(makeTask(fields, fresh, "CSV", reader.line(), alloc));
+    }
+}
+
+void readNdjson(std::istream& in, IdAllocator::Block* fresh, std::vector<Task>& out,
+                const Task::allocator_type& alloc) {
+    TaskSax sax(out, fresh, "NDJSON", true, alloc);
+    RecordReader reader(sax, "NDJSON");
+    std::string line;
+    std::size_t lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        reader.parse(line, lineNo);
+    }
+}
+
+
+// Файл, отображённый в память (или прочитанный целиком, где mmap нет; сжатый — распакованный)
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        if (gzip::isCompressed(path)) {
+            buffer_ = gzip::readAll(path);
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+            return;
+        }
+#if defined(_WIN32) || defined(_WIN64)
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        buffer_.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat file: " + path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ > 0) {
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map file: " + path);
+            }
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(p);
+        }
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (data_ && data_ != buffer_.data()) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view view() const noexcept { return {data_, size_}; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::string buffer_; ///< Данные, если файл не отображён в память.
+};
+
+// Меньше этого на поток делить файл невыгодно: запуск потока дороже разбора
+constexpr std::size_t kMinChunkBytes = 1024 * 1024;
+
+/// Кусок файла для одного потока: байты [begin, end) и записи внутри них.
+struct Chunk {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    std::size_t firstSpan = 0; ///< Для JSON — индексы элементов массива [firstSpan, lastSpan).
+    std::size_t lastSpan = 0;
+    std::size_t firstLine = 1; ///< Номер строки файла, на которой начинается кусок.
+};
+
+/// Элемент массива задач JSON: байты [begin, end).
+struct Span {
+    std::size_t begin;
+    std::size_t end;
+};
+
+std::runtime_error malformedJson(std::size_t pos, const char* what) {
+    return std::runtime_error("JSON import: " + std::string(what) + " at byte " + std::to_string(pos));
+}
+
+std::size_t skipWs(std::string_view d, std::size_t i) {
+    while (i < d.size() && (d[i] == ' ' || d[i] == '\t' || d[i] == '\r' || d[i] == '\n')) {
+        ++i;
+    }
+    return i;
+}
+
+// i — открывающая кавычка; возвращает позицию за закрывающей
+std::size_t skipString(std::string_view d, std::size_t i) {
+    std::size_t start = i++;
+    while (i < d.size()) {
+        char c = d[i];
+        if (c == '\\') {
+            i += 2;
+        } else if (c == '"') {
+            return i + 1;
+        } else {
+            ++i;
+        }
+    }
+    throw malformedJson(start, "unterminated string");
+}
+
+// Пропускает значение JSON без разбора: учитываются только строки и скобки
+std::size_t skipValue(std::string_view d, std::size_t i) {
+    if (i >= d.size()) {
+        throw malformedJson(i, "unexpected end of input");
+    }
+    if (d[i] == '"') {
+        return skipString(d, i);
+    }
+    if (d[i] == '{' || d[i] == '[') {
+        std::size_t start = i;
+        std::size_t depth = 0;
+        while (i < d.size()) {
+            char c = d[i];
+            if (c == '"') {
+                i = skipString(d, i);
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                return i + 1;
+            }
+            ++i;
+        }
+        throw malformedJson(start, "unterminated object or array");
+    }
+    // Число, true, false или null
+    while (i < d.size() && d[i] != ',' && d[i] != ']' && d[i] != '}' && d[i] != ' ' && d[i] != '\t'
+           && d[i] != '\r' && d[i] != '\n') {
+        ++i;
+    }
+    return i;
+}
+
+// Границы задач в массиве верхнего уровня или в {"tasks": [...]} одним проходом
+std::vector<Span> taskSpans(std::string_view d) {
+    std::vector<Span> spans;
+    std::size_t i = skipWs(d, 0);
+    if (i == d.size()) {
+        return spans;
+    }
+    if (d[i] == '{') {
+        i = skipWs(d, i + 1);
+        bool found = false;
+        while (i < d.size() && d[i] != '}') {
+            if (d[i] != '"') {
+                throw malformedJson(i, "expected a key");
+            }
+            std::size_t keyEnd = skipString(d, i);
+            std::string_view key = d.substr(i + 1, keyEnd - i - 2);
+            i = skipWs(d, keyEnd);
+            if (i >= d.size() || d[i] != ':') {
+                throw malformedJson(i, "expected ':'");
+            }
+            i = skipWs(d, i + 1);
+            if (key == "tasks" && i < d.size() && d[i] == '[') {
+                found = true;
+                break;
+            }
+            i = skipWs(d, skipValue(d, i));
+            if (i < d.size() && d[i] == ',') {
+                i = skipWs(d, i + 1);
+            }
+        }
+        if (!found) {
+            // Без массива задач файл не хранилище: пустой результат привёл бы к его перезаписи
+            throw malformedJson(i, "missing \"tasks\" array");
+        }
+    } else if (d[i] != '[') {
+        throw malformedJson(i, "expected an array or an object");
+    }
+    i = skipWs(d, i + 1);
+    while (i < d.size() && d[i] != ']') {
+        std::size_t end = skipValue(d, i);
+        spans.push_back({i, end});
+        i = skipWs(d, end);
+        if (i < d.size() && d[i] == ',') {
+            i = skipWs(d, i + 1);
+        } else if (i < d.size() && d[i] != ']') {
+            throw malformedJson(i, "expected ',' or ']'");
+        }
+    }
+    if (i >= d.size()) {
+        throw malformedJson(i, "unterminated tasks array");
+    }
+    return spans;
+}
+
+// Делит NDJSON на куски примерно равного размера по границам строк
+std::vector<Chunk> ndjsonChunks(std::string_view d, std::size_t count) {
+    std::vector<Chunk> chunks;
+    std::size_t begin = 0;
+    for (std::size_t k = 1; k <= count && begin < d.size(); ++k) {
+        std::size_t end = k == count ? d.size() : std::max(begin, d.size() * k / count);
+        if (end < d.size()) {
+            std::size_t nl = d.find('\n', end);
+            end = nl == std::string_view::npos ? d.size() : nl + 1;
+        }
+        chunks.push_back({begin, end, 0, 0, 1});
+        begin = end;
+    }
+    return chunks;
+}
+
+// Делит элементы массива JSON на куски примерно равного размера в байтах
+std::vector<Chunk> jsonChunks(const std::vector<Span>& spans, std::size_t count) {
+    std::vector<Chunk> chunks;
+    std::size_t first = 0;
+    for (std::size_t k = 1; k <= count && first < spans.size(); ++k) {
+        std::size_t last = first;
+        std::size_t limit = spans.front().begin + (spans.back().end - spans.front().begin) * k / count;
+        while (last < spans.size() && (k == count || spans[last].end <= limit || last == first)) {
+            ++last;
+        }
+        chunks.push_back({spans[first].begin, spans[last - 1].end, first, last, 1});
+        first = last;
+    }
+    return chunks;
+}
+
+// Номера первых строк кусков: один последовательный подсчёт '\n' (memchr-скорость)
+void numberLines(std::string_view d, std::vector<Chunk>& chunks) {
+    std::size_t line = 1;
+    std::size_t pos = 0;
+    for (auto& c : chunks) {
+        line += static_cast<std::size_t>(std::count(d.begin() + pos, d.begin() + c.begin, '\n'));
+        c.firstLine = line;
+        pos = c.begin;
+    }
+}
+
+// Разбирает один кусок NDJSON
+void parseNdjsonChunk(std::string_view d, const Chunk& c, std::vector<Task>& out,
+                      IdAllocator::Block* fresh, const Task::allocator_type& alloc) {
+    TaskSax sax(out, fresh, "NDJSON", true, alloc);
+    RecordReader reader(sax, "NDJSON");
+    std::size_t line = c.firstLine;
+    std::size_t pos = c.begin;
+    while (pos < c.end) {
+        std::size_t nl = d.find('\n', pos);
+        std::size_t end = nl == std::string_view::npos || nl > c.end ? c.end : nl;
+        std::string_view text = d.substr(pos, end - pos);
+        if (text.find_first_not_of(" \t\r") != std::string_view::npos) {
+            reader.parse(text, line);
+        }
+        pos = end + 1;
+        ++line;
+    }
+}
+
+// Разбирает элементы массива JSON одного куска
+void parseJsonChunk(std::string_view d, const std::vector<Span>& spans, const Chunk& c,
+                    std::vector<Task>& out, IdAllocator::Block* fresh, const Task::allocator_type& alloc) {
+    TaskSax sax(out, fresh, "JSON", true, alloc);
+    RecordReader reader(sax, "JSON");
+    std::size_t line = c.firstLine;
+    std::size_t pos = c.begin;
+    for (std::size_t k = c.firstSpan; k < c.lastSpan; ++k) {
+        const Span& s = spans[k];
+        line += static_cast<std::size_t>(std::count(d.begin() + pos, d.begin() + s.begin, '\n'));
+        pos = s.begin;
+        std::string_view text = d.substr(s.begin, s.end - s.begin);
+        if (text.front() != '{') {
+            throw std::runtime_error(location("JSON", line) + ": task must be an object");
+        }
+        reader.parse(text, line);
+    }
+}
+
+} // namespace
+
+std::vector<Task> TaskImporter::read(std::istream& in, const std::string& format, IdAllocator* ids,
+                                     std::size_t sizeHint, TaskArena* arena) {
+    Task::allocator_type alloc = arena ? arena->resource() : std::pmr::get_default_resource();
+    // Один поток: ID по одному, подряд и без пропусков
+    std::optional<IdAllocator::Block> block;
+    if (ids) {
+        block.emplace(*ids, 1);
+    }
+    IdAllocator::Block* fresh = block ? &*block : nullptr;
+    std::vector<Task> tasks;
+    tasks.reserve(sizeHint / kBytesPerTaskEstimate);
+    if (format == "csv") {
+        readCsv(in, fresh, tasks, alloc);
+    } else if (format == "ndjson") {
+        readNdjson(in, fresh, tasks, alloc);
+    } else if (format == "json") {
+        TaskSax sax(tasks, fresh, "JSON", false, alloc);
+        nlohmann::json::sax_parse(in, &sax);
+    } else {
+        throw std::invalid_argument("Unsupported import format: " + format);
+    }
+    return tasks;
+}
+
+std::vector<Task> TaskImporter::readFile(const std::string& path, const std::string& format,
+                                         IdAllocator* ids, TaskArena* arena) {
+    if (path == "-") {
+        return read(std::cin, format, ids, 0, arena);
+    }
+    if (format == "json" || format == "ndjson") {
+        return loadFile(path, format, 0, arena, ids);
+    }
+    if (gzip::isCompressed(path)) {
+        gzip::ReadBuf buf(path);
+        std::istream in(&buf);
+        in.exceptions(std::ios::badbit);
+        return read(in, format, ids, 0, arena);
+    }
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        throw std::runtime_error("Cannot open file for import: " + path);
+    }
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    return read(ifs, format, ids, ec ? 0 : static_cast<std::size_t>(size), arena);
+}
+
+std::vector<Task> TaskImporter::loadFile(const std::string& path, const std::string& format,
+                                         std::size_t threads, TaskArena* arena, IdAllocator* ids) {
+    if (format != "json" && format != "ndjson") {
+        throw std::invalid_argument("Unsupported parallel load format: " + format);
+    }
+    MappedFile file(path);
+    std::string_view data = file.view();
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::max<std::size_t>(1, std::min(threads, data.size() / kMinChunkBytes));
+
+    std::vector<Span> spans;
+    std::vector<Chunk> chunks;
+    if (format == "json") {
+        spans = taskSpans(data);
+        chunks = jsonChunks(spans, threads);
+    } else {
+        chunks = ndjsonChunks(data, threads);
+    }
+    numberLines(data, chunks);
+
+    std::vector<std::vector<Task>> parts(chunks.size());
+    std::vector<std::exception_ptr> errors(chunks.size());
+    // У каждого потока свой монотонный ресурс арены: без блокировок на выделение
+    std::vector<std::pmr::memory_resource*> resources;
+    for (std::size_t k = 0; k < chunks.size(); ++k) {
+        resources.push_back(arena ? arena->resource() : std::pmr::get_default_resource());
+    }
+    // Новые ID поток берёт своим блоком; один кусок — по одному, без пропусков
+    std::size_t blockSize = chunks.size() > 1 ? IdAllocator::kBlockSize : 1;
+    auto work = [&](std::size_t k) {
+        try {
+            std::optional<IdAllocator::Block> block;
+            if (ids) {
+                block.emplace(*ids, blockSize);
+            }
+            IdAllocator::Block* fresh = block ? &*block : nullptr;
+            parts[k].reserve((chunks[k].end - chunks[k].begin) / kBytesPerTaskEstimate);
+            if (format == "json") {
+                parseJsonChunk(data, spans, chunks[k], parts[k], fresh, resources[k]);
+            } else {
+                parseNdjsonChunk(data, chunks[k], parts[k], fresh, resources[k]);
+            }
+        } catch (...) {
+            errors[k] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t k = 1; k < chunks.size(); ++k) {
+        workers.emplace_back(work, k);
+    }
+    if (!chunks.empty()) {
+        work(0);
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    // Первая по порядку файла ошибка — та же, что дал бы последовательный разбор
+    for (const auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+
+    std::size_t total = 0;
+    for (const auto& part : parts) {
+        total += part.size();
+    }
+    std::vector<Task> tasks = parts.empty() ? std::vector<Task>{} : std::move(parts[0]);
+    tasks.reserve(total);
+    for (std::size_t k = 1; k < parts.size(); ++k) {
+        std::move(parts[k].begin(), parts[k].end(), std::back_inserter(tasks));
+    }
+    return tasks;
+}
+
+std::string TaskImporter::formatFromPath(const std::string& path) {
+    std::string ext = std::filesystem::path(gzip::stripExtension(path)).extension().string();
+    if (ext == ".csv") {
+        return "csv";
+    }
+    if (ext == ".json") {
+        return "json";
+    }
+    if (ext == ".ndjson" || ext == ".jsonl") {
+        return "ndjson";
+    }
+    throw std::invalid_argument("Cannot infer import format from " + path + "; use --format");
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "IdAllocator.hpp"
+#include "Task.hpp"
+#include "TaskArena.hpp"
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Массовый импорт задач из файлов в схеме export.
+ *
+ * Форматы:
+ *  - csv    — заголовок и строки как у export --format csv (столбцы ищутся по имени,
+ *             обязателен только description; теги через ';', done — 1/0 или true/false);
+ *  - json   — массив задач как у export --format json (или файл хранилища
+ *             {"generation": N, "tasks": [...]});
+ *  - ndjson — по одному JSON-объекту задачи на строку (как export --format ndjson;
+ *             строка-заголовок хранилища {"generation": N} пропускается).
+ * CSV разбирается потоковым CsvReader, JSON — SAX-разбором прямо в поля задачи,
+ * без промежуточного дерева nlohmann::json.
+ *
+ * Если передана арена, строки и теги задач размещаются в ней (см. TaskArena), и
+ * она должна пережить результат; без арены — в ресурсе по умолчанию.
+ */
+class TaskImporter {
+public:
+    /**
+     * @brief Читает задачи из потока.
+     * @param in       Источник.
+     * @param format   \"csv\", \"json\" или \"ndjson\".
+     * @param ids      Генератор новых ID (как при add; выдаёт их по одному, по порядку файла);
+     *                 nullptr — сохранить ID из файла.
+     * @param sizeHint Размер данных в байтах для предварительного резервирования (0 — неизвестен).
+     * @param arena    Арена для строк задач (nullptr — ресурс по умолчанию).
+     * @return Задачи в порядке файла.
+     * @throws std::invalid_argument Если формат не поддерживается.
+     * @throws std::runtime_error    При ошибке разбора (с номером строки, где он известен).
+     */
+    static std::vector<Task> read(std::istream& in, const std::string& format, IdAllocator* ids,
+                                  std::size_t sizeHint = 0, TaskArena* arena = nullptr);
+
+    /**
+     * @brief Читает задачи из файла (\"-\" — stdin).
+     *
+     * JSON и NDJSON читаются параллельно через loadFile(). Сжатый gzip-файл
+     * распознаётся по сигнатуре и распаковывается в фоновом потоке.
+     * @param ids Генератор новых ID; nullptr — сохранить ID из файла.
+     * @throws std::runtime_error Если файл не открылся или при ошибке разбора.
+     */
+    static std::vector<Task> readFile(const std::string& path, const std::string& format,
+                                      IdAllocator* ids, TaskArena* arena = nullptr);
+
+    /**
+     * @brief Загружает задачи из файла JSON или NDJSON в нескольких потоках.
+     *
+     * Файл отображается в память (mmap; сжатый — распаковывается в память). NDJSON делится на куски по границам строк;
+     * в JSON один быстрый проход находит границы элементов массива задач (учитывая только
+     * строки и скобки), и куски составляются из целых элементов. Каждый поток разбирает
+     * свой кусок SAX-обработчиком в собственный вектор, затем векторы склеиваются по
+     * порядку. Загрузка с ID из файла генератор не трогает: занятые ID отмечает
+     * тот, кто примет задачи (TaskManager).
+     * @param path    Путь к файлу.
+     * @param format  \"json\" или \"ndjson\".
+     * @param threads Число потоков (0 — по числу ядер); на поток приходится не меньше 1 МиБ.
+     * @param arena   Арена для строк задач; каждый поток берёт в ней свой ресурс.
+     * @param ids     Генератор новых ID (nullptr — ID из файла). Каждый поток берёт ID
+     *                своим блоком IdAllocator::Block: они уникальны, но между кусками идут
+     *                не по порядку файла и с пропусками (при одном куске — подряд).
+     * @return Задачи в порядке файла.
+     * @throws std::invalid_argument Если формат не поддерживается.
+     * @throws std::runtime_error    Если файл не открылся или при ошибке разбора (первой по порядку файла).
+     */
+    static std::vector<Task> loadFile(const std::string& path, const std::string& format,
+                                      std::size_t threads = 0, TaskArena* arena = nullptr,
+                                      IdAllocator* ids = nullptr);
+
+    /**
+     * @brief Определяет формат по расширению: .csv, .json, .ndjson или .jsonl (можно с .gz).
+     * @throws std::invalid_argument Если расширение не распознано.
+     */
+    static std::string formatFromPath(const std::string& path);
+};
@@ -1,141 +1,334 @@
 #include "TaskManager.hpp"
+#include "ArrowWriter.hpp"
+#include "Compression.hpp"
+#include "Csv.hpp"
+#include <cctype>
 #include <stdexcept>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <iomanip> // для CSV
 
-int TaskManager::addTask(const std::string& description,
-                         const std::optional<std::string>& dueDate,
-                         const std::vector<std::string>& tags) {
-    Task t(dueDate.has_value() ? Task(description, *dueDate, tags)
-                               : Task(description, tags));
-    tasks_.push_back(t);
-    return t.getId();
+TaskManager::TaskManager(TaskArena* arena)
+    : arena_(arena), resource_(arena ? arena->resource() : std::pmr::get_default_resource()) {}
+
+TaskManager::TaskManager(TaskSnapshot snapshot) : tasks_(std::move(snapshot)) {
+    observeIds(tasks_);
+}
+
+TaskManager::TaskManager(TaskSnapshot snapshot, std::shared_ptr<IdAllocator> ids)
+    : tasks_(std::move(snapshot)), ids_(std::move(ids)) {}
+
+TaskId TaskManager::addTask(const std::string& description,
+                            const std::optional<std::string>& dueDate,
+                            const std::vector<std::string>& tags) {
+    if (dueDate.has_value()) {
+        return emplaceTask(description, *dueDate, tags, resource_);
+    }
+    return emplaceTask(description, tags, resource_);
 }
 
-void TaskManager::removeTask(int id) {
-    ensureExists(id);
-    int idx = findIndexById(id);
-    tasks_.erase(tasks_.begin() + idx);
+void TaskManager::removeTask(TaskId id) {
+    std::size_t idx = indexOf(id);
+    tasks_.erase(idx);
+    table_.reset();
 }
 
-void TaskManager::markDone(int id) {
-    ensureExists(id);
-    int idx = findIndexById(id);
-    tasks_[idx].markDone();
+void TaskManager::markDone(TaskId id) {
+    std::size_t idx = indexOf(id);
+    tasks_.mutableAt(idx).markDone();
+    if (TaskTable* table = tableForUpdate()) {
+        table->setDone(idx, true);
+    }
 }
 
 std::vector<Task> TaskManager::listTasks(const std::optional<bool>& showDone) const {
     if (!showDone.has_value()) {
-        return tasks_;
+        return tasks_.toVector();
     }
-    std::vector<Task> result;
-    for (const auto& t : tasks_) {
-        if (t.isDone() == *showDone) {
-            result.push_back(t);
-        }
+    if (!table_) {
+        ExportOptions filter;
+        filter.done = showDone;
+        return scan([&](const Task& t) { return filter.matches(t); });
     }
-    return result;
+    TaskTable::Selection rows = table().all();
+    table().keepDone(rows, *showDone);
+    return collect(rows);
 }
 
 std::vector<Task> TaskManager::searchByDescription(const std::string& substr) const {
-    std::string lowerSub = substr;
-    std::transform(lowerSub.begin(), lowerSub.end(), lowerSub.begin(), ::tolower);
-    std::vector<Task> result;
-    for (const auto& t : tasks_) {
-        std::string desc = t.getDescription();
-        std::transform(desc.begin(), desc.end(), desc.begin(), ::tolower);
-        if (desc.find(lowerSub) != std::string::npos) {
-            result.push_back(t);
-        }
+    if (!table_) {
+        ExportOptions filter;
+        filter.search = substr;
+        return scan([&](const Task& t) { return filter.matches(t); });
     }
-    return result;
+    TaskTable::Selection rows = table().all();
+    table().keepMatching(rows, substr);
+    return collect(rows);
+}
+
+std::vector<Task> TaskManager::listOverdue(const std::string& today) const {
+    std::optional<std::int32_t> day = TaskTable::parseDate(today);
+    if (!day) {
+        throw std::invalid_argument("Invalid date: " + today);
+    }
+    if (!table_) {
+        return scan([&](const Task& t) {
+            const auto& due = t.getDueDate();
+            return !t.isDone() && due && TaskTable::parseDate(*due).value_or(TaskTable::kNoDueDate) < *day;
+        });
+    }
+    TaskTable::Selection rows = table().all();
+    table().keepOverdue(rows, *day);
+    return collect(rows);
 }
 
-void TaskManager::updateDueDate(int id, const std::string& newDueDate) {
-    ensureExists(id);
-    int idx = findIndexById(id);
-    tasks_[idx].setDueDate(newDueDate);
+void TaskManager::updateDueDate(TaskId id, const std::string& newDueDate) {
+    std::size_t idx = indexOf(id);
+    tasks_.mutableAt(idx).setDueDate(newDueDate);
+    if (TaskTable* table = tableForUpdate()) {
+        table->setDueDate(idx, newDueDate);
+    }
 }
 
-void TaskManager::addTag(int id, const std::string& tag) {
-    ensureExists(id);
-    int idx = findIndexById(id);
-    tasks_[idx].addTag(tag);
+void TaskManager::addTag(TaskId id, const std::string& tag) {
+    std::size_t idx = indexOf(id);
+    tasks_.mutableAt(idx).addTag(tag);
+    table_.reset();
 }
 
-void TaskManager::removeTag(int id, const std::string& tag) {
-    ensureExists(id);
-    int idx = findIndexById(id);
-    tasks_[idx].removeTag(tag);
+void TaskManager::removeTag(TaskId id, const std::string& tag) {
+    std::size_t idx = indexOf(id);
+    tasks_.mutableAt(idx).removeTag(tag);
+    table_.reset();
 }
 
-void TaskManager::exportAll(const std::string& format, const std::string& outPath) const {
+void TaskManager::exportAll(const std::string& format, const std::string& outPath,
+                            const ExportOptions& options) const {
+    bool compress = options.compress || gzip::hasExtension(outPath);
+    // Без фильтров задачи идут подряд, с фильтрами — строки, отобранные по столбцам,
+    // а если таблицы нет — проверяемые по одной при записи
+    std::optional<TaskTable::Selection> rows = select(options);
+    bool filtered = options.done || options.tag || !options.search.empty();
+    auto forEachMatching = [&](auto&& write) {
+        if (rows) {
+            forEachSelected(*rows, write);
+        } else {
+            for (const auto& t : tasks_) {
+                if (!filtered || options.matches(t)) {
+                    write(t);
+                }
+            }
+        }
+    };
     if (format == "json") {
         nlohmann::json arr = nlohmann::json::array();
-        for (const auto& t : tasks_) {
-            arr.push_back(t.toJson());
-        }
-        std::ofstream ofs(outPath);
-        if (!ofs) {
-            throw std::runtime_error("Cannot open file for export: " + outPath);
-        }
-        ofs << std::setw(4) << arr;
+        forEachMatching([&](const Task& t) { arr.push_back(t.toJson()); });
+        OutputWriter out = OutputWriter::toFile(outPath, kExportBufferSize, compress);
+        out.write(arr.dump(4));
+        out.flush();
     } else if (format == "csv") {
-        std::ofstream ofs(outPath);
-        if (!ofs) {
-            throw std::runtime_error("Cannot open file for export: " + outPath);
-        }
-        // Заголовок CSV
-        ofs << "id,description,dueDate,done,tags\n";
-        for (const auto& t : tasks_) {
-            ofs << t.getId() << ",";
-            // Экранируем запятые, если нужно (упрощённый вариант)
-            std::string desc = t.getDescription();
-            if (desc.find(',') != std::string::npos) {
-                ofs << "\"" << desc << "\"";
-            } else {
-                ofs << desc;
-            }
-            ofs << ",";
-            if (t.getDueDate().has_value()) {
-                ofs << t.getDueDate().value();
-            }
-            ofs << ",";
-            ofs << (t.isDone() ? "1" : "0") << ",";
+        OutputWriter out = OutputWriter::toFile(outPath, kExportBufferSize, compress);
+        CsvWriter csv(out, options.delimiter);
+        csv.field("id").field("description").field("dueDate").field("done").field("tags");
+        csv.endRecord();
+        std::string tags;
+        forEachMatching([&](const Task& t) {
+            csv.field(t.getId()).field(t.getDescription());
+            csv.field(t.getDueDate() ? std::string_view(*t.getDueDate()) : std::string_view());
+            csv.field(t.isDone() ? "1" : "0");
             // Теги через точку с запятой
-            const auto& tags = t.getTags();
-            for (size_t i = 0; i < tags.size(); ++i) {
-                ofs << tags[i];
-                if (i + 1 < tags.size()) ofs << ";";
+            const auto& taskTags = t.getTags();
+            tags.clear();
+            for (std::size_t i = 0; i < taskTags.size(); ++i) {
+                if (i > 0) tags += ';';
+                tags += taskTags[i];
             }
-            ofs << "\n";
-        }
+            csv.field(tags);
+            csv.endRecord();
+        });
+        out.flush();
+    } else if (format == "ndjson") {
+        // По одной компактной задаче на строку: файл можно читать и делить по строкам
+        OutputWriter out = OutputWriter::toFile(outPath, kExportBufferSize, compress);
+        forEachMatching([&](const Task& t) { out.writeTaskJson(t).put('\n'); });
+        out.flush();
+    } else if (format == "arrow") {
+        // Колоночный Arrow IPC: пакеты строк пишутся по мере заполнения
+        OutputWriter out = OutputWriter::toFile(outPath, kExportBufferSize, compress);
+        ArrowWriter arrow(out);
+        forEachMatching([&](const Task& t) { arrow.add(t); });
+        arrow.finish();
+        out.flush();
     } else {
         throw std::invalid_argument("Unsupported export format: " + format);
     }
 }
 
-const std::vector<Task>& TaskManager::getAllTasks() const noexcept {
+const Task& TaskManager::getTask(TaskId id) const {
+    return tasks_[indexOf(id)];
+}
+
+std::size_t TaskManager::indexOf(TaskId id) const {
+    std::optional<std::size_t> idx = findIndexById(id);
+    if (!idx) {
+        throw std::runtime_error("Task with id " + std::to_string(id) + " not found");
+    }
+    return *idx;
+}
+
+void TaskManager::insertTask(std::size_t index, const Task& task) {
+    insertTask(index, Task(task));
+}
+
+void TaskManager::insertTask(std::size_t index, Task&& task) {
+    if (index > tasks_.size()) {
+        index = tasks_.size();
+    }
+    ids_->observe(task.getId());
+    tasks_.insert(index, std::move(task));
+    table_.reset();
+}
+
+void TaskManager::replaceTask(const Task& task) {
+    tasks_.mutableAt(indexOf(task.getId())) = task;
+    table_.reset();
+}
+
+void TaskManager::replaceTask(Task&& task) {
+    tasks_.mutableAt(indexOf(task.getId())) = std::move(task);
+    table_.reset();
+}
+
+std::vector<Task> TaskManager::getAllTasks() const {
+    return tasks_.toVector();
+}
+
+TaskSnapshot TaskManager::snapshot() const noexcept {
     return tasks_;
 }
 
 void TaskManager::setAllTasks(const std::vector<Task>& tasks) {
-    tasks_ = tasks;
+    observeIds(tasks);
+    tasks_ = TaskSnapshot(tasks);
+    table_.reset();
+}
+
+void TaskManager::setAllTasks(std::vector<Task>&& tasks) {
+    observeIds(tasks);
+    tasks_ = TaskSnapshot(std::move(tasks));
+    table_.reset();
+}
+
+void TaskManager::appendTasks(std::vector<Task> tasks) {
+    observeIds(tasks);
+    table_.reset();
+    if (tasks_.empty()) {
+        // Пустой список собираем сразу блоками, без поэлементных вставок
+        tasks_ = TaskSnapshot(std::move(tasks));
+        return;
+    }
+    for (auto& t : tasks) {
+        tasks_.push_back(std::move(t));
+    }
+}
+
+TaskArena* TaskManager::arena() const noexcept {
+    return arena_;
+}
+
+IdAllocator& TaskManager::ids() const noexcept {
+    return *ids_;
+}
+
+const TaskTable& TaskManager::table() const {
+    if (!table_) {
+        table_ = std::make_shared<TaskTable>(tasks_);
+    }
+    return *table_;
+}
+
+bool TaskManager::adoptTable(const TaskManager& copy) const {
+    if (table_ || !copy.table_ || !tasks_.sharesStorageWith(copy.tasks_)) {
+        return false;
+    }
+    table_ = copy.table_;
+    return true;
+}
+
+TaskTable* TaskManager::tableForUpdate() {
+    if (!table_) {
+        return nullptr;
+    }
+    if (table_.use_count() > 1) {
+        // Таблицу читает копия менеджера в другом потоке: меняем свою копию столбцов
+        table_ = std::make_shared<TaskTable>(*table_);
+    } else {
+        // use_count() не упорядочивает память: без барьера запись на месте могла бы
+        // обогнать чтения копии, которую только что отпустил другой поток
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return table_.get();
+}
+
+std::optional<TaskTable::Selection> TaskManager::select(const ExportOptions& options) const {
+    if (!table_ || (!options.done && !options.tag && options.search.empty())) {
+        return std::nullopt;
+    }
+    const TaskTable& t = table();
+    TaskTable::Selection rows = t.all();
+    if (options.done) {
+        t.keepDone(rows, *options.done);
+    }
+    if (options.tag) {
+        t.keepTag(rows, *options.tag);
+    }
+    t.keepMatching(rows, options.search);
+    return rows;
+}
+
+std::vector<Task> TaskManager::collect(const TaskTable::Selection& rows) const {
+    std::vector<Task> result;
+    forEachSelected(rows, [&](const Task& t) { result.push_back(t); });
+    return result;
 }
 
-int TaskManager::findIndexById(int id) const noexcept {
-    for (int i = 0; i < static_cast<int>(tasks_.size()); ++i) {
-        if (tasks_[i].getId() == id) {
+std::optional<std::size_t> TaskManager::findIndexById(TaskId id) const noexcept {
+    if (table_) {
+        // Плотный столбец ID вместо прохода по задачам целиком
+        return table_->find(id);
+    }
+    std::size_t i = 0;
+    for (const auto& t : tasks_) {
+        if (t.getId() == id) {
             return i;
         }
+        ++i;
     }
-    return -1;
+    return std::nullopt;
 }
 
-void TaskManager::ensureExists(int id) const {
-    if (findIndexById(id) == -1) {
-        throw std::runtime_error("Task with id " + std::to_string(id) + " not found");
+bool ExportOptions::matches(const Task& t) const {
+    if (done && t.isDone() != *done) {
+        return false;
+    }
+    if (tag) {
+        const auto& tags = t.getTags();
+        if (std::find(tags.begin(), tags.end(), std::string_view(*tag)) == tags.end()) {
+            return false;
+        }
+    }
+    if (!search.empty()) {
+        const Task::String& desc = t.getDescription();
+        auto it = std::search(desc.begin(), desc.end(), search.begin(), search.end(),
+                              [](char a, char b) {
+                                  return std::tolower(static_cast<unsigned char>(a))
+                                         == std::tolower(static_cast<unsigned char>(b));
+                              });
+        if (it == desc.end()) {
+            return false;
+        }
     }
+    return true;
 }
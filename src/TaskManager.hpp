@@ -1,15 +1,88 @@
 #pragma once
 
+#include "PersistentVector.hpp"
 #include "Task.hpp"
+#include "TaskArena.hpp"
+#include "TaskTable.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
 #include <vector>
 #include <optional>
 #include <string>
 
+/**
+ * @brief Неизменяемый снимок списка задач; копируется за O(1).
+ */
+using TaskSnapshot = PersistentVector<Task>;
+
+/**
+ * @brief Параметры экспорта: отбор задач и настройки CSV.
+ *
+ * Фильтры применяются во время записи, без промежуточного списка задач.
+ */
+struct ExportOptions {
+    char delimiter = ',';           ///< Разделитель полей CSV.
+    std::optional<bool> done;       ///< true — только выполненные, false — только активные.
+    std::string search;             ///< Подстрока описания (без учёта регистра); пусто — любые.
+    std::optional<std::string> tag; ///< Только задачи с этим тегом.
+    bool compress = false;          ///< Сжать файл в gzip (и без флага, если путь оканчивается на .gz).
+
+    /**
+     * @brief Проходит ли задача все заданные фильтры.
+     */
+    bool matches(const Task& t) const;
+};
+
 /**
  * @brief Менеджер задач: хранит и управляет списком Task.
+ *
+ * Задачи лежат в PersistentVector, поэтому snapshot() стоит O(1), а изменение
+ * копирует только затронутый блок, если он разделён со снимком.
+ *
+ * Фильтры (listTasks с флагом, listOverdue, поиск, отбор при экспорте) идут по колоночной
+ * TaskTable, а не по самим задачам, если таблица уже построена. Строит её table(): это
+ * окупается, когда фильтров над одним состоянием много (демон). Без таблицы фильтр —
+ * один проход по задачам, поэтому разовая команда и снимок читателя не платят за
+ * построение столбцов. Добавление, done и update-date обновляют таблицу на месте, прочие
+ * изменения сбрасывают. Копия менеджера разделяет с ним готовую таблицу (её изменение
+ * тогда копирует столбцы).
+ *
+ * ID новых задач выдаёт IdAllocator менеджера; копии менеджера разделяют его, поэтому
+ * ID не повторяются и между ними. Готовые задачи (загрузка, импорт с ID, Undo) ID
+ * не расходуют: менеджер лишь отмечает их как занятые.
  */
 class TaskManager {
 public:
+    TaskManager() = default;
+
+    /**
+     * @brief Создаёт пустой менеджер, размещающий строки задач в арене.
+     *
+     * Новые задачи (addTask) берут память из своего ресурса арены; arena() отдаёт арену
+     * загрузчикам, чтобы и загруженные задачи легли в неё. Арена должна пережить
+     * менеджер и все его снимки.
+     * @param arena Арена (nullptr — обычная куча).
+     */
+    explicit TaskManager(TaskArena* arena);
+
+    /**
+     * @brief Создаёт менеджер поверх готового снимка (без копирования задач).
+     *
+     * Удобно для долгих операций только на чтение (например, экспорта) в отдельном
+     * потоке: исходный менеджер тем временем может продолжать изменения.
+     * У менеджера свой генератор ID, поднятый выше ID снимка.
+     * @param snapshot Снимок списка задач.
+     */
+    explicit TaskManager(TaskSnapshot snapshot);
+
+    /**
+     * @brief Создаёт менеджер поверх снимка с общим генератором ID (без прохода по снимку).
+     * @param snapshot Снимок списка задач.
+     * @param ids      Генератор, который уже знает все ID снимка.
+     */
+    TaskManager(TaskSnapshot snapshot, std::shared_ptr<IdAllocator> ids);
+
     /**
      * @brief Добавляет новую задачу.
      * @param description Описание задачи.
@@ -17,23 +90,40 @@ public:
      * @param tags        Список тегов (опционально).
      * @return Сгенерированный уникальный идентификатор задачи.
      */
-    int addTask(const std::string& description,
-                const std::optional<std::string>& dueDate = std::nullopt,
-                const std::vector<std::string>& tags = {});
+    TaskId addTask(const std::string& description,
+                   const std::optional<std::string>& dueDate = std::nullopt,
+                   const std::vector<std::string>& tags = {});
+
+    /**
+     * @brief Добавляет новую задачу, конструируя её прямо в списке (без временной Task).
+     *
+     * Конструктор Task получает новый ID из ids() и затем аргументы как есть: с std::in_place
+     * и Task::String/TagList задача забирает строки без копирования. Ресурс арены менеджера
+     * сам не подставляется.
+     * @return ID новой задачи.
+     */
+    template <typename... Args>
+    TaskId emplaceTask(Args&&... args) {
+        const Task& t = tasks_.emplace_back(ids_->allocate(), std::forward<Args>(args)...);
+        if (TaskTable* table = tableForUpdate()) {
+            table->append(t);
+        }
+        return t.getId();
+    }
 
     /**
      * @brief Удаляет задачу по ID.
      * @param id Идентификатор задачи.
      * @throws std::runtime_error Если задача с таким ID не найдена.
      */
-    void removeTask(int id);
+    void removeTask(TaskId id);
 
     /**
      * @brief Помечает задачу как выполненную.
      * @param id ID задачи.
      * @throws std::runtime_error Если задача не найдена.
      */
-    void markDone(int id);
+    void markDone(TaskId id);
 
     /**
      * @brief Возвращает список задач по фильтру.
@@ -49,13 +139,21 @@ public:
      */
     std::vector<Task> searchByDescription(const std::string& substr) const;
 
+    /**
+     * @brief Возвращает просроченные задачи: активные с дедлайном раньше today.
+     * @param today Текущая дата YYYY-MM-DD.
+     * @return Вектор задач в порядке списка (задачи без даты или с нераспознанной датой не входят).
+     * @throws std::invalid_argument Если today — не дата YYYY-MM-DD.
+     */
+    std::vector<Task> listOverdue(const std::string& today) const;
+
     /**
      * @brief Обновляет дедлайн существующей задачи.
      * @param id        Идентификатор задачи.
      * @param newDueDate Новая дата дедлайна (YYYY-MM-DD).
      * @throws std::runtime_error Если задача не найдена.
      */
-    void updateDueDate(int id, const std::string& newDueDate);
+    void updateDueDate(TaskId id, const std::string& newDueDate);
 
     /**
      * @brief Добавляет тег к задаче.
@@ -63,7 +161,7 @@ public:
      * @param tag Метка для добавления.
      * @throws std::runtime_error Если задача не найдена.
      */
-    void addTag(int id, const std::string& tag);
+    void addTag(TaskId id, const std::string& tag);
 
     /**
      * @brief Удаляет тег у задачи.
@@ -71,22 +169,76 @@ public:
      * @param tag Метка для удаления.
      * @throws std::runtime_error Если задача не найдена.
      */
-    void removeTag(int id, const std::string& tag);
+    void removeTag(TaskId id, const std::string& tag);
 
     /**
-     * @brief Экспортирует все задачи в файл.
-     * @param format  \"json\" или \"csv\".
+     * @brief Экспортирует задачи в файл.
+     *
+     * CSV (RFC 4180, CsvWriter), NDJSON (задача на строку) и колоночный Arrow IPC
+     * (ArrowWriter) пишутся потоково через буфер kExportBufferSize. Любой формат можно
+     * сжать в gzip (ExportOptions::compress или расширение .gz) — сжатие идёт в отдельном потоке.
+     * @param format  \"json\", \"csv\", \"ndjson\" или \"arrow\".
      * @param outPath Путь к выходному файлу.
+     * @param options Фильтры и разделитель CSV (по умолчанию — все задачи через запятую).
      * @throws std::invalid_argument Если указан неподдерживаемый формат.
      * @throws std::runtime_error При ошибках записи.
      */
-    void exportAll(const std::string& format, const std::string& outPath) const;
+    void exportAll(const std::string& format, const std::string& outPath,
+                   const ExportOptions& options = {}) const;
+
+    static constexpr std::size_t kExportBufferSize = 1024 * 1024; ///< Буфер записи экспорта.
+
+    /**
+     * @brief Возвращает задачу по ID.
+     * @param id Идентификатор задачи.
+     * @return const ссылка на задачу (действительна до следующего изменения списка).
+     * @throws std::runtime_error Если задача не найдена.
+     */
+    const Task& getTask(TaskId id) const;
 
     /**
-     * @brief Возвращает внутренний вектор задач.
-     * @return const ссылка на вектор Task.
+     * @brief Возвращает позицию задачи в списке.
+     * @param id Идентификатор задачи.
+     * @return Индекс задачи.
+     * @throws std::runtime_error Если задача не найдена.
      */
-    const std::vector<Task>& getAllTasks() const noexcept;
+    std::size_t indexOf(TaskId id) const;
+
+    /**
+     * @brief Вставляет готовую задачу (с её ID) в заданную позицию (для Undo/Redo).
+     * @param index Позиция; если больше размера списка — задача добавляется в конец.
+     * @param task  Задача для вставки.
+     */
+    void insertTask(std::size_t index, const Task& task);
+
+    /**
+     * @brief То же, но перемещает задачу в список (строки остаются в её ресурсе).
+     */
+    void insertTask(std::size_t index, Task&& task);
+
+    /**
+     * @brief Заменяет задачу с тем же ID на переданную (для Undo/Redo).
+     * @param task Новое состояние задачи.
+     * @throws std::runtime_error Если задача с таким ID не найдена.
+     */
+    void replaceTask(const Task& task);
+
+    /**
+     * @brief То же, но перемещает задачу на место прежней.
+     */
+    void replaceTask(Task&& task);
+
+    /**
+     * @brief Возвращает копию всех задач в виде вектора.
+     * @return Вектор Task (O(n); для сохранения и чтения лучше snapshot()).
+     */
+    std::vector<Task> getAllTasks() const;
+
+    /**
+     * @brief Возвращает снимок текущего списка задач за O(1).
+     * @return Неизменяемый снимок; последующие изменения менеджера его не затрагивают.
+     */
+    TaskSnapshot snapshot() const noexcept;
 
     /**
      * @brief Заменяет весь список задач (для Undo или после загрузки).
@@ -94,20 +246,112 @@ public:
      */
     void setAllTasks(const std::vector<Task>& tasks);
 
+    /**
+     * @brief Заменяет весь список задач, перемещая их в менеджер без копирования
+     *        (строки остаются в ресурсе, в который их загрузили).
+     * @param tasks Новый вектор задач.
+     */
+    void setAllTasks(std::vector<Task>&& tasks);
+
+    /**
+     * @brief Дописывает готовые задачи (с их ID) в конец списка (для импорта).
+     * @param tasks Задачи; перемещаются в менеджер.
+     */
+    void appendTasks(std::vector<Task> tasks);
+
+    /**
+     * @brief Арена, в которой менеджер размещает задачи (nullptr — куча).
+     */
+    TaskArena* arena() const noexcept;
+
+    /**
+     * @brief Генератор ID задач (общий с копиями менеджера).
+     */
+    IdAllocator& ids() const noexcept;
+
+    /**
+     * @brief Колоночное представление текущего списка (строится при первом обращении;
+     *        после этого фильтры идут по нему).
+     * @return Ссылка, действительная до следующего изменения менеджера.
+     */
+    const TaskTable& table() const;
+
+    /**
+     * @brief Берёт таблицу, построенную копией менеджера (например, в другом потоке),
+     *        если своей ещё нет и список задач с момента копирования не менялся.
+     * @param copy Копия этого менеджера.
+     * @return true, если таблица принята.
+     */
+    bool adoptTable(const TaskManager& copy) const;
+
 private:
-    std::vector<Task> tasks_;  ///< Вектор всех задач.
+    TaskSnapshot tasks_;  ///< Все задачи (структурно разделяемые со снимками).
+    TaskArena* arena_ = nullptr; ///< Арена для загрузки задач.
+    std::pmr::memory_resource* resource_ = std::pmr::get_default_resource(); ///< Ресурс для addTask.
+    mutable std::shared_ptr<TaskTable> table_;   ///< Столбцы tasks_ (nullptr — ещё не построены).
+    std::shared_ptr<IdAllocator> ids_ = std::make_shared<IdAllocator>(); ///< Генератор ID.
 
     /**
-     * @brief Ищет индекс задачи в векторе по ID.
-     * @param id ID задачи.
-     * @return Индекс в векторе или -1, если не найден.
+     * @brief Отмечает ID готовых задач как занятые.
+     */
+    template <typename Range>
+    void observeIds(const Range& tasks) noexcept {
+        TaskId maxId = 0;
+        for (const auto& t : tasks) {
+            maxId = std::max(maxId, t.getId());
+        }
+        ids_->observe(maxId);
+    }
+
+    /**
+     * @brief Таблица для обновления на месте (своя копия, если она разделена), или nullptr.
+     */
+    TaskTable* tableForUpdate();
+
+    /**
+     * @brief Строки, прошедшие фильтры экспорта (std::nullopt — фильтров или таблицы нет).
      */
-    int findIndexById(int id) const noexcept;
+    std::optional<TaskTable::Selection> select(const ExportOptions& options) const;
 
     /**
-     * @brief Проверяет существование задачи по ID.
+     * @brief Задачи, для которых keep(task) истинно, одним проходом без таблицы.
+     */
+    template <typename Pred>
+    std::vector<Task> scan(Pred&& keep) const {
+        std::vector<Task> result;
+        for (const auto& t : tasks_) {
+            if (keep(t)) {
+                result.push_back(t);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Копирует строки выборки в вектор задач.
+     */
+    std::vector<Task> collect(const TaskTable::Selection& rows) const;
+
+    /**
+     * @brief Вызывает f(task) для задач выборки по порядку.
+     *
+     * Идёт по tasks_ итератором: доступ по индексу ищет блок линейно и на большой
+     * выборке стоил бы O(n · число блоков).
+     */
+    template <typename F>
+    void forEachSelected(const TaskTable::Selection& rows, F&& f) const {
+        std::size_t row = 0;
+        for (auto it = tasks_.begin(); it != tasks_.end(); ++it, ++row) {
+            if (rows[row / 64] >> (row % 64) & 1) {
+                f(*it);
+            }
+        }
+    }
+
+    /**
+     * @brief Ищет индекс задачи в векторе по ID.
      * @param id ID задачи.
-     * @throws std::runtime_error Если задача не найдена.
+     * @return Индекс в векторе или std::nullopt, если не найден.
      */
-    void ensureExists(int id) const;
+    std::optional<std::size_t> findIndexById(TaskId id) const noexcept;
 };
@@ -0,0 +1,174 @@
+#include "TaskTable.hpp"
+#include <algorithm>
+#include <cctype>
+
+TaskTable::TaskTable(const PersistentVector<Task>& tasks) {
+    ids_.reserve(tasks.size());
+    due_.reserve(tasks.size());
+    done_.reserve((tasks.size() + 63) / 64);
+    tagOffsets_.reserve(tasks.size() + 1);
+    descOffsets_.reserve(tasks.size() + 1);
+    for (const auto& t : tasks) {
+        append(t);
+    }
+}
+
+void TaskTable::append(const Task& t) {
+    std::size_t row = ids_.size();
+    ids_.push_back(t.getId());
+    if (row % 64 == 0) {
+        done_.push_back(0);
+    }
+    if (t.isDone()) {
+        done_.back() |= std::uint64_t{1} << (row % 64);
+    }
+    due_.push_back(t.getDueDate() ? parseDate(*t.getDueDate()).value_or(kNoDueDate) : kNoDueDate);
+    for (const auto& tag : t.getTags()) {
+        auto it = tagDict_.find(std::string(tag));
+        if (it == tagDict_.end()) {
+            it = tagDict_.emplace(std::string(tag), static_cast<std::uint32_t>(tagDict_.size())).first;
+        }
+        tagIds_.push_back(it->second);
+    }
+    tagOffsets_.push_back(static_cast<std::uint32_t>(tagIds_.size()));
+    const auto& desc = t.getDescription();
+    std::size_t start = descLower_.size();
+    descLower_.append(desc.data(), desc.size());
+    std::transform(descLower_.begin() + static_cast<std::ptrdiff_t>(start), descLower_.end(),
+                   descLower_.begin() + static_cast<std::ptrdiff_t>(start),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    descOffsets_.push_back(descLower_.size());
+}
+
+void TaskTable::setDone(std::size_t row, bool done) {
+    std::uint64_t bit = std::uint64_t{1} << (row % 64);
+    if (done) {
+        done_[row / 64] |= bit;
+    } else {
+        done_[row / 64] &= ~bit;
+    }
+}
+
+void TaskTable::setDueDate(std::size_t row, std::string_view dueDate) {
+    due_[row] = parseDate(dueDate).value_or(kNoDueDate);
+}
+
+std::size_t TaskTable::size() const noexcept {
+    return ids_.size();
+}
+
+std::optional<std::size_t> TaskTable::find(TaskId id) const noexcept {
+    auto it = std::find(ids_.begin(), ids_.end(), id);
+    if (it == ids_.end()) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(it - ids_.begin());
+}
+
+TaskTable::Selection TaskTable::all() const {
+    Selection rows(done_.size(), ~std::uint64_t{0});
+    if (ids_.size() % 64 != 0) {
+        rows.back() = (std::uint64_t{1} << (ids_.size() % 64)) - 1;
+    }
+    return rows;
+}
+
+void TaskTable::keepDone(Selection& rows, bool done) const noexcept {
+    // Биты за последней строкой в rows нулевые, поэтому инверсия done_ их не включит
+    std::uint64_t flip = done ? 0 : ~std::uint64_t{0};
+    for (std::size_t w = 0; w < rows.size(); ++w) {
+        rows[w] &= done_[w] ^ flip;
+    }
+}
+
+void TaskTable::keepOverdue(Selection& rows, std::int32_t today) const noexcept {
+    const std::size_t n = due_.size();
+    for (std::size_t w = 0; w < rows.size(); ++w) {
+        if (rows[w] == 0) {
+            continue;
+        }
+        const std::size_t base = w * 64;
+        const std::size_t count = std::min<std::size_t>(64, n - base);
+        const std::int32_t* due = due_.data() + base;
+        std::uint64_t mask = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            mask |= static_cast<std::uint64_t>(due[i] < today) << i;
+        }
+        rows[w] &= mask & ~done_[w];
+    }
+}
+
+void TaskTable::keepTag(Selection& rows, std::string_view tag) const {
+    auto it = tagDict_.find(std::string(tag));
+    if (it == tagDict_.end()) {
+        std::fill(rows.begin(), rows.end(), 0);
+        return;
+    }
+    const std::uint32_t wanted = it->second;
+    Selection hits(rows.size(), 0);
+    std::size_t row = 0;
+    for (std::size_t p = 0; p < tagIds_.size(); ++p) {
+        if (tagIds_[p] != wanted) {
+            continue;
+        }
+        while (tagOffsets_[row + 1] <= p) {
+            ++row;
+        }
+        hits[row / 64] |= std::uint64_t{1} << (row % 64);
+    }
+    for (std::size_t w = 0; w < rows.size(); ++w) {
+        rows[w] &= hits[w];
+    }
+}
+
+void TaskTable::keepMatching(Selection& rows, std::string_view substr) const {
+    if (substr.empty()) {
+        return;
+    }
+    std::string needle(substr);
+    std::transform(needle.begin(), needle.end(), needle.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    Selection hits(rows.size(), 0);
+    std::string_view blob(descLower_);
+    std::size_t pos = 0;
+    while ((pos = blob.find(needle, pos)) != std::string_view::npos) {
+        auto next = std::upper_bound(descOffsets_.begin(), descOffsets_.end(), pos);
+        std::size_t row = static_cast<std::size_t>(next - descOffsets_.begin()) - 1;
+        if (pos + needle.size() <= *next) {
+            hits[row / 64] |= std::uint64_t{1} << (row % 64);
+            pos = *next; // строка уже подходит — ищем со следующей
+        } else {
+            ++pos; // совпадение пересекает границу двух описаний
+        }
+    }
+    for (std::size_t w = 0; w < rows.size(); ++w) {
+        rows[w] &= hits[w];
+    }
+}
+
+// Алгоритм days_from_civil
+std::optional<std::int32_t> TaskTable::parseDate(std::string_view s) noexcept {
+    if (s.size() != 10 || s[4] != '-' || s[7] != '-') {
+        return std::nullopt;
+    }
+    auto num = [&](std::size_t pos, std::size_t len, int& out) {
+        out = 0;
+        for (std::size_t i = pos; i < pos + len; ++i) {
+            if (s[i] < '0' || s[i] > '9') {
+                return false;
+            }
+            out = out * 10 + (s[i] - '0');
+        }
+        return true;
+    };
+    int y, m, d;
+    if (!num(0, 4, y) || !num(5, 2, m) || !num(8, 2, d) || m < 1 || m > 12 || d < 1 || d > 31) {
+        return std::nullopt;
+    }
+    y -= m <= 2;
+    const int era = y / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "PersistentVector.hpp"
+#include "Task.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Колоночное (SoA) представление списка задач для фильтров.
+ *
+ * Строка i таблицы — задача i списка TaskManager. Столбцы плотные:
+ *  - id — ID задач;
+ *  - done — битовая карта, 64 задачи на слово;
+ *  - due — дедлайн в днях от 1970-01-01 (kNoDueDate, если даты нет или она не распознана);
+ *  - теги — номера в словаре тегов: у строки i это tagIds_[tagOffsets_[i] .. tagOffsets_[i + 1]);
+ *  - описания — подряд в одном блоке, в нижнем регистре (поиск без учёта регистра).
+ *
+ * Фильтр сужает выборку Selection (битовую карту строк) и проходит по одному столбцу,
+ * не затрагивая описаний и векторов тегов в самих задачах: --pending — это AND по словам
+ * битовой карты, --overdue — сравнение плотного массива дат, поиск — один проход по блоку.
+ */
+class TaskTable {
+public:
+    using Selection = std::vector<std::uint64_t>; ///< Битовая карта строк: бит i — строка i.
+
+    static constexpr std::int32_t kNoDueDate = std::numeric_limits<std::int32_t>::max();
+
+    TaskTable() = default;
+
+    /**
+     * @brief Строит столбцы по списку задач (один проход).
+     */
+    explicit TaskTable(const PersistentVector<Task>& tasks);
+
+    /**
+     * @brief Добавляет задачу последней строкой.
+     */
+    void append(const Task& t);
+
+    /**
+     * @brief Обновляет флаг выполнения строки.
+     */
+    void setDone(std::size_t row, bool done);
+
+    /**
+     * @brief Обновляет дедлайн строки (нераспознанная дата — kNoDueDate).
+     */
+    void setDueDate(std::size_t row, std::string_view dueDate);
+
+    /**
+     * @brief Число строк.
+     */
+    std::size_t size() const noexcept;
+
+    /**
+     * @brief Строка задачи с данным ID (проход по плотному столбцу ID).
+     * @return Номер строки или std::nullopt.
+     */
+    std::optional<std::size_t> find(TaskId id) const noexcept;
+
+    /**
+     * @brief Выборка из всех строк.
+     */
+    Selection all() const;
+
+    /**
+     * @brief Оставляет в выборке выполненные (done = true) или активные задачи.
+     */
+    void keepDone(Selection& rows, bool done) const noexcept;
+
+    /**
+     * @brief Оставляет активные задачи с дедлайном раньше today.
+     * @param today День в днях от 1970-01-01 (см. parseDate()).
+     */
+    void keepOverdue(Selection& rows, std::int32_t today) const noexcept;
+
+    /**
+     * @brief Оставляет задачи с тегом tag.
+     */
+    void keepTag(Selection& rows, std::string_view tag) const;
+
+    /**
+     * @brief Оставляет задачи, в описании которых есть substr (без учёта регистра ASCII).
+     */
+    void keepMatching(Selection& rows, std::string_view substr) const;
+
+    /**
+     * @brief Вызывает f(row) для каждой строки выборки по возрастанию.
+     */
+    template <typename F>
+    static void forEach(const Selection& rows, F&& f) {
+        for (std::size_t w = 0; w < rows.size(); ++w) {
+            for (std::uint64_t bits = rows[w]; bits != 0; bits &= bits - 1) {
+                f(w * 64 + lowestBit(bits));
+            }
+        }
+    }
+
+    /**
+     * @brief Переводит дату YYYY-MM-DD в дни от 1970-01-01.
+     * @return std::nullopt, если строка не дата этого вида.
+     */
+    static std::optional<std::int32_t> parseDate(std::string_view s) noexcept;
+
+private:
+    static std::size_t lowestBit(std::uint64_t bits) noexcept {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return index;
+#else
+        return static_cast<std::size_t>(__builtin_ctzll(bits));
+#endif
+    }
+
+    std::vector<TaskId> ids_;
+    std::vector<std::uint64_t> done_;
+    std::vector<std::int32_t> due_;
+    std::vector<std::uint32_t> tagOffsets_{0};
+    std::vector<std::uint32_t> tagIds_;
+    std::unordered_map<std::string, std::uint32_t> tagDict_; ///< Тег → номер в словаре.
+    std::vector<std::size_t> descOffsets_{0};
+    std::string descLower_; ///< Описания подряд, в нижнем регистре.
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Фиксированный пул потоков с общей очередью задач.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Запускает потоки.
+     * @param threads Число потоков (0 — по числу ядер, но не меньше одного).
+     */
+    explicit ThreadPool(std::size_t threads = 0);
+
+    /**
+     * @brief Выполняет уже поставленные задачи и останавливает потоки.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Ставит задачу в очередь; исключения из задачи должна ловить она сама.
+     */
+    void submit(std::function<void()> job);
+
+    /**
+     * @brief Выполняет уже поставленные задачи и останавливает потоки (повторный вызов ничего не делает).
+     */
+    void shutdown();
+
+    /**
+     * @brief Число потоков.
+     */
+    std::size_t size() const noexcept;
+
+private:
+    void workerLoop();
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> jobs_; ///< Очередь задач.
+    bool stopping_ = false;                  ///< Новых задач не будет.
+    std::vector<std::thread> threads_;
+};
@@ -1,19 +1,263 @@
 #include "UndoStack.hpp"
+#include <filesystem>
+#include <fstream>
 #include <stdexcept>
+#include <utility>
 
-void UndoStack::pushState(const std::vector<Task>& tasks) {
-    history_.push(tasks);
+namespace {
+
+std::size_t taskHeapBytes(const Task& t) noexcept {
+    std::size_t bytes = t.getDescription().capacity();
+    if (t.getDueDate().has_value()) {
+        bytes += t.getDueDate()->capacity();
+    }
+    bytes += t.getTags().capacity() * sizeof(std::string);
+    for (const auto& tag : t.getTags()) {
+        bytes += tag.capacity();
+    }
+    return bytes;
+}
+
+// Строка журнала: {"s":"u"|"r","i":index,"b":{...},"a":{...}}
+std::string serializeAction(const UndoAction& action, char stack) {
+    nlohmann::json j;
+    j["s"] = std::string(1, stack);
+    j["i"] = action.index;
+    if (action.before) j["b"] = action.before->toJson();
+    if (action.after) j["a"] = action.after->toJson();
+    return j.dump();
 }
 
-std::vector<Task> UndoStack::undo() {
-    if (history_.empty()) {
+UndoAction deserializeAction(const nlohmann::json& j) {
+    UndoAction action;
+    action.index = j.at("i").get<std::size_t>();
+    if (j.contains("b")) action.before = Task::fromJson(j.at("b"));
+    if (j.contains("a")) action.after = Task::fromJson(j.at("a"));
+    return action;
+}
+
+} // namespace
+
+UndoAction UndoAction::added(const Task& task, std::size_t index) {
+    return UndoAction{index, std::nullopt, task};
+}
+
+UndoAction UndoAction::removed(const Task& task, std::size_t index) {
+    return UndoAction{index, task, std::nullopt};
+}
+
+UndoAction UndoAction::updated(const Task& before, const Task& after, std::size_t index) {
+    return UndoAction{index, before, after};
+}
+
+std::size_t UndoAction::memoryUsage() const noexcept {
+    std::size_t bytes = sizeof(UndoAction);
+    if (before) bytes += taskHeapBytes(*before);
+    if (after) bytes += taskHeapBytes(*after);
+    return bytes;
+}
+
+UndoStack::UndoStack(std::size_t memoryBudget) : memoryBudget_(memoryBudget) {}
+
+UndoStack::UndoStack(std::string logPath, std::size_t maxEntries, std::size_t maxLogBytes,
+                     std::size_t memoryBudget)
+    : memoryBudget_(memoryBudget),
+      logPath_(std::move(logPath)),
+      maxEntries_(maxEntries),
+      maxLogBytes_(maxLogBytes),
+      loaded_(false) {}
+
+void UndoStack::push(UndoAction action) {
+    if (logPath_.empty()) {
+        pushInMemory(std::move(action));
+        return;
+    }
+    std::string line = serializeAction(action, 'u');
+    if (loaded_) {
+        pushInMemory(std::move(action));
+    }
+    // Обычная команда платит только за одну дописанную строку
+    appendToLog(line);
+}
+
+void UndoStack::pushInMemory(UndoAction action) {
+    for (const auto& r : redo_) {
+        memoryUsed_ -= r.memoryUsage();
+    }
+    redo_.clear();
+    memoryUsed_ += action.memoryUsage();
+    undo_.push_back(std::move(action));
+    enforceBudget();
+}
+
+UndoAction UndoStack::undo(TaskManager& manager) {
+    ensureLoaded();
+    if (undo_.empty()) {
         throw std::runtime_error("Nothing to undo");
     }
-    auto prev = history_.top();
-    history_.pop();
-    return prev;
+    revert(manager, undo_.back());
+    redo_.push_back(std::move(undo_.back()));
+    undo_.pop_back();
+    if (!logPath_.empty()) {
+        rewriteLog();
+    }
+    return redo_.back();
+}
+
+UndoAction UndoStack::redo(TaskManager& manager) {
+    ensureLoaded();
+    if (redo_.empty()) {
+        throw std::runtime_error("Nothing to redo");
+    }
+    apply(manager, redo_.back());
+    undo_.push_back(std::move(redo_.back()));
+    redo_.pop_back();
+    if (!logPath_.empty()) {
+        rewriteLog();
+    }
+    return undo_.back();
+}
+
+bool UndoStack::canUndo() {
+    ensureLoaded();
+    return !undo_.empty();
 }
 
-bool UndoStack::canUndo() const noexcept {
-    return !history_.empty();
+bool UndoStack::canRedo() {
+    ensureLoaded();
+    return !redo_.empty();
+}
+
+void UndoStack::invalidate() {
+    if (logPath_.empty()) {
+        return;
+    }
+    undo_.clear();
+    redo_.clear();
+    memoryUsed_ = 0;
+    loaded_ = false;
+}
+
+std::size_t UndoStack::memoryUsage() const noexcept {
+    return memoryUsed_;
+}
+
+void UndoStack::revert(TaskManager& manager, const UndoAction& action) {
+    if (!action.before) {
+        manager.removeTask(action.after->getId());
+    } else if (!action.after) {
+        manager.insertTask(action.index, *action.before);
+    } else {
+        manager.replaceTask(*action.before);
+    }
+}
+
+void UndoStack::apply(TaskManager& manager, const UndoAction& action) {
+    if (!action.before) {
+        manager.insertTask(action.index, *action.after);
+    } else if (!action.after) {
+        manager.removeTask(action.before->getId());
+    } else {
+        manager.replaceTask(*action.after);
+    }
+}
+
+void UndoStack::enforceBudget() {
+    // Самую свежую запись не вытесняем, даже если она одна больше бюджета
+    while (memoryUsed_ > memoryBudget_ && undo_.size() > 1) {
+        memoryUsed_ -= undo_.front().memoryUsage();
+        undo_.pop_front();
+    }
+}
+
+void UndoStack::ensureLoaded() {
+    if (loaded_) {
+        return;
+    }
+    loaded_ = true;
+    std::ifstream ifs(logPath_, std::ios::binary);
+    if (!ifs) {
+        // Журнала ещё нет — история пуста
+        return;
+    }
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        nlohmann::json j = nlohmann::json::parse(line, nullptr, false);
+        if (j.is_discarded() || !j.is_object()) {
+            // Недописанная строка (например, после сбоя) — пропускаем
+            continue;
+        }
+        UndoAction action = deserializeAction(j);
+        if (j.value("s", "u") == "r") {
+            memoryUsed_ += action.memoryUsage();
+            redo_.push_back(std::move(action));
+        } else {
+            // Новая операция после отмен делает стек повтора недействительным
+            pushInMemory(std::move(action));
+        }
+    }
+    while (undo_.size() > maxEntries_) {
+        memoryUsed_ -= undo_.front().memoryUsage();
+        undo_.pop_front();
+    }
+}
+
+void UndoStack::appendToLog(const std::string& line) {
+    std::ofstream ofs(logPath_, std::ios::app | std::ios::binary);
+    if (!ofs) {
+        throw std::runtime_error("Cannot open undo log: " + logPath_);
+    }
+    ofs << line << '\n';
+    auto size = static_cast<std::size_t>(ofs.tellp());
+    ofs.close();
+    if (size > maxLogBytes_) {
+        // Сжатие журнала: читаем его целиком и оставляем только свежие записи
+        ensureLoaded();
+        rewriteLog();
+    }
+}
+
+void UndoStack::rewriteLog() {
+    std::vector<std::string> undoLines;
+    std::vector<std::string> redoLines;
+    std::size_t total = 0;
+    for (const auto& a : undo_) {
+        undoLines.push_back(serializeAction(a, 'u'));
+        total += undoLines.back().size() + 1;
+    }
+    for (const auto& a : redo_) {
+        redoLines.push_back(serializeAction(a, 'r'));
+        total += redoLines.back().size() + 1;
+    }
+    // После перезаписи журнал занимает не больше половины лимита,
+    // поэтому следующее сжатие случится не раньше чем через много команд
+    std::size_t firstUndo = undoLines.size() > maxEntries_ ? undoLines.size() - maxEntries_ : 0;
+    for (std::size_t i = 0; i < firstUndo; ++i) {
+        total -= undoLines[i].size() + 1;
+    }
+    while (total > maxLogBytes_ / 2 && firstUndo < undoLines.size()) {
+        total -= undoLines[firstUndo++].size() + 1;
+    }
+    std::size_t firstRedo = 0;
+    while (total > maxLogBytes_ / 2 && firstRedo < redoLines.size()) {
+        total -= redoLines[firstRedo++].size() + 1;
+    }
+
+    std::string tmpPath = logPath_ + ".tmp";
+    {
+        std::ofstream ofs(tmpPath, std::ios::trunc | std::ios::binary);
+        if (!ofs) {
+            throw std::runtime_error("Cannot write undo log: " + tmpPath);
+        }
+        for (std::size_t i = firstUndo; i < undoLines.size(); ++i) {
+            ofs << undoLines[i] << '\n';
+        }
+        for (std::size_t i = firstRedo; i < redoLines.size(); ++i) {
+            ofs << redoLines[i] << '\n';
+        }
+    }
+    std::filesystem::rename(tmpPath, logPath_);
 }
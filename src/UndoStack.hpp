@@ -1,33 +1,155 @@
 #pragma once
 
 #include "Task.hpp"
+#include "TaskManager.hpp"
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <string>
 #include <vector>
-#include <stack>
 
 /**
- * @brief Стек для отмены (Undo) операций над списком задач.
+ * @brief Запись истории: состояние одной задачи до и после операции.
+ *
+ * Хранит только затронутую задачу, поэтому отмена и повтор стоят O(изменения),
+ * а не O(всего списка). Отсутствие before означает добавление, отсутствие after — удаление.
+ */
+struct UndoAction {
+    std::size_t index = 0;       ///< Позиция задачи в списке (для повторной вставки).
+    std::optional<Task> before;  ///< Задача до операции (nullopt для добавления).
+    std::optional<Task> after;   ///< Задача после операции (nullopt для удаления).
+
+    /**
+     * @brief Запись для добавленной задачи.
+     * @param task  Добавленная задача.
+     * @param index Её позиция в списке.
+     */
+    static UndoAction added(const Task& task, std::size_t index);
+
+    /**
+     * @brief Запись для удалённой задачи.
+     * @param task  Задача перед удалением.
+     * @param index Позиция, с которой она была удалена.
+     */
+    static UndoAction removed(const Task& task, std::size_t index);
+
+    /**
+     * @brief Запись для изменённой задачи.
+     * @param before Задача до изменения.
+     * @param after  Задача после изменения.
+     * @param index  Позиция задачи в списке.
+     */
+    static UndoAction updated(const Task& before, const Task& after, std::size_t index);
+
+    /**
+     * @brief Оценивает объём памяти, занимаемый записью.
+     * @return Примерное число байт (с учётом строк и тегов).
+     */
+    std::size_t memoryUsage() const noexcept;
+};
+
+/**
+ * @brief Стек отмены (Undo) и повтора (Redo) операций над списком задач.
+ *
+ * Хранит обратимые записи UndoAction. Общий объём записей ограничен бюджетом памяти:
+ * при его превышении отбрасываются самые старые записи.
+ *
+ * Если задан путь к журналу, история переживает перезапуск программы: каждая push()
+ * дописывает в файл одну строку JSON, а сам файл читается лениво — только при первом
+ * обращении к undo()/redo()/canUndo()/canRedo(). Журнал ограничен по числу записей и
+ * размеру: при превышении размера он перезаписывается, сохраняя только свежие записи.
  */
 class UndoStack {
 public:
+    static constexpr std::size_t kDefaultMemoryBudget = 4 * 1024 * 1024; ///< 4 МБ.
+    static constexpr std::size_t kDefaultMaxEntries = 1000;              ///< Записей в журнале.
+    static constexpr std::size_t kDefaultMaxLogBytes = 1024 * 1024;      ///< 1 МБ.
+
     /**
-     * @brief Сохраняет текущее состояние в стеке.
-     * @param tasks Вектор задач на момент времени.
+     * @brief Конструктор стека, живущего только в памяти.
+     * @param memoryBudget Максимальный объём истории в байтах.
      */
-    void pushState(const std::vector<Task>& tasks);
+    explicit UndoStack(std::size_t memoryBudget = kDefaultMemoryBudget);
 
     /**
-     * @brief Отменяет последнее действие.
-     * @return Предыдущее сохранённое состояние списка задач.
-     * @throws std::runtime_error Если нечего отменять.
+     * @brief Конструктор стека с журналом на диске.
+     * @param logPath      Путь к журналу (например, tasks.json.undo).
+     * @param maxEntries   Максимальное число записей, сохраняемых в журнале.
+     * @param maxLogBytes  Размер журнала, при превышении которого он сжимается.
+     * @param memoryBudget Максимальный объём истории в памяти в байтах.
      */
-    std::vector<Task> undo();
+    explicit UndoStack(std::string logPath,
+                       std::size_t maxEntries = kDefaultMaxEntries,
+                       std::size_t maxLogBytes = kDefaultMaxLogBytes,
+                       std::size_t memoryBudget = kDefaultMemoryBudget);
 
     /**
-     * @brief Проверяет, есть ли доступные для отмены состояния.
-     * @return true, если стек не пуст.
+     * @brief Сохраняет запись о выполненной операции и очищает стек повтора.
+     * @param action Запись об операции.
+     * @throws std::runtime_error Если не удалось дописать журнал.
      */
-    bool canUndo() const noexcept;
+    void push(UndoAction action);
+
+    /**
+     * @brief Отменяет последнюю операцию.
+     * @param manager Менеджер, к которому применяется обратная операция.
+     * @return Отменённая запись (копия).
+     * @throws std::runtime_error Если нечего отменять или задача уже не найдена.
+     */
+    UndoAction undo(TaskManager& manager);
+
+    /**
+     * @brief Повторяет последнюю отменённую операцию.
+     * @param manager Менеджер, к которому применяется операция.
+     * @return Повторённая запись (копия).
+     * @throws std::runtime_error Если нечего повторять или задача уже не найдена.
+     */
+    UndoAction redo(TaskManager& manager);
+
+    /**
+     * @brief Проверяет, есть ли доступные для отмены операции.
+     * @return true, если стек отмены не пуст.
+     * @throws std::runtime_error Если журнал не удалось прочитать.
+     */
+    bool canUndo();
+
+    /**
+     * @brief Проверяет, есть ли доступные для повтора операции.
+     * @return true, если стек повтора не пуст.
+     * @throws std::runtime_error Если журнал не удалось прочитать.
+     */
+    bool canRedo();
+
+    /**
+     * @brief Забывает прочитанный журнал: следующее обращение перечитает его с диска.
+     *
+     * Нужно, когда журнал мог дописать другой процесс (например, демон перечитал
+     * файл данных). Без журнала на диске ничего не делает.
+     */
+    void invalidate();
+
+    /**
+     * @brief Возвращает текущий объём истории.
+     * @return Примерное число байт во всех записях.
+     */
+    std::size_t memoryUsage() const noexcept;
 
 private:
-    std::stack<std::vector<Task>> history_; ///< История состояний списка задач.
+    static void revert(TaskManager& manager, const UndoAction& action);
+    static void apply(TaskManager& manager, const UndoAction& action);
+    void pushInMemory(UndoAction action);
+    void enforceBudget();
+    void ensureLoaded();
+    void appendToLog(const std::string& line);
+    void rewriteLog();
+
+    std::deque<UndoAction> undo_;  ///< Записи для отмены (в конце — последняя).
+    std::vector<UndoAction> redo_; ///< Записи для повтора (в конце — последняя отменённая).
+    std::size_t memoryBudget_;     ///< Бюджет памяти в байтах.
+    std::size_t memoryUsed_ = 0;   ///< Текущий объём обоих стеков.
+
+    std::string logPath_;               ///< Путь к журналу (пусто — без журнала).
+    std::size_t maxEntries_ = 0;        ///< Лимит записей в журнале.
+    std::size_t maxLogBytes_ = 0;       ///< Лимит размера журнала в байтах.
+    bool loaded_ = true;                ///< Журнал уже прочитан в память.
 };
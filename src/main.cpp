@@ -1,144 +1,183 @@
+#include <csignal>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <mutex>
 #include "CLIParser.hpp"
+#include "CommandProcessor.hpp"
+#include "TaskArena.hpp"
 #include "TaskManager.hpp"
 #include "Storage.hpp"
 #include "UndoStack.hpp"
 #include "Logger.hpp"
+#include "OutputWriter.hpp"
+#include "HistoryLog.hpp"
+#include "Server.hpp"
+
+namespace {
+
+constexpr int kMaxSaveAttempts = 5; ///< Попыток выполнить команду, если файл меняют другие процессы.
+
+Server* activeServer = nullptr; ///< Демон, которому SIGINT/SIGTERM передаётся как stop().
+
+void stopServer(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+// Путь из аргументов клиента: относительный разрешается в каталоге клиента, а не демона
+std::string clientPath(const std::string& path) {
+    return path == "-" ? path : std::filesystem::absolute(path).string();
+}
+
+// Тонкий клиент: argv без --connect пересылается демону, его вывод печатается как есть.
+// Пути --out и --in (export, import, history --replay) делаются абсолютными
+int forwardToDaemon(int argc, char* argv[], const std::string& socketPath) {
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--connect") {
+            ++i;
+        } else if (arg.rfind("--connect=", 0) == 0) {
+            continue;
+        } else if ((arg == "--out" || arg == "--in") && i + 1 < argc) {
+            args.push_back(std::move(arg));
+            args.push_back(clientPath(argv[++i]));
+        } else if (arg.rfind("--out=", 0) == 0 || arg.rfind("--in=", 0) == 0) {
+            std::size_t eq = arg.find('=');
+            args.push_back(arg.substr(0, eq + 1) + clientPath(arg.substr(eq + 1)));
+        } else {
+            args.push_back(std::move(arg));
+        }
+    }
+    Client client(socketPath);
+    protocol::Response response = client.call(args);
+    OutputWriter out(response.status == 0 ? 1 : 2);
+    out.write(response.body);
+    return response.status;
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
+    // list/search пишут в stdout напрямую через OutputWriter
+    std::ios::sync_with_stdio(false);
     try {
         // 1) Парсим CLI
         CLIOptions opts = CLIParser::parse(argc, argv);
+        if (opts.args.count("connect")) {
+            return forwardToDaemon(argc, argv, opts.args.at("connect"));
+        }
 
-        // 2) Инициализируем Storage (из --data-file и store-format)
-        Storage storage(opts.dataFilePath, opts.format);
-
-        // 3) Загружаем текущий список задач
-        std::vector<Task> loadedTasks = storage.load();
+        // 2) Инициализируем Storage (из --data-file, store-format и --compress;
+        //    у export флаг --compress относится к выгрузке, а не к файлу данных)
+        Storage storage(opts.dataFilePath, opts.format,
+                        opts.command != "export" && opts.args.count("compress") > 0);
 
-        // 4) Инициализируем менеджер и загрузим в него
-        TaskManager manager;
-        manager.setAllTasks(loadedTasks);
+        // 3) Менеджер задач; загружается через processor.reload(): вектор из load()
+        //    перемещается в менеджер, а commit() сохраняет его снимок — задачи на пути
+        //    load → менеджер → save не копируются. Одна команда CLI
+        //    размещает строки задач в арене: выход из процесса освобождает её целиком,
+        //    а не миллионы строк по одной. Демон живёт долго и работает с кучей.
+        TaskArena arena;
+        TaskManager manager(opts.command == "serve" ? nullptr : &arena);
 
-        // 5) Инициализируем UndoStack и Logger
-        UndoStack undoStack;
+        // 4) Инициализируем UndoStack и Logger
+        // Журнал отмены хранится рядом с файлом данных и читается только для undo/redo
+        UndoStack undoStack(opts.dataFilePath + ".undo");
         Logger& logger = Logger::instance("history.log");
-
-        // 6) В зависимости от команды выполняем действия
-        const std::string& cmd = opts.command;
-        if (cmd == "add") {
-            // Сохраняем состояние для undo
-            undoStack.pushState(manager.getAllTasks());
-
-            std::string desc = opts.args.at("description");
-            std::optional<std::string> due = std::nullopt;
-            if (opts.args.count("due")) {
-                due = opts.args.at("due");
+        {
+            // Ротация журнала: сегмент на 10 МиБ или на неделю, хранится 10 сжатых сегментов
+            LoggerOptions logOptions;
+            logOptions.rotateBytes = 10ull * 1024 * 1024;
+            logOptions.rotateAge = std::chrono::hours(24 * 7);
+            if (opts.command == "batch" || opts.command == "import" || opts.command == "serve") {
+                // Пакет, импорт и демон пишут много строк: их дописывает фоновый поток
+                // порциями, а не вызывающий после каждой строки
+                logOptions.async = true;
+                logOptions.flushBytes = 64 * 1024;
             }
-            std::vector<std::string> tags;
-            if (opts.args.count("tags")) {
-                // Теги через запятую: "work,urgent"
-                std::string tagsStr = opts.args.at("tags");
-                size_t pos = 0;
-                while (true) {
-                    auto comma = tagsStr.find(',', pos);
-                    if (comma == std::string::npos) {
-                        tags.push_back(tagsStr.substr(pos));
-                        break;
-                    }
-                    tags.push_back(tagsStr.substr(pos, comma - pos));
-                    pos = comma + 1;
+            logger.setOptions(logOptions);
+        }
+        // Структурированная история, как и журнал отмены, принадлежит файлу данных
+        HistoryLog history(opts.dataFilePath + ".history.ndjson");
+
+        // 5) Выполняем команду (или пакет команд) и сохраняем результат
+        CommandProcessor processor(manager, storage, undoStack, history, logger);
+        OutputWriter out(1);
+        if (opts.command == "batch") {
+            // Один load/save на весь пакет вместо одного на команду; другие процессы
+            // ждут конца пакета, поэтому сохранение не может устареть
+            std::lock_guard<Storage> exclusive(storage);
+            processor.reload();
+            std::size_t checkpoint = opts.args.count("checkpoint")
+                                         ? std::stoul(opts.args.at("checkpoint"))
+                                         : 0;
+            std::string file = opts.args.count("file") ? opts.args.at("file") : "-";
+            std::ifstream ifs;
+            if (file != "-") {
+                ifs.open(file);
+                if (!ifs) {
+                    throw std::runtime_error("Cannot open batch file: " + file);
                 }
             }
-            int newId = manager.addTask(desc, due, tags);
-            storage.save(manager.getAllTasks());
-            logger.log("ADD id=" + std::to_string(newId) + " description=\"" + desc + "\""
-                       + (due ? (" due=" + *due) : "")
-                       + (tags.empty() ? "" : " tags=[" + opts.args.at("tags") + "]"));
-            std::cout << "Task added with id " << newId << "\n";
-        } else if (cmd == "remove") {
-            int id = std::stoi(opts.args.at("id"));
-            undoStack.pushState(manager.getAllTasks());
-            manager.removeTask(id);
-            storage.save(manager.getAllTasks());
-            logger.log("REMOVE id=" + std::to_string(id));
-            std::cout << "Task " << id << " removed\n";
-        } else if (cmd == "done") {
-            int id = std::stoi(opts.args.at("id"));
-            undoStack.pushState(manager.getAllTasks());
-            manager.markDone(id);
-            storage.save(manager.getAllTasks());
-            logger.log("DONE id=" + std::to_string(id));
-            std::cout << "Task " << id << " marked done\n";
-        } else if (cmd == "list") {
-            std::optional<bool> filter = std::nullopt;
-            if (opts.args.count("filter")) {
-                std::string f = opts.args.at("filter");
-                if (f == "all") {
-                    filter = std::nullopt;
-                } else if (f == "done") {
-                    filter = true;
-                } else if (f == "pending") {
-                    filter = false;
-                } else {
-                    throw std::runtime_error("Unknown filter: " + f);
-                }
+            BatchResult result = processor.runBatch(file == "-" ? std::cin : ifs, out, std::cerr,
+                                                    checkpoint);
+            out.flush();
+            std::cerr << "Batch: " << result.executed << " ok, " << result.failed << " failed\n";
+            return result.failed == 0 ? 0 : 1;
+        }
+        if (opts.command == "serve") {
+            // Задачи остаются в памяти; клиенты подключаются через --connect <сокет>
+            std::string socketPath = opts.args.count("socket") ? opts.args.at("socket")
+                                                               : opts.dataFilePath + ".sock";
+            std::size_t workers = opts.args.count("workers") ? std::stoul(opts.args.at("workers")) : 0;
+            processor.reload();
+            Server server(socketPath, processor, workers);
+            activeServer = &server;
+            std::signal(SIGINT, stopServer);
+            std::signal(SIGTERM, stopServer);
+            std::cerr << "Serving " << opts.dataFilePath << " on " << socketPath << "\n";
+            server.run();
+            activeServer = nullptr;
+            return 0;
+        }
+        if (CommandProcessor::isQuery(opts) || opts.command == "history") {
+            // Файл данных не меняется — вывод идёт прямо в stdout
+            processor.reload();
+            processor.execute(opts, out);
+            processor.commit();
+            out.flush();
+            return 0;
+        }
+
+        // Изменение: если файл успел сохранить другой процесс, перечитываем его
+        // и выполняем команду заново. undo/redo переписывают журнал отмены до
+        // сохранения, поэтому их цикл целиком идёт под исключительной блокировкой.
+        std::unique_lock<Storage> exclusive(storage, std::defer_lock);
+        if (opts.command == "undo" || opts.command == "redo") {
+            exclusive.lock();
+        }
+        for (int attempt = 1;; ++attempt) {
+            processor.reload();
+            std::string text;
+            {
+                OutputWriter buffered(text);
+                processor.execute(opts, buffered);
             }
-            auto tasksToShow = manager.listTasks(filter);
-            for (const auto& t : tasksToShow) {
-                std::cout << "[" << t.getId() << "] "
-                          << (t.isDone() ? "[x] " : "[ ] ")
-                          << t.getDescription();
-                if (t.getDueDate().has_value()) {
-                    std::cout << " (due " << *t.getDueDate() << ")";
-                }
-                if (!t.getTags().empty()) {
-                    std::cout << " {";
-                    const auto& tg = t.getTags();
-                    for (size_t i = 0; i < tg.size(); ++i) {
-                        std::cout << tg[i];
-                        if (i + 1 < tg.size()) std::cout << ",";
-                    }
-                    std::cout << "}";
+            try {
+                processor.commit();
+            } catch (const StaleDataError&) {
+                if (attempt == kMaxSaveAttempts) {
+                    throw;
                 }
-                std::cout << "\n";
+                continue;
             }
-        } else if (cmd == "search") {
-            std::string substr = opts.args.at("query");
-            auto found = manager.searchByDescription(substr);
-            for (const auto& t : found) {
-                std::cout << "[" << t.getId() << "] "
-                          << (t.isDone() ? "[x] " : "[ ] ")
-                          << t.getDescription() << "\n";
-            }
-        } else if (cmd == "update-date") {
-            int id = std::stoi(opts.args.at("id"));
-            std::string newDue = opts.args.at("due");
-            undoStack.pushState(manager.getAllTasks());
-            manager.updateDueDate(id, newDue);
-            storage.save(manager.getAllTasks());
-            logger.log("UPDATE-DATE id=" + std::to_string(id) + " due=" + newDue);
-            std::cout << "Task " << id << " due-date updated to " << newDue << "\n";
-        } else if (cmd == "export") {
-            std::string fmt = opts.args.at("format");
-            std::string out = opts.args.at("out");
-            manager.exportAll(fmt, out);
-            logger.log("EXPORT format=" + fmt + " out=" + out);
-            std::cout << "Exported to " << out << "\n";
-        } else if (cmd == "undo") {
-            if (!undoStack.canUndo()) {
-                std::cout << "Nothing to undo\n";
-            } else {
-                auto prev = undoStack.undo();
-                manager.setAllTasks(prev);
-                storage.save(manager.getAllTasks());
-                logger.log("UNDO");
-                std::cout << "Last action undone\n";
-            }
-        } else {
-            std::cout << "Unknown command: " << cmd << "\n";
-            return 1;
+            out.write(text);
+            break;
         }
+        out.flush();
 
         return 0;
     } catch (const std::exception& ex) {
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+#include "ArrowWriter.hpp"
+#include <cstring>
+
+namespace {
+
+template <typename T>
+T readLe(const std::string& s, std::size_t pos) {
+    T value{};
+    std::memcpy(&value, s.data() + pos, sizeof(T)); // тесты идут на little-endian машинах
+    return value;
+}
+
+// Поле таблицы flatbuffer; 0, если поле не записано
+std::size_t fieldPos(const std::string& s, std::size_t table, int id) {
+    std::size_t vtable = table - readLe<std::int32_t>(s, table);
+    std::uint16_t vtableSize = readLe<std::uint16_t>(s, vtable);
+    if (4u + 2u * id >= vtableSize) {
+        return 0;
+    }
+    std::uint16_t off = readLe<std::uint16_t>(s, vtable + 4 + 2 * id);
+    return off == 0 ? 0 : table + off;
+}
+
+// Типы заголовков сообщений (1 — схема, 2 — словарь, 3 — пакет) по порядку файла
+std::vector<int> messageTypes(const std::string& file) {
+    std::vector<int> types;
+    std::size_t pos = 8;
+    while (true) {
+        EXPECT_EQ(readLe<std::uint32_t>(file, pos), 0xFFFFFFFFu);
+        auto metaLen = readLe<std::int32_t>(file, pos + 4);
+        if (metaLen == 0) {
+            break; // конец потока
+        }
+        std::size_t meta = pos + 8;
+        std::size_t table = meta + readLe<std::uint32_t>(file, meta);
+        types.push_back(file[fieldPos(file, table, 1)]);
+        auto body = readLe<std::int64_t>(file, fieldPos(file, table, 3));
+        pos = meta + static_cast<std::size_t>(metaLen) + static_cast<std::size_t>(body);
+        EXPECT_EQ(pos % 8, 0u);
+    }
+    return types;
+}
+
+} // namespace
+
+TEST(ArrowWriterTest, FileLayoutAndColumns) {
+    std::string file;
+    {
+        OutputWriter out(file);
+        ArrowWriter arrow(out);
+        // restore() не расходует ID, тесты не влияют на нумерацию в других наборах
+        Task first = Task::restore(1, "first", std::string("2025-06-01"), false, {"home"});
+        Task second = Task::restore(2, "second", std::nullopt, true, {});
+        arrow.add(first);
+        arrow.add(second);
+        arrow.finish();
+        out.flush();
+    }
+    ASSERT_GT(file.size(), 20u);
+    EXPECT_EQ(file.compare(0, 8, std::string("ARROW1\0\0", 8)), 0);
+    EXPECT_EQ(file.compare(file.size() - 6, 6, "ARROW1"), 0);
+    auto footerLen = readLe<std::int32_t>(file, file.size() - 10);
+    ASSERT_LT(static_cast<std::size_t>(footerLen), file.size());
+    EXPECT_EQ(messageTypes(file), (std::vector<int>{1, 2, 3}));
+    // Строки столбца description лежат подряд, без разделителей
+    EXPECT_NE(file.find("firstsecond"), std::string::npos);
+}
+
+TEST(ArrowWriterTest, NewTagsInLaterBatchGoToDeltaDictionary) {
+    std::string file;
+    {
+        OutputWriter out(file);
+        ArrowWriter arrow(out);
+        Task a = Task::restore(1, "a", std::nullopt, false, {"common"});
+        for (std::size_t i = 0; i < ArrowWriter::kBatchRows; ++i) {
+            arrow.add(a);
+        }
+        Task b = Task::restore(2, "b", std::nullopt, false, {"common", "late"});
+        arrow.add(b);
+        arrow.add(a); // известный тег — новой записи словаря нет
+        arrow.finish();
+        out.flush();
+    }
+    EXPECT_EQ(messageTypes(file), (std::vector<int>{1, 2, 3, 2, 3}));
+}
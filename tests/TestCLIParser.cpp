@@ -30,3 +30,15 @@ TEST(CLIParserTest, ParseListDefault) {
     EXPECT_EQ(opts.dataFilePath, "tasks.json");
     EXPECT_EQ(opts.format, "json");
 }
+
+TEST(CLIParserTest, ParseSearchWithOutput) {
+    const char* argv[] = {"prog", "search", "buy", "milk", "--output", "tsv"};
+    int argc = 6;
+    auto opts = CLIParser::parse(argc, const_cast<char**>(argv));
+    EXPECT_EQ(opts.command, "search");
+    EXPECT_EQ(opts.args.at("query"), "buy milk");
+    EXPECT_EQ(opts.output, "tsv");
+
+    const char* bad[] = {"prog", "list", "--output=xml"};
+    EXPECT_THROW(CLIParser::parse(3, const_cast<char**>(bad)), std::runtime_error);
+}
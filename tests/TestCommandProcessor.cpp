@@ -0,0 +1,252 @@
+#include "gtest/gtest.h"
+#include "CommandProcessor.hpp"
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Отдельные файлы данных, отмены и истории для каждого теста
+struct BatchFixture {
+    explicit BatchFixture(const std::string& name)
+        : data(name + ".json"), historyPath(name + ".ndjson"), storage(data, "json"),
+          undo(data + ".undo"), history(historyPath), logger(Logger::instance("test_command_history.log")) {}
+    ~BatchFixture() {
+        fs::remove(data);
+        fs::remove(data + ".undo");
+        fs::remove(historyPath);
+        fs::remove(historyPath + ".idx");
+    }
+
+    std::string data;
+    std::string historyPath;
+    Storage storage;
+    UndoStack undo;
+    HistoryLog history;
+    Logger& logger;
+    TaskManager manager;
+};
+
+} // namespace
+
+TEST(CommandProcessorTest, SplitCommandLineHandlesQuotes) {
+    auto words = CLIParser::splitCommandLine(R"(add "Buy milk" --tags='a b' x\ y)");
+    ASSERT_EQ(words.size(), 4);
+    EXPECT_EQ(words[1], "Buy milk");
+    EXPECT_EQ(words[2], "--tags=a b");
+    EXPECT_EQ(words[3], "x y");
+    EXPECT_THROW(CLIParser::splitCommandLine("add \"open"), std::runtime_error);
+}
+
+TEST(CommandProcessorTest, BatchSavesOnceAndReportsErrors) {
+    BatchFixture f("test_batch");
+    CommandProcessor processor(f.manager, f.storage, f.undo, f.history, f.logger);
+    std::istringstream in(
+        "# комментарий\n"
+        "add \"First task\" --due 2025-05-05\n"
+        "\n"
+        "add Second\n"
+        "remove 42\n"
+        "done 1\n"
+        "bogus\n");
+    std::string text;
+    std::ostringstream err;
+    {
+        OutputWriter out(text);
+        BatchResult result = processor.runBatch(in, out, err);
+        EXPECT_EQ(result.executed, 3);
+        EXPECT_EQ(result.failed, 2);
+    }
+    EXPECT_NE(text.find("Task added with id 2"), std::string::npos);
+    EXPECT_NE(err.str().find("line 5: Error:"), std::string::npos);
+    EXPECT_NE(err.str().find("line 7: Error:"), std::string::npos);
+
+    auto saved = Storage(f.data, "json").load();
+    ASSERT_EQ(saved.size(), 2);
+    EXPECT_EQ(saved[0].getDescription(), "First task");
+    EXPECT_TRUE(saved[0].isDone());
+
+    std::size_t records = 0;
+    f.history.query(HistoryFilter{}, [&](const HistoryRecord&) { ++records; });
+    EXPECT_EQ(records, 3);
+}
+
+TEST(CommandProcessorTest, CheckpointsAndUndoInsideBatch) {
+    BatchFixture f("test_batch_cp");
+    CommandProcessor processor(f.manager, f.storage, f.undo, f.history, f.logger);
+    std::istringstream in("add A\nadd B\nadd C\nundo\n");
+    std::string text;
+    std::ostringstream err;
+    OutputWriter out(text);
+    BatchResult result = processor.runBatch(in, out, err, 2);
+    EXPECT_EQ(result.failed, 0);
+    // После второй строки; undo (четвёртая) сохраняет себя сама, и контрольной точке
+    // после неё сохранять нечего
+    EXPECT_EQ(result.checkpoints, 1);
+    EXPECT_FALSE(processor.dirty());
+
+    auto saved = Storage(f.data, "json").load();
+    ASSERT_EQ(saved.size(), 2);
+    EXPECT_EQ(saved[1].getDescription(), "B");
+    EXPECT_TRUE(f.undo.canRedo());
+}
+
+TEST(CommandProcessorTest, CommitReusesLockHeldByCaller) {
+    BatchFixture f("test_commit_locked");
+    CommandProcessor processor(f.manager, f.storage, f.undo, f.history, f.logger);
+    CLIOptions opts;
+    opts.command = "add";
+    opts.args["description"] = "Locked";
+    std::string text;
+    OutputWriter out(text);
+    {
+        // Как batch: блокировка взята заранее, commit() не должен захватывать её повторно
+        std::lock_guard<Storage> exclusive(f.storage);
+        processor.reload();
+        processor.execute(opts, out);
+        processor.commit();
+        EXPECT_TRUE(f.storage.locked());
+    }
+    EXPECT_FALSE(f.storage.locked());
+    EXPECT_EQ(Storage(f.data, "json").load().size(), 1u);
+    EXPECT_TRUE(f.undo.canUndo());
+    fs::remove(f.data + ".lock");
+}
+
+TEST(CommandProcessorTest, HistoryIsStampedAtCommit) {
+    BatchFixture f("test_history_stamp");
+    CommandProcessor processor(f.manager, f.storage, f.undo, f.history, f.logger);
+    CLIOptions opts;
+    opts.command = "add";
+    opts.args["description"] = "Stamped";
+    std::string text;
+    OutputWriter out(text);
+    processor.reload();
+    processor.execute(opts, out);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::int64_t beforeCommit = HistoryLog::nowMs();
+    processor.commit();
+
+    // Метка — время добавления в историю, а не выполнения команды
+    std::vector<HistoryRecord> records;
+    f.history.query(HistoryFilter{}, [&](const HistoryRecord& r) { records.push_back(r); });
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_GE(records[0].timestampMs, beforeCommit);
+    fs::remove(f.data + ".lock");
+}
+
+TEST(CommandProcessorTest, ReloadPicksUpUndoEntriesOfOtherProcesses) {
+    BatchFixture f("test_undo_reload");
+    // Резидентный процессор (как serve) и отдельный запуск CLI над тем же файлом
+    CommandProcessor resident(f.manager, f.storage, f.undo, f.history, f.logger);
+    Storage cliStorage(f.data, "json");
+    UndoStack cliUndo(f.data + ".undo");
+    TaskManager cliManager;
+    CommandProcessor cli(cliManager, cliStorage, cliUndo, f.history, f.logger);
+
+    auto run = [](CommandProcessor& p, const std::string& line) {
+        std::vector<std::string> words = CLIParser::splitCommandLine(line);
+        std::vector<char*> argv{const_cast<char*>("ToDoManager")};
+        for (auto& w : words) {
+            argv.push_back(&w[0]);
+        }
+        std::string text;
+        OutputWriter out(text);
+        p.execute(CLIParser::parse(static_cast<int>(argv.size()), argv.data()), out);
+        p.commit();
+    };
+    resident.reload();
+    run(resident, "add A");
+    run(resident, "add A2");
+    // Стек отмены демона прочитан с диска
+    run(resident, "undo");
+
+    cli.reload();
+    run(cli, "add B");
+
+    EXPECT_TRUE(resident.reloadIfChanged());
+    run(resident, "undo");
+    auto saved = Storage(f.data, "json").load();
+    ASSERT_EQ(saved.size(), 1u);
+    EXPECT_EQ(saved[0].getDescription(), "A");
+    fs::remove(f.data + ".lock");
+}
+
+TEST(CommandProcessorTest, ImportHistoryIsSelfContainedAndReplays) {
+    BatchFixture f("test_import_history");
+    CommandProcessor processor(f.manager, f.storage, f.undo, f.history, f.logger);
+    std::string source = "test_import_history_source.csv";
+    {
+        std::ofstream csv(source);
+        csv << "description,done\nFirst,0\nSecond,1\nThird,0\n";
+    }
+    auto run = [&](const std::string& line) {
+        std::vector<std::string> words = CLIParser::splitCommandLine(line);
+        std::vector<char*> argv{const_cast<char*>("ToDoManager")};
+        for (auto& w : words) {
+            argv.push_back(&w[0]);
+        }
+        std::string text;
+        OutputWriter out(text);
+        processor.execute(CLIParser::parse(static_cast<int>(argv.size()), argv.data()), out);
+        processor.commit();
+    };
+    processor.reload();
+    run("add Before");
+    run("import --in " + source);
+    run("remove 1");
+
+    std::vector<HistoryRecord> imports;
+    HistoryFilter byOp;
+    byOp.op = "IMPORT";
+    f.history.query(byOp, [&](const HistoryRecord& r) { imports.push_back(r); });
+    ASSERT_EQ(imports.size(), 1u);
+    EXPECT_EQ(imports[0].tasks.size(), 3u);
+    EXPECT_FALSE(imports[0].extra.contains("in"));
+
+    auto expectReplayMatches = [&] {
+        auto replayed = f.history.replay(HistoryLog::nowMs());
+        auto current = f.manager.getAllTasks();
+        ASSERT_EQ(replayed.size(), current.size());
+        for (std::size_t i = 0; i < current.size(); ++i) {
+            EXPECT_EQ(replayed[i].getId(), current[i].getId());
+            EXPECT_EQ(replayed[i].getDescription(), current[i].getDescription());
+            EXPECT_EQ(replayed[i].isDone(), current[i].isDone());
+        }
+    };
+    // История самодостаточна: replay не нуждается в исходном файле
+    fs::remove(source);
+    expectReplayMatches();
+    {
+        std::ofstream csv(source);
+        csv << "description,done\nFirst,0\nSecond,1\nThird,0\n";
+    }
+
+    // По флагу — запись на каждую задачу
+    run("import --history-per-task --in " + source);
+    imports.clear();
+    f.history.query(byOp, [&](const HistoryRecord& r) { imports.push_back(r); });
+    EXPECT_EQ(imports.size(), 4u);
+
+    // По ссылке: replay перечитывает файл и восстанавливает выданные при импорте ID
+    run("import --history-by-reference --in " + source);
+    imports.clear();
+    f.history.query(byOp, [&](const HistoryRecord& r) { imports.push_back(r); });
+    ASSERT_EQ(imports.size(), 5u);
+    EXPECT_EQ(imports.back().extra.at("count").get<std::size_t>(), 3u);
+    EXPECT_TRUE(imports.back().extra.at("stamp").contains("hash"));
+    expectReplayMatches();
+
+    // Изменённый исходный файл не проигрывается молча, даже при том же числе задач
+    {
+        std::ofstream csv(source);
+        csv << "description,done\nFirst,0\nSecond,1\nThirb,0\n";
+    }
+    EXPECT_THROW(f.history.replay(HistoryLog::nowMs()), std::runtime_error);
+    fs::remove(source);
+    fs::remove(f.data + ".lock");
+}
@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+#include "Compression.hpp"
+#include "OutputWriter.hpp"
+#include "Storage.hpp"
+#include "TaskManager.hpp"
+#include <filesystem>
+#include <fstream>
+#include <istream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string readWhole(const std::string& path) {
+    gzip::ReadBuf buf(path);
+    std::istream in(&buf);
+    in.exceptions(std::ios::badbit);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+TEST(CompressionTest, RoundTripAcrossBlocksAndMembers) {
+    if (!gzip::available()) {
+        GTEST_SKIP() << "built without zlib";
+    }
+    std::string path = "test_compression.txt.gz";
+    std::string expected;
+    {
+        OutputWriter out = OutputWriter::toFile(path, 4096, true);
+        for (int i = 0; i < 200000; ++i) {
+            out.write("line ").writeInt(i).put('\n');
+        }
+        out.flush(); // первый gzip-член
+        out.write("tail\n");
+    }
+    for (int i = 0; i < 200000; ++i) {
+        expected += "line " + std::to_string(i) + "\n";
+    }
+    expected += "tail\n";
+    EXPECT_TRUE(gzip::isCompressed(path));
+    EXPECT_LT(fs::file_size(path), expected.size() / 4);
+    EXPECT_EQ(readWhole(path), expected);
+    EXPECT_EQ(gzip::readAll(path), expected);
+    EXPECT_EQ(gzip::readHead(path, 7), "line 0\n");
+
+    // Обрезанный файл — ошибка, а не молчаливый конец данных
+    fs::resize_file(path, fs::file_size(path) / 2);
+    EXPECT_THROW(readWhole(path), std::runtime_error);
+    fs::remove(path);
+}
+
+TEST(CompressionTest, EmptyOutputIsValidGzip) {
+    if (!gzip::available()) {
+        GTEST_SKIP() << "built without zlib";
+    }
+    std::string path = "test_compression_empty.gz";
+    {
+        OutputWriter out = OutputWriter::toFile(path, 4096, true);
+    }
+    EXPECT_TRUE(gzip::isCompressed(path));
+    EXPECT_EQ(gzip::readAll(path), "");
+    fs::remove(path);
+}
+
+TEST(CompressionTest, CompressedStoreStaysCompressed) {
+    if (!gzip::available()) {
+        GTEST_SKIP() << "built without zlib";
+    }
+    for (const char* format : {"json", "ndjson"}) {
+        std::string path = std::string("test_compressed_store.") + format;
+        fs::remove(path);
+        {
+            Storage st(path, format, true);
+            st.save({Task::restore(7, "compressed", std::string("2025-01-01"), true, {"z"})});
+        }
+        EXPECT_TRUE(gzip::isCompressed(path)) << format;
+        // Без флага: сжатие распознаётся по сигнатуре и сохраняется при записи
+        Storage st(path, format);
+        auto loaded = st.load();
+        ASSERT_EQ(loaded.size(), 1u) << format;
+        EXPECT_EQ(loaded[0].getId(), 7) << format;
+        EXPECT_EQ(loaded[0].getTags(), (Task::TagList{"z"})) << format;
+        st.save(loaded);
+        EXPECT_TRUE(gzip::isCompressed(path)) << format;
+        EXPECT_FALSE(st.changedOnDisk()) << format;
+        fs::remove(path);
+        fs::remove(path + ".lock");
+    }
+}
+
+TEST(CompressionTest, ExportByExtension) {
+    if (!gzip::available()) {
+        GTEST_SKIP() << "built without zlib";
+    }
+    TaskManager manager;
+    manager.appendTasks({Task::restore(1, "a, b", std::nullopt, false, {})});
+    manager.exportAll("csv", "test_export.csv.gz");
+    EXPECT_EQ(gzip::readAll("test_export.csv.gz"), "id,description,dueDate,done,tags\r\n1,\"a, b\",,0,\r\n");
+    fs::remove("test_export.csv.gz");
+}
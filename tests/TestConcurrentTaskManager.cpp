@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "ConcurrentTaskManager.hpp"
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentTaskManagerTest, FailedUpdatePublishesNothing) {
+    ConcurrentTaskManager mgr;
+    TaskId id = mgr.addTask("Keep");
+    EXPECT_THROW(mgr.update([&](TaskManager& m) {
+        m.markDone(id);
+        m.removeTask(-1);
+    }), std::runtime_error);
+    EXPECT_FALSE(mgr.getTask(id).isDone());
+    EXPECT_EQ(mgr.size(), 1);
+}
+
+// Запускается и под ThreadSanitizer (-DTODO_ENABLE_TSAN=ON)
+TEST(ConcurrentTaskManagerTest, ReadersSeeConsistentSnapshotsUnderWriters) {
+    ConcurrentTaskManager mgr;
+    constexpr int kWriters = 2;
+    constexpr int kReaders = 4;
+    constexpr int kPerWriter = 300;
+    std::atomic<bool> writing{true};
+    std::atomic<int> inconsistencies{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; ++r) {
+        readers.emplace_back([&, r] {
+            std::size_t lastSize = 0;
+            while (writing.load()) {
+                auto tasks = r % 2 ? mgr.listTasks() : mgr.searchByDescription("writer");
+                std::set<TaskId> ids;
+                for (const auto& t : tasks) {
+                    // Пара add + done публикуется одним снимком: невыполненных «done»-задач нет
+                    if (!ids.insert(t.getId()).second ||
+                        (t.getDescription().find("done") != std::string::npos && !t.isDone())) {
+                        ++inconsistencies;
+                    }
+                }
+                // Задачи только добавляются, поэтому снимки не уменьшаются
+                if (r % 2 && tasks.size() < lastSize) {
+                    ++inconsistencies;
+                }
+                lastSize = r % 2 ? tasks.size() : lastSize;
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&, w] {
+            for (int i = 0; i < kPerWriter; ++i) {
+                std::string desc = "writer " + std::to_string(w) + (i % 3 ? " plain" : " done");
+                mgr.update([&](TaskManager& m) {
+                    TaskId id = m.addTask(desc);
+                    if (i % 3 == 0) {
+                        m.markDone(id);
+                    }
+                });
+            }
+        });
+    }
+    for (auto& t : writers) {
+        t.join();
+    }
+    writing = false;
+    for (auto& t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(inconsistencies.load(), 0);
+    EXPECT_EQ(mgr.size(), static_cast<std::size_t>(kWriters * kPerWriter));
+    EXPECT_EQ(mgr.listTasks(true).size(), static_cast<std::size_t>(kWriters * kPerWriter / 3));
+}
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+#include "Csv.hpp"
+#include <sstream>
+
+TEST(CsvReaderTest, QuotedFieldsWithDelimitersQuotesAndNewlines) {
+    std::istringstream in("id,description\r\n"
+                          "1,plain\r\n"
+                          "2,\"a, b\"\n"
+                          "3,\"say \"\"hi\"\"\"\n"
+                          "4,\"two\nlines\",extra\n"
+                          "5,");
+    CsvReader reader(in);
+    std::vector<std::string> row;
+
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"id", "description"}));
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"1", "plain"}));
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"2", "a, b"}));
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"3", "say \"hi\""}));
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"4", "two\nlines", "extra"}));
+    EXPECT_EQ(reader.line(), 5u);
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"5", ""}));
+    EXPECT_EQ(reader.line(), 7u);
+    EXPECT_FALSE(reader.next(row));
+}
+
+TEST(CsvReaderTest, RecordsSpanningReadBlocks) {
+    // Записи длиннее блока чтения собираются из нескольких блоков
+    std::string longText(CsvReader::kBufferSize + 100, 'x');
+    std::istringstream in("\"" + longText + "\",\"q\"\"\"\n" + longText + ",end\n");
+    CsvReader reader(in);
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{longText, "q\""}));
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{longText, "end"}));
+    EXPECT_FALSE(reader.next(row));
+}
+
+TEST(CsvReaderTest, UnterminatedQuoteThrows) {
+    std::istringstream in("1,\"never closed\n2,x\n");
+    CsvReader reader(in);
+    std::vector<std::string> row;
+    EXPECT_THROW(reader.next(row), std::runtime_error);
+}
+
+TEST(CsvWriterTest, QuotesOnlyWhenNeeded) {
+    EXPECT_FALSE(CsvWriter::needsQuoting("plain text without specials", ','));
+    EXPECT_TRUE(CsvWriter::needsQuoting("a,b", ','));
+    EXPECT_FALSE(CsvWriter::needsQuoting("a,b", ';'));
+    // Спецсимвол в каждой позиции длинной строки (и в 8-байтовых словах, и в хвосте)
+    std::string base(37, 'x');
+    for (char special : {'"', '\n', '\r', ';'}) {
+        for (std::size_t pos = 0; pos < base.size(); ++pos) {
+            std::string s = base;
+            s[pos] = special;
+            EXPECT_TRUE(CsvWriter::needsQuoting(s, ';')) << pos;
+        }
+    }
+}
+
+TEST(CsvWriterTest, WritesRfc4180AndReadsBack) {
+    std::string text;
+    {
+        OutputWriter out(text);
+        CsvWriter csv(out);
+        csv.field(7).field("say \"hi\", twice").field("").field("two\nlines");
+        csv.endRecord();
+        csv.field("plain").endRecord();
+    }
+    EXPECT_EQ(text, "7,\"say \"\"hi\"\", twice\",,\"two\nlines\"\r\nplain\r\n");
+
+    std::istringstream in(text);
+    CsvReader reader(in);
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"7", "say \"hi\", twice", "", "two\nlines"}));
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"plain"}));
+    EXPECT_FALSE(reader.next(row));
+}
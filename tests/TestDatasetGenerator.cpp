@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+#include "DatasetGenerator.hpp"
+#include "OutputWriter.hpp"
+#include "Storage.hpp"
+#include "TaskTable.hpp"
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<Task> collect(const DatasetGenerator& generator) {
+    std::vector<Task> tasks;
+    generator.generate([&tasks](const Task& t) { tasks.emplace_back(t); });
+    return tasks;
+}
+
+std::string toJson(const std::vector<Task>& tasks) {
+    std::string out;
+    {
+        OutputWriter writer(out);
+        for (const auto& t : tasks) {
+            writer.writeTaskJson(t).put('\n');
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(DatasetGeneratorTest, SameSeedGivesSameTasks) {
+    DatasetOptions options;
+    options.count = 500;
+    options.seed = 42;
+    auto first = collect(DatasetGenerator(options));
+    auto second = collect(DatasetGenerator(options));
+    ASSERT_EQ(first.size(), 500u);
+    EXPECT_EQ(toJson(first), toJson(second));
+
+    options.seed = 43;
+    EXPECT_NE(toJson(first), toJson(collect(DatasetGenerator(options))));
+}
+
+TEST(DatasetGeneratorTest, FollowsRequestedDistributions) {
+    DatasetOptions options;
+    options.count = 20000;
+    options.minDescription = 10;
+    options.maxDescription = 40;
+    options.tagVocabulary = 50;
+    options.tagSkew = 1.2;
+    options.maxTags = 2;
+    options.doneFraction = 0.25;
+    options.dueFraction = 0.6;
+    options.dueFrom = "2025-03-01";
+    options.dueSpreadDays = 30;
+    DatasetGenerator generator(options);
+    EXPECT_EQ(generator.nextId(), 20001);
+
+    std::size_t done = 0, due = 0;
+    std::map<std::string, std::size_t> tagCounts;
+    TaskId expectedId = 1;
+    const auto from = *TaskTable::parseDate("2025-03-01");
+    generator.generate([&](const Task& t) {
+        EXPECT_EQ(t.getId(), expectedId++);
+        EXPECT_GE(t.getDescription().size(), 10u);
+        EXPECT_LE(t.getDescription().size(), 40u);
+        EXPECT_LE(t.getTags().size(), 2u);
+        done += t.isDone();
+        if (t.getDueDate()) {
+            ++due;
+            auto day = TaskTable::parseDate(*t.getDueDate());
+            ASSERT_TRUE(day.has_value()) << *t.getDueDate();
+            EXPECT_GE(*day, from);
+            EXPECT_LT(*day, from + 30);
+        }
+        for (const auto& tag : t.getTags()) {
+            ++tagCounts[std::string(tag)];
+        }
+    });
+    EXPECT_NEAR(done / 20000.0, 0.25, 0.02);
+    EXPECT_NEAR(due / 20000.0, 0.6, 0.02);
+    // Закон Ципфа: частота убывает с рангом, ранг 1 встречается примерно в 2^1.2 раза чаще ранга 2
+    const double top = static_cast<double>(tagCounts[DatasetGenerator::tagName(1)]);
+    EXPECT_GT(top, static_cast<double>(tagCounts[DatasetGenerator::tagName(2)]));
+    EXPECT_GT(static_cast<double>(tagCounts[DatasetGenerator::tagName(2)]),
+              static_cast<double>(tagCounts[DatasetGenerator::tagName(10)]));
+    EXPECT_NEAR(top / static_cast<double>(tagCounts[DatasetGenerator::tagName(2)]), 2.3, 0.3);
+}
+
+TEST(DatasetGeneratorTest, RejectsInconsistentOptions) {
+    DatasetOptions options;
+    options.minDescription = 50;
+    options.maxDescription = 10;
+    EXPECT_THROW(DatasetGenerator{options}, std::invalid_argument);
+    options = {};
+    options.doneFraction = 1.5;
+    EXPECT_THROW(DatasetGenerator{options}, std::invalid_argument);
+    options = {};
+    options.dueFrom = "March 1st";
+    EXPECT_THROW(DatasetGenerator{options}, std::invalid_argument);
+}
+
+TEST(DatasetGeneratorTest, StreamsIntoEveryStoreFormat) {
+    DatasetOptions options;
+    options.count = 300;
+    DatasetGenerator generator(options);
+    auto expected = toJson(collect(generator));
+    for (const char* format : {"json", "ndjson", "sqlite"}) {
+        std::string tmp = std::string("test_generated.") + format;
+        fs::remove(tmp);
+        {
+            Storage st(tmp, format);
+            st.saveStream([&generator](const auto& sink) { generator.generate(sink); },
+                          generator.nextId());
+        }
+        Storage st(tmp, format);
+        auto loaded = st.load();
+        EXPECT_EQ(toJson(loaded), expected) << format;
+        EXPECT_EQ(st.nextId(), 301) << format;
+        fs::remove(tmp);
+        fs::remove(tmp + ".lock");
+    }
+}
@@ -0,0 +1,110 @@
+#include "gtest/gtest.h"
+#include "HistoryLog.hpp"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+HistoryRecord makeRecord(std::int64_t ts, const std::string& op, const Task& task) {
+    HistoryRecord r;
+    r.timestampMs = ts;
+    r.op = op;
+    r.id = task.getId();
+    r.task = task;
+    return r;
+}
+
+} // namespace
+
+TEST(HistoryLogTest, ParseAndFormatTime) {
+    EXPECT_EQ(HistoryLog::parseTime("1970-01-02"), 86400000);
+    EXPECT_EQ(HistoryLog::parseTime("2025-06-10T11:03:07.5Z"), 1749553387500);
+    EXPECT_EQ(HistoryLog::parseTime("1749553387500"), 1749553387500);
+    EXPECT_EQ(HistoryLog::formatTime(1749553387500), "2025-06-10T11:03:07.500Z");
+    EXPECT_THROW(HistoryLog::parseTime("yesterday"), std::invalid_argument);
+}
+
+TEST(HistoryLogTest, QueryUsesFiltersAndIndex) {
+    std::string path = "test_history.ndjson";
+    fs::remove(path);
+    fs::remove(path + ".idx");
+    HistoryLog log(path);
+    // Достаточно записей, чтобы в индексе появилось несколько точек
+    std::string padding(200, 'x');
+    for (int i = 0; i < 1000; ++i) {
+        Task t(i + 1, "Task " + std::to_string(i) + " " + padding);
+        log.append(makeRecord(1000 + i, i % 2 ? "DONE" : "ADD", t));
+    }
+    EXPECT_GT(fs::file_size(path + ".idx"), 16u);
+
+    HistoryFilter filter;
+    filter.sinceMs = 1900;
+    filter.untilMs = 1949;
+    filter.op = "ADD";
+    std::vector<std::int64_t> seen;
+    log.query(filter, [&](const HistoryRecord& r) { seen.push_back(r.timestampMs); });
+    ASSERT_EQ(seen.size(), 25u);
+    EXPECT_EQ(seen.front(), 1900);
+    EXPECT_EQ(seen.back(), 1948);
+
+    fs::remove(path);
+    fs::remove(path + ".idx");
+}
+
+TEST(HistoryLogTest, ReplayRebuildsStateAtPointInTime) {
+    std::string path = "test_replay.ndjson";
+    fs::remove(path);
+    fs::remove(path + ".idx");
+    HistoryLog log(path);
+
+    Task a(1, "A");
+    Task b(2, "B", "2025-01-01");
+    log.append(makeRecord(100, "ADD", a));
+    log.append(makeRecord(200, "ADD", b));
+    Task bDone = b;
+    bDone.markDone();
+    log.append(makeRecord(300, "DONE", bDone));
+    HistoryRecord rm;
+    rm.timestampMs = 400;
+    rm.op = "REMOVE";
+    rm.id = a.getId();
+    rm.removed = true;
+    log.append(rm);
+
+    auto at250 = log.replay(250);
+    ASSERT_EQ(at250.size(), 2u);
+    EXPECT_FALSE(at250[1].isDone());
+
+    auto at350 = log.replay(350);
+    ASSERT_EQ(at350.size(), 2u);
+    EXPECT_TRUE(at350[1].isDone());
+
+    auto latest = log.replay(1000);
+    ASSERT_EQ(latest.size(), 1u);
+    EXPECT_EQ(latest[0].getId(), b.getId());
+
+    fs::remove(path);
+    fs::remove(path + ".idx");
+}
+
+TEST(HistoryLogTest, ReplayKeepsWideIdsApart) {
+    std::string path = "test_replay_wide.ndjson";
+    fs::remove(path);
+    fs::remove(path + ".idx");
+    HistoryLog log(path);
+
+    // Усечённые до 32 бит эти ID совпали бы
+    Task low(1, "Low");
+    Task high((TaskId{1} << 32) + 1, "High");
+    log.append(makeRecord(100, "ADD", low));
+    log.append(makeRecord(200, "ADD", high));
+
+    auto tasks = log.replay(1000);
+    ASSERT_EQ(tasks.size(), 2u);
+    EXPECT_EQ(tasks[0].getDescription(), "Low");
+    EXPECT_EQ(tasks[1].getId(), high.getId());
+
+    fs::remove(path);
+    fs::remove(path + ".idx");
+}
@@ -0,0 +1,48 @@
+#include "gtest/gtest.h"
+#include "IdAllocator.hpp"
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(IdAllocatorTest, AllocatesInOrderAndObserveOnlyRaises) {
+    IdAllocator ids;
+    EXPECT_EQ(ids.allocate(), 1);
+    EXPECT_EQ(ids.allocate(), 2);
+    EXPECT_EQ(ids.allocate(10), 3);
+    EXPECT_EQ(ids.next(), 13);
+
+    ids.observe(5); // уже выдан — ничего не меняется
+    EXPECT_EQ(ids.next(), 13);
+    ids.observe(100);
+    EXPECT_EQ(ids.next(), 101);
+    EXPECT_EQ(ids.allocate(), 101);
+}
+
+TEST(IdAllocatorTest, ThreadBlocksNeverCollide) {
+    IdAllocator ids(std::int64_t{1} << 40); // больше 32 бит
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 10000;
+    std::vector<std::vector<TaskId>> taken(kThreads);
+    std::vector<std::thread> workers;
+    for (int k = 0; k < kThreads; ++k) {
+        workers.emplace_back([&, k] {
+            IdAllocator::Block block(ids, 100);
+            for (int i = 0; i < kPerThread; ++i) {
+                taken[k].push_back(block.take());
+                if (i % 1000 == 0) {
+                    ids.observe(ids.next() - 1); // загрузка рядом с импортом
+                }
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    std::set<TaskId> all;
+    for (const auto& part : taken) {
+        all.insert(part.begin(), part.end());
+    }
+    EXPECT_EQ(all.size(), static_cast<std::size_t>(kThreads * kPerThread));
+    EXPECT_GE(*all.begin(), std::int64_t{1} << 40);
+    EXPECT_LT(*all.rbegin(), ids.next());
+}
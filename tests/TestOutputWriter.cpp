@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+#include "OutputWriter.hpp"
+
+TEST(OutputWriterTest, IntegersAndStrings) {
+    std::string buf;
+    {
+        OutputWriter out(buf);
+        out.writeInt(0).put(' ').writeInt(-42).put(' ').writeInt(9223372036854775807LL);
+        out.put(' ').writeInt(-9223372036854775807LL - 1);
+    }
+    EXPECT_EQ(buf, "0 -42 9223372036854775807 -9223372036854775808");
+}
+
+TEST(OutputWriterTest, LargeWritesPreserveOrder) {
+    std::string buf;
+    std::string big(OutputWriter::kBufferSize + 10, 'x');
+    {
+        OutputWriter out(buf);
+        out.write("a").write(big).write("b");
+    }
+    EXPECT_EQ(buf, "a" + big + "b");
+}
+
+TEST(OutputWriterTest, TextFormat) {
+    Task t(1, "Buy milk", "2025-06-10", {"home", "shop"});
+    std::string buf;
+    OutputWriter out(buf);
+    TaskPrinter printer(out, OutputFormat::Text);
+    printer.print(t);
+    printer.finish();
+    EXPECT_EQ(buf, "[" + std::to_string(t.getId()) + "] [ ] Buy milk (due 2025-06-10) {home,shop}\n");
+
+    // Формат search: без дедлайна и тегов
+    std::string brief;
+    OutputWriter briefOut(brief);
+    TaskPrinter briefPrinter(briefOut, OutputFormat::Text, false);
+    briefPrinter.print(t);
+    briefPrinter.finish();
+    EXPECT_EQ(brief, "[" + std::to_string(t.getId()) + "] [ ] Buy milk\n");
+}
+
+TEST(OutputWriterTest, JsonFormatIsParseable) {
+    Task t1(1, "Quote \" and \\ and\nnewline");
+    Task t2(2, "Second", "2025-01-01", {"x"});
+    t2.markDone();
+    std::string buf;
+    OutputWriter out(buf);
+    TaskPrinter printer(out, OutputFormat::Json);
+    printer.print(t1);
+    printer.print(t2);
+    printer.finish();
+
+    auto arr = nlohmann::json::parse(buf);
+    ASSERT_EQ(arr.size(), 2);
+    EXPECT_EQ(arr[0], t1.toJson());
+    EXPECT_EQ(arr[1], t2.toJson());
+}
+
+TEST(OutputWriterTest, TsvEscapesSpecialCharacters) {
+    Task t(1, "a\tb\\c");
+    std::string buf;
+    OutputWriter out(buf);
+    TaskPrinter printer(out, OutputFormat::Tsv);
+    printer.print(t);
+    printer.finish();
+    EXPECT_EQ(buf, "id\tdone\tdueDate\tdescription\ttags\n" + std::to_string(t.getId()) +
+                       "\t0\t\ta\\tb\\\\c\t\n");
+}
+
+TEST(OutputWriterTest, ParseOutputFormat) {
+    EXPECT_EQ(parseOutputFormat("json"), OutputFormat::Json);
+    EXPECT_THROW(parseOutputFormat("xml"), std::invalid_argument);
+}
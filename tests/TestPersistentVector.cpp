@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "PersistentVector.hpp"
+#include "TaskManager.hpp"
+#include <random>
+
+TEST(PersistentVectorTest, MatchesStdVectorUnderRandomEdits) {
+    PersistentVector<int> pv;
+    std::vector<int> model;
+    std::mt19937 rng(42);
+    for (int step = 0; step < 5000; ++step) {
+        int op = rng() % 4;
+        if (op < 2 || model.empty()) {
+            std::size_t pos = rng() % (model.size() + 1);
+            pv.insert(pos, step);
+            model.insert(model.begin() + pos, step);
+        } else if (op == 2) {
+            std::size_t pos = rng() % model.size();
+            pv.erase(pos);
+            model.erase(model.begin() + pos);
+        } else {
+            std::size_t pos = rng() % model.size();
+            pv.mutableAt(pos) = -step;
+            model[pos] = -step;
+        }
+    }
+    ASSERT_EQ(pv.size(), model.size());
+    EXPECT_EQ(pv.toVector(), model);
+    for (std::size_t i = 0; i < model.size(); i += 97) {
+        EXPECT_EQ(pv[i], model[i]);
+    }
+}
+
+TEST(PersistentVectorTest, SnapshotIsUnaffectedByLaterWrites) {
+    std::vector<int> base(1000);
+    for (int i = 0; i < 1000; ++i) base[i] = i;
+    PersistentVector<int> pv(base);
+    PersistentVector<int> snap = pv;
+
+    pv.mutableAt(500) = -1;
+    pv.erase(0);
+    pv.push_back(1000);
+
+    EXPECT_EQ(snap.toVector(), base);
+    EXPECT_EQ(pv[499], -1);
+    EXPECT_EQ(pv.size(), 1000u);
+    EXPECT_THROW(pv[1000], std::out_of_range);
+}
+
+TEST(PersistentVectorTest, EmplaceBackConstructsInPlaceAndCopiesSharedChunk) {
+    PersistentVector<std::pair<int, std::string>> pv;
+    for (int i = 0; i < 300; ++i) {
+        auto& item = pv.emplace_back(i, std::to_string(i));
+        EXPECT_EQ(item.first, i);
+    }
+    auto snap = pv;
+    pv.emplace_back(300, "300").second += "!";
+    EXPECT_EQ(pv.size(), 301u);
+    EXPECT_EQ(pv[300].second, "300!");
+    EXPECT_EQ(snap.size(), 300u);
+    EXPECT_EQ(snap[299].second, "299");
+}
+
+TEST(PersistentVectorTest, TaskManagerSnapshot) {
+    TaskManager mgr;
+    TaskId id = mgr.addTask("Frozen");
+    TaskSnapshot snap = mgr.snapshot();
+    mgr.markDone(id);
+    mgr.addTask("Later");
+
+    TaskManager frozen(snap);
+    ASSERT_EQ(frozen.listTasks().size(), 1u);
+    EXPECT_FALSE(frozen.getTask(id).isDone());
+    EXPECT_TRUE(mgr.getTask(id).isDone());
+}
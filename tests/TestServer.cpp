@@ -0,0 +1,256 @@
+#include "gtest/gtest.h"
+#include "Server.hpp"
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+TEST(ProtocolTest, FramesSurviveArbitrarySplits) {
+    std::string stream;
+    protocol::appendRequest({"add", "Buy milk", ""}, stream);
+    protocol::appendResponse(1, "Error: x\n", stream);
+
+    protocol::FrameReader reader;
+    std::vector<std::string> frames;
+    std::string payload;
+    for (char c : stream) {
+        reader.feed(&c, 1);
+        while (reader.next(payload)) {
+            frames.push_back(payload);
+        }
+    }
+    ASSERT_EQ(frames.size(), 2);
+    EXPECT_FALSE(reader.hasPartial());
+    EXPECT_EQ(protocol::decodeRequest(frames[0]),
+              (std::vector<std::string>{"add", "Buy milk", ""}));
+    protocol::Response r = protocol::decodeResponse(frames[1]);
+    EXPECT_EQ(r.status, 1);
+    EXPECT_EQ(r.body, "Error: x\n");
+
+    reader.feed("\xff\xff\xff\xff", 4);
+    EXPECT_THROW(reader.next(payload), std::runtime_error);
+}
+
+TEST(ProtocolTest, LargeResponseSpansSeveralFrames) {
+    std::string body(protocol::kMaxFrameSize * 2 + 123, 'x');
+    body.back() = 'y';
+    std::string stream;
+    protocol::appendResponse(0, body, stream);
+
+    protocol::FrameReader reader;
+    reader.feed(stream.data(), stream.size());
+    protocol::Response pending;
+    std::string payload;
+    int frames = 0;
+    bool complete = false;
+    while (reader.next(payload)) {
+        ++frames;
+        EXPECT_FALSE(complete);
+        complete = protocol::assembleResponse(payload, pending);
+    }
+    EXPECT_TRUE(complete);
+    EXPECT_EQ(frames, 3);
+    EXPECT_EQ(pending.status, 0);
+    EXPECT_EQ(pending.body, body);
+}
+
+TEST(ServerTest, ClientReassemblesResponseLargerThanOneFrame) {
+    const std::string socketPath = "test_serve_big.sock";
+    fs::remove(socketPath);
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, socketPath.c_str());
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(::listen(listener, 1), 0);
+
+    const std::string body(protocol::kMaxFrameSize + 4096, 'z');
+    // Подставной демон: читает один кадр запроса и отвечает выводом больше одного кадра
+    std::thread fake([&] {
+        int conn = ::accept(listener, nullptr, nullptr);
+        protocol::FrameReader reader;
+        std::string payload;
+        char chunk[4096];
+        while (!reader.next(payload)) {
+            ssize_t n = ::read(conn, chunk, sizeof(chunk));
+            if (n <= 0) {
+                break;
+            }
+            reader.feed(chunk, static_cast<std::size_t>(n));
+        }
+        std::string out;
+        protocol::appendResponse(0, body, out);
+        for (std::size_t sent = 0; sent < out.size();) {
+            ssize_t n = ::write(conn, out.data() + sent, out.size() - sent);
+            if (n <= 0) {
+                break;
+            }
+            sent += static_cast<std::size_t>(n);
+        }
+        ::close(conn);
+    });
+
+    {
+        Client client(socketPath);
+        protocol::Response r = client.call({"list"});
+        EXPECT_EQ(r.status, 0);
+        EXPECT_EQ(r.body.size(), body.size());
+        EXPECT_TRUE(r.body == body);
+    }
+    fake.join();
+    ::close(listener);
+    fs::remove(socketPath);
+}
+
+TEST(ServerTest, ClientCommandsRunAgainstResidentState) {
+    const std::string data = "test_serve.json";
+    const std::string socketPath = "test_serve.sock";
+    {
+        Storage storage(data, "json");
+        TaskManager manager;
+        UndoStack undo(data + ".undo");
+        HistoryLog history("test_serve.ndjson");
+        CommandProcessor processor(manager, storage, undo, history,
+                                   Logger::instance("test_server_history.log"));
+        Server server(socketPath, processor);
+        EXPECT_THROW(Server(socketPath, processor), std::runtime_error);
+        std::thread loop([&] { server.run(); });
+
+        {
+            Client client(socketPath);
+            protocol::Response added = client.call({"add", "Resident", "--tags=a"});
+            EXPECT_EQ(added.status, 0);
+            // ID назначается глобальным счётчиком, поэтому берём его из ответа
+            EXPECT_EQ(added.body.rfind("Task added with id ", 0), 0u);
+            std::string id = added.body.size() > 20 ? added.body.substr(19, added.body.size() - 20) : "";
+            EXPECT_EQ(client.call({"list", "--output=tsv"}).body,
+                      "id\tdone\tdueDate\tdescription\ttags\n" + id + "\t0\t\tResident\ta\n");
+            protocol::Response bad = client.call({"remove", "7"});
+            EXPECT_EQ(bad.status, 1);
+            EXPECT_EQ(bad.body.rfind("Error: ", 0), 0u);
+        }
+        {
+            // Второе соединение видит те же задачи; изменения уже сохранены в файл
+            Client other(socketPath);
+            EXPECT_EQ(other.call({"search", "resident"}).status, 0);
+            EXPECT_EQ(Storage(data, "json").load().size(), 1);
+            EXPECT_EQ(other.call({"serve"}).status, 1);
+        }
+        server.stop();
+        loop.join();
+    }
+    EXPECT_FALSE(fs::exists(socketPath));
+    fs::remove(data);
+    fs::remove(data + ".undo");
+    fs::remove("test_serve.ndjson");
+    fs::remove("test_serve.ndjson.idx");
+}
+
+TEST(ServerTest, PipelinedRequestsAnswerInOrderWhileSlowClientStalls) {
+    const std::string data = "test_serve_pipe.json";
+    const std::string socketPath = "test_serve_pipe.sock";
+    {
+        Storage storage(data, "json");
+        TaskManager manager;
+        UndoStack undo(data + ".undo");
+        HistoryLog history("test_serve_pipe.ndjson");
+        CommandProcessor processor(manager, storage, undo, history,
+                                   Logger::instance("test_server_history.log"));
+        Server server(socketPath, processor, 2);
+        std::thread loop([&] { server.run(); });
+
+        Client fast(socketPath);
+        std::vector<std::vector<std::string>> seed(200, {"add", "Seed task with a long description"});
+        fast.pipeline(seed);
+
+        // Клиент, который шлёт много запросов и не читает ответы
+        int slow = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, socketPath.c_str());
+        ASSERT_EQ(::connect(slow, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+        ::fcntl(slow, F_SETFL, O_NONBLOCK);
+        std::string flood;
+        for (int i = 0; i < 20000; ++i) {
+            protocol::appendRequest({"list", "--output=json"}, flood);
+        }
+        std::size_t sent = 0;
+        while (sent < flood.size()) {
+            ssize_t n = ::send(slow, flood.data() + sent, flood.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                break;
+            }
+            sent += static_cast<std::size_t>(n);
+        }
+
+        std::vector<std::vector<std::string>> requests;
+        for (int i = 0; i < 50; ++i) {
+            requests.push_back({"add", "Pipelined " + std::to_string(i)});
+            requests.push_back({"search", "Pipelined " + std::to_string(i)});
+        }
+        auto responses = fast.pipeline(requests);
+        ASSERT_EQ(responses.size(), requests.size());
+        for (std::size_t i = 0; i < responses.size(); i += 2) {
+            EXPECT_EQ(responses[i].status, 0);
+            // search выполняется в пуле, но видит добавленную перед ним задачу
+            EXPECT_NE(responses[i + 1].body.find("Pipelined " + std::to_string(i / 2)),
+                      std::string::npos);
+        }
+        EXPECT_EQ(Storage(data, "json").load().size(), 250);
+        ::close(slow);
+
+        server.stop();
+        loop.join();
+    }
+    fs::remove(data);
+    fs::remove(data + ".undo");
+    fs::remove("test_serve_pipe.ndjson");
+    fs::remove("test_serve_pipe.ndjson.idx");
+}
+
+TEST(ServerTest, FailedSaveRollsBackToDataFile) {
+    const std::string data = "test_serve_fail.json";
+    const std::string socketPath = "test_serve_fail.sock";
+    {
+        Storage storage(data, "json");
+        TaskManager manager;
+        UndoStack undo(data + ".undo");
+        HistoryLog history("test_serve_fail.ndjson");
+        CommandProcessor processor(manager, storage, undo, history,
+                                   Logger::instance("test_server_history.log"));
+        processor.reload();
+        Server server(socketPath, processor);
+        std::thread loop([&] { server.run(); });
+
+        Client client(socketPath);
+        EXPECT_EQ(client.call({"add", "Kept"}).status, 0);
+        // Каталог на месте временного файла: сохранение не удаётся
+        fs::create_directory(data + ".tmp");
+        protocol::Response failed = client.call({"add", "Lost"});
+        EXPECT_EQ(failed.status, 1);
+        EXPECT_NE(failed.body.find("changes discarded"), std::string::npos);
+        fs::remove(data + ".tmp");
+
+        // Отвергнутая задача не видна и не сохраняется следующим изменением
+        EXPECT_EQ(client.call({"search", "Lost"}).body, "");
+        EXPECT_EQ(client.call({"add", "Next"}).status, 0);
+        auto saved = Storage(data, "json").load();
+        ASSERT_EQ(saved.size(), 2u);
+        EXPECT_EQ(saved[0].getDescription(), "Kept");
+        EXPECT_EQ(saved[1].getDescription(), "Next");
+
+        server.stop();
+        loop.join();
+    }
+    fs::remove(data);
+    fs::remove(data + ".lock");
+    fs::remove(data + ".undo");
+    fs::remove("test_serve_fail.ndjson");
+    fs::remove("test_serve_fail.ndjson.idx");
+}
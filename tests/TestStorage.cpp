@@ -1,6 +1,13 @@
 #include "gtest/gtest.h"
 #include "Storage.hpp"
 #include <filesystem>
+#include <fstream>
+#include <set>
+#include <json.hpp>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -9,8 +16,8 @@ TEST(StorageTest, JsonSaveLoad) {
     {
         // Создадим и сохраним 2 задачи
         std::vector<Task> tasks;
-        Task t1("One");
-        Task t2("Two", "2025-12-12");
+        Task t1(1, "One");
+        Task t2(2, "Two", "2025-12-12");
         tasks.push_back(t1);
         tasks.push_back(t2);
 
@@ -38,8 +45,8 @@ TEST(StorageTest, SQLiteSaveLoad) {
     std::string tmpdb = "test_tasks.db";
     {
         std::vector<Task> tasks;
-        Task t1("X");
-        Task t2("Y", "2025-11-11");
+        Task t1(1, "X");
+        Task t2(2, "Y", "2025-11-11");
         tasks.push_back(t1);
         tasks.push_back(t2);
 
@@ -54,3 +61,240 @@ TEST(StorageTest, SQLiteSaveLoad) {
     }
     fs::remove(tmpdb);
 }
+
+TEST(StorageTest, StaleWriterIsRejected) {
+    std::string tmp = "test_stale.json";
+    fs::remove(tmp);
+    Storage first(tmp, "json");
+    Storage second(tmp, "json");
+    first.save({Task(1, "Base")});
+
+    auto a = first.load();
+    auto b = second.load();
+    a.push_back(Task(2, "From first"));
+    first.save(a);
+
+    // second загрузил файл до сохранения first — перезаписать его нельзя
+    b.push_back(Task(2, "From second"));
+    EXPECT_THROW(second.save(b), StaleDataError);
+    EXPECT_TRUE(second.changedOnDisk());
+
+    b = second.load();
+    b.push_back(Task(second.nextId(), "From second"));
+    second.save(b);
+    EXPECT_FALSE(second.changedOnDisk());
+    EXPECT_TRUE(first.changedOnDisk());
+    EXPECT_EQ(first.load().size(), 3u);
+
+    fs::remove(tmp);
+    fs::remove(tmp + ".lock");
+}
+
+TEST(StorageTest, LegacyArrayLoadsAsGenerationZero) {
+    std::string tmp = "test_legacy.json";
+    {
+        std::ofstream ofs(tmp);
+        ofs << R"([{"id": 7, "description": "Old", "done": false}])";
+    }
+    Storage st(tmp, "json");
+    auto loaded = st.load();
+    ASSERT_EQ(loaded.size(), 1u);
+    EXPECT_EQ(loaded[0].getDescription(), "Old");
+    st.save(loaded);
+
+    nlohmann::json doc;
+    std::ifstream(tmp) >> doc;
+    EXPECT_EQ(doc["generation"], 1);
+    EXPECT_EQ(doc["tasks"].size(), 1u);
+
+    fs::remove(tmp);
+    fs::remove(tmp + ".lock");
+}
+
+TEST(StorageTest, ObjectWithoutTasksArrayIsNotLoadedOrOverwritten) {
+    std::string tmp = "test_no_tasks_key.json";
+    const std::string text =
+        R"({"generation":1,"nextId":3,"Tasks":[{"id":1,"description":"Keep","done":false}]})";
+    {
+        std::ofstream ofs(tmp);
+        ofs << text;
+    }
+    Storage st(tmp, "json");
+    EXPECT_THROW(st.load(), std::runtime_error);
+    // После неудачной загрузки сохранение не должно затереть файл
+    std::vector<Task> tasks;
+    tasks.push_back(Task::restore(3, "New", std::nullopt, false, {}));
+    EXPECT_THROW(st.save(tasks, 4), std::runtime_error);
+
+    std::ifstream ifs(tmp);
+    std::string onDisk((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(onDisk, text);
+
+    fs::remove(tmp);
+    fs::remove(tmp + ".lock");
+}
+
+TEST(StorageTest, SQLiteStaleWriterIsRejected) {
+    std::string tmpdb = "test_stale.db";
+    fs::remove(tmpdb);
+    Storage first(tmpdb, "sqlite");
+    Storage second(tmpdb, "sqlite");
+    first.save({Task(1, "Base")});
+
+    auto a = first.load();
+    auto b = second.load();
+    first.save(a);
+    EXPECT_THROW(second.save(b), StaleDataError);
+    EXPECT_EQ(second.load().size(), 1u);
+    second.save(b);
+
+    fs::remove(tmpdb);
+    fs::remove(tmpdb + ".lock");
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+TEST(StorageTest, ConcurrentProcessesDoNotLoseAdds) {
+    std::string tmp = "test_concurrent.json";
+    fs::remove(tmp);
+    constexpr int kProcesses = 4;
+    constexpr int kAddsEach = 20;
+    std::vector<pid_t> children;
+    for (int p = 0; p < kProcesses; ++p) {
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            // Как ToDoManager add: load, добавить, save; при устаревании — заново
+            Storage st(tmp, "json");
+            for (int i = 0; i < kAddsEach; ++i) {
+                while (true) {
+                    auto tasks = st.load();
+                    // Новый ID — от сохранённой границы, как у TaskManager после reload()
+                    tasks.push_back(Task(st.nextId(), "p" + std::to_string(p) + "-"
+                                                          + std::to_string(i)));
+                    try {
+                        st.save(tasks);
+                        break;
+                    } catch (const StaleDataError&) {
+                    }
+                }
+            }
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    Storage st(tmp, "json");
+    auto loaded = st.load();
+    EXPECT_EQ(loaded.size(), static_cast<std::size_t>(kProcesses * kAddsEach));
+    std::set<TaskId> ids;
+    for (const auto& t : loaded) {
+        ids.insert(t.getId());
+    }
+    EXPECT_EQ(ids.size(), loaded.size());
+
+    fs::remove(tmp);
+    fs::remove(tmp + ".lock");
+}
+#endif
+
+TEST(StorageTest, NextIdSurvivesRemovalOfNewestTask) {
+    for (const char* format : {"json", "ndjson", "sqlite"}) {
+        std::string tmp = std::string("test_next_id.") + format;
+        fs::remove(tmp);
+        {
+            Storage st(tmp, format);
+            EXPECT_TRUE(st.load().empty()) << format;
+            EXPECT_EQ(st.nextId(), IdAllocator::kFirstId) << format;
+            // Задача 5 удалена, но ID до 9 уже выдавались
+            st.save({Task(3, "Three"), Task(4, "Four")}, 10);
+        }
+        {
+            Storage st(tmp, format);
+            auto loaded = st.load();
+            ASSERT_EQ(loaded.size(), 2u) << format;
+            EXPECT_EQ(st.nextId(), 10) << format;
+            // Граница не бывает меньше наибольшего ID + 1
+            loaded.push_back(Task(12, "Twelve"));
+            st.save(loaded, st.nextId());
+            EXPECT_EQ(st.nextId(), 13) << format;
+        }
+        Storage st(tmp, format);
+        st.load();
+        EXPECT_EQ(st.nextId(), 13) << format;
+        fs::remove(tmp);
+        fs::remove(tmp + ".lock");
+    }
+}
+
+TEST(StorageTest, NdjsonStoreOneTaskPerLine) {
+    std::string tmp = "test_tasks.ndjson";
+    fs::remove(tmp);
+    Task withTags(1, "Tagged, \"quoted\"", "2025-04-05", {"a", "b"});
+    withTags.markDone();
+    {
+        Storage st(tmp, "ndjson");
+        st.save({withTags, Task(2, "Plain")});
+    }
+    {
+        std::ifstream ifs(tmp);
+        std::string line;
+        std::vector<std::string> lines;
+        while (std::getline(ifs, line)) {
+            lines.push_back(line);
+        }
+        ASSERT_EQ(lines.size(), 3u);
+        EXPECT_EQ(nlohmann::json::parse(lines[0])["generation"], 1);
+        EXPECT_EQ(nlohmann::json::parse(lines[1])["description"], "Tagged, \"quoted\"");
+    }
+    Storage st(tmp, "ndjson");
+    auto loaded = st.load();
+    ASSERT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded[0].getId(), withTags.getId());
+    EXPECT_TRUE(loaded[0].isDone());
+    EXPECT_EQ(loaded[0].getTags(), (Task::TagList{"a", "b"}));
+    EXPECT_EQ(loaded[1].getDescription(), "Plain");
+
+    // Поколение из заголовка участвует в проверке устаревания
+    Storage other(tmp, "ndjson");
+    other.load();
+    st.save(loaded);
+    EXPECT_THROW(other.save(loaded), StaleDataError);
+
+    fs::remove(tmp);
+    fs::remove(tmp + ".lock");
+}
+
+TEST(StorageTest, JsonStoreIsValidDocumentWithOneTaskPerLine) {
+    std::string tmp = "test_tasks_lines.json";
+    fs::remove(tmp);
+    {
+        Storage st(tmp, "json");
+        st.save({Task(1, "First", std::vector<std::string>{"x"}), Task(2, "Second")});
+    }
+    {
+        std::ifstream ifs(tmp);
+        std::string line;
+        std::vector<std::string> lines;
+        while (std::getline(ifs, line)) {
+            lines.push_back(line);
+        }
+        ASSERT_EQ(lines.size(), 4u);
+        EXPECT_EQ(nlohmann::json::parse(lines[1].substr(0, lines[1].size() - 1))["description"], "First");
+        std::ifstream whole(tmp);
+        nlohmann::json doc = nlohmann::json::parse(whole);
+        EXPECT_EQ(doc["generation"], 1);
+        EXPECT_EQ(doc["tasks"].size(), 2u);
+    }
+    Storage st(tmp, "json");
+    auto loaded = st.load();
+    ASSERT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded[0].getTags(), (Task::TagList{"x"}));
+    EXPECT_EQ(loaded[1].getDescription(), "Second");
+    fs::remove(tmp);
+    fs::remove(tmp + ".lock");
+}
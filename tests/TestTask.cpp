@@ -2,27 +2,28 @@
 #include "Task.hpp"
 
 TEST(TaskTest, ConstructorAndGetters) {
-    Task t("Test description");
+    Task t(1, "Test description");
+    EXPECT_EQ(t.getId(), 1);
     EXPECT_EQ(t.getDescription(), "Test description");
     EXPECT_FALSE(t.getDueDate().has_value());
     EXPECT_FALSE(t.isDone());
 }
 
 TEST(TaskTest, MarkDone) {
-    Task t("Do something");
+    Task t(1, "Do something");
     t.markDone();
     EXPECT_TRUE(t.isDone());
 }
 
 TEST(TaskTest, SetDueDate) {
-    Task t("Task with date");
+    Task t(1, "Task with date");
     t.setDueDate("2025-06-10");
     ASSERT_TRUE(t.getDueDate().has_value());
     EXPECT_EQ(t.getDueDate().value(), "2025-06-10");
 }
 
 TEST(TaskTest, TagsManipulation) {
-    Task t("Tag test");
+    Task t(1, "Tag test");
     t.addTag("work");
     t.addTag("urgent");
     ASSERT_EQ(t.getTags().size(), 2);
@@ -32,7 +33,7 @@ TEST(TaskTest, TagsManipulation) {
 }
 
 TEST(TaskTest, JsonSerialization) {
-    Task t("Serialize me", "2025-07-01", {"a","b"});
+    Task t(42, "Serialize me", "2025-07-01", {"a","b"});
     t.markDone();
     auto j = t.toJson();
     EXPECT_EQ(j["description"], "Serialize me");
@@ -42,6 +43,7 @@ TEST(TaskTest, JsonSerialization) {
     EXPECT_EQ(j["tags"].size(), 2);
 
     Task t2 = Task::fromJson(j);
+    EXPECT_EQ(t2.getId(), 42);
     EXPECT_EQ(t2.getDescription(), "Serialize me");
     EXPECT_EQ(t2.getDueDate().value(), "2025-07-01");
     EXPECT_TRUE(t2.isDone());
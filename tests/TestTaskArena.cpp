@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+#include "TaskArena.hpp"
+#include "TaskImporter.hpp"
+#include <sstream>
+
+namespace {
+
+// Ресурс, считающий выделения; ставится ресурсом по умолчанию на время теста
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::size_t allocations = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Длинные строки, чтобы не поместиться в короткий буфер std::string
+std::string ndjsonTasks(int count) {
+    std::string data;
+    for (int i = 1; i <= count; ++i) {
+        data += "{\"id\":" + std::to_string(i) + ",\"description\":\"description of task number "
+                + std::to_string(i) + "\",\"done\":false,\"dueDate\":\"2025-06-01\","
+                + "\"tags\":[\"a-rather-long-tag-name\"]}\n";
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(TaskArenaTest, LoadedStringsComeFromArenaNotDefaultResource) {
+    CountingResource counting;
+    std::pmr::memory_resource* previous = std::pmr::set_default_resource(&counting);
+    {
+        std::istringstream in(ndjsonTasks(100));
+        auto tasks = TaskImporter::read(in, "ndjson", nullptr);
+        ASSERT_EQ(tasks.size(), 100u);
+        // Без арены каждая задача выделяет описание, вектор тегов и тег (дата — в коротком буфере)
+        EXPECT_GE(counting.allocations, 300u);
+    }
+    counting.allocations = 0;
+    {
+        TaskArena arena(std::pmr::new_delete_resource());
+        std::istringstream in(ndjsonTasks(100));
+        auto tasks = TaskImporter::read(in, "ndjson", nullptr, 0, &arena);
+        ASSERT_EQ(tasks.size(), 100u);
+        EXPECT_EQ(counting.allocations, 0u);
+        EXPECT_NE(tasks[0].get_allocator().resource(), &counting);
+        EXPECT_EQ(tasks[99].getDescription(), "description of task number 100");
+        EXPECT_EQ(tasks[99].getTags(), (Task::TagList{"a-rather-long-tag-name"}));
+
+        // Копия уходит в ресурс по умолчанию, перемещение остаётся в арене
+        Task copy = tasks[0];
+        EXPECT_EQ(copy.get_allocator().resource(), &counting);
+        Task moved = std::move(tasks[1]);
+        EXPECT_EQ(moved.get_allocator().resource(), tasks[0].get_allocator().resource());
+    }
+    std::pmr::set_default_resource(previous);
+}
+
+TEST(TaskArenaTest, AllocatorExtendedCopyUsesGivenResource) {
+    TaskArena arena;
+    std::pmr::memory_resource* resource = arena.resource();
+    Task original = Task::restore(7, "a description that is long enough", std::string("2025-01-02"),
+                                  true, {"first-long-tag-name", "second-long-tag-name"});
+    Task copy(original, resource);
+    EXPECT_EQ(copy.get_allocator().resource(), resource);
+    EXPECT_EQ(copy.getTags().get_allocator().resource(), resource);
+    EXPECT_EQ(copy.getTags()[1].get_allocator().resource(), resource);
+    EXPECT_EQ(copy.getId(), 7);
+    EXPECT_EQ(copy.getDescription(), original.getDescription());
+    EXPECT_EQ(copy.getDueDate(), original.getDueDate());
+    EXPECT_TRUE(copy.isDone());
+    EXPECT_EQ(copy.getTags(), original.getTags());
+    // Изменения берут память из того же ресурса
+    copy.setDueDate("2026-12-31");
+    copy.addTag("third-long-tag-name-added");
+    EXPECT_EQ(copy.getTags().back().get_allocator().resource(), resource);
+}
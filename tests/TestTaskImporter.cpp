@@ -0,0 +1,258 @@
+#include "gtest/gtest.h"
+#include "TaskImporter.hpp"
+#include "TaskManager.hpp"
+#include <filesystem>
+#include <json.hpp>
+#include <fstream>
+#include <set>
+#include <optional>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Описание задачи из одной записи NDJSON по разбору импорта; nullopt — ошибка разбора
+std::optional<std::string> importedDescription(const std::string& line) {
+    std::istringstream in(line + "\n");
+    try {
+        auto tasks = TaskImporter::read(in, "ndjson", nullptr);
+        return tasks.empty() ? std::string() : std::string(tasks[0].getDescription());
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+}
+
+// То же по разбору nlohmann::json — эталон для разборщика импорта
+std::optional<std::string> referenceDescription(const std::string& line) {
+    if (!nlohmann::json::accept(line)) {
+        return std::nullopt;
+    }
+    return nlohmann::json::parse(line).at("description").get<std::string>();
+}
+
+} // namespace
+
+TEST(TaskImporterTest, CsvFromExportKeepsFields) {
+    std::istringstream in("id,description,dueDate,done,tags\n"
+                          "10,\"Buy milk, eggs\",2025-06-01,1,home;shop\n"
+                          "11,\"Call \"\"Bob\"\"\",,0,\n");
+    auto tasks = TaskImporter::read(in, "csv", nullptr);
+    ASSERT_EQ(tasks.size(), 2u);
+    EXPECT_EQ(tasks[0].getId(), 10);
+    EXPECT_EQ(tasks[0].getDescription(), "Buy milk, eggs");
+    EXPECT_EQ(tasks[0].getDueDate(), std::optional<Task::String>("2025-06-01"));
+    EXPECT_TRUE(tasks[0].isDone());
+    EXPECT_EQ(tasks[0].getTags(), (Task::TagList{"home", "shop"}));
+    EXPECT_EQ(tasks[1].getDescription(), "Call \"Bob\"");
+    EXPECT_FALSE(tasks[1].getDueDate().has_value());
+    EXPECT_TRUE(tasks[1].getTags().empty());
+}
+
+TEST(TaskImporterTest, CsvWithoutKeepIdsAssignsFreshIds) {
+    std::istringstream in("description,done\nFirst,0\nSecond,true\n");
+    IdAllocator ids(100);
+    auto tasks = TaskImporter::read(in, "csv", &ids);
+    ASSERT_EQ(tasks.size(), 2u);
+    EXPECT_EQ(tasks[0].getId(), 100);
+    EXPECT_EQ(tasks[1].getId(), 101);
+    EXPECT_EQ(ids.next(), 102);
+    EXPECT_TRUE(tasks[1].isDone());
+}
+
+TEST(TaskImporterTest, CsvReportsLineOfBadRow) {
+    std::istringstream in("description,done\nok,0\nbad,maybe\n");
+    try {
+        IdAllocator ids;
+        TaskImporter::read(in, "csv", &ids);
+        FAIL() << "expected an error";
+    } catch (const std::runtime_error& ex) {
+        EXPECT_NE(std::string(ex.what()).find("line 3"), std::string::npos);
+    }
+}
+
+TEST(TaskImporterTest, JsonArrayAndStoreObject) {
+    std::istringstream arr(R"([{"id": 5, "description": "A", "done": false, "tags": ["x", "y"],
+                                 "extra": {"nested": [1, 2]}},
+                                {"id": 6, "description": "B", "done": true, "dueDate": "2025-01-02"}])");
+    auto tasks = TaskImporter::read(arr, "json", nullptr);
+    ASSERT_EQ(tasks.size(), 2u);
+    EXPECT_EQ(tasks[0].getTags(), (Task::TagList{"x", "y"}));
+    EXPECT_EQ(tasks[1].getId(), 6);
+    EXPECT_TRUE(tasks[1].isDone());
+    EXPECT_EQ(tasks[1].getDueDate(), std::optional<Task::String>("2025-01-02"));
+
+    std::istringstream store(R"({"generation": 3, "tasks": [{"id": 1, "description": "S", "done": false}]})");
+    auto stored = TaskImporter::read(store, "json", nullptr);
+    ASSERT_EQ(stored.size(), 1u);
+    EXPECT_EQ(stored[0].getDescription(), "S");
+}
+
+TEST(TaskImporterTest, NdjsonSkipsBlankLinesAndReportsErrors) {
+    std::istringstream in("{\"id\": 1, \"description\": \"one\", \"done\": false}\n"
+                          "\n"
+                          "{\"id\": 2, \"description\": \"two\", \"done\": true, \"tags\": [\"t\"]}\n");
+    auto tasks = TaskImporter::read(in, "ndjson", nullptr);
+    ASSERT_EQ(tasks.size(), 2u);
+    EXPECT_EQ(tasks[1].getTags(), (Task::TagList{"t"}));
+
+    std::istringstream bad("{\"id\": 1, \"description\": \"one\", \"done\": false}\n{oops\n");
+    EXPECT_THROW(TaskImporter::read(bad, "ndjson", nullptr), std::runtime_error);
+}
+
+TEST(TaskImporterTest, NdjsonReaderDecodesStringsAndRejectsMalformedRecords) {
+    std::istringstream in(
+        "{\"id\": 9007199254740993, \"description\": \"caf\\u00e9 \\ud83d\\ude00 \\\"q\\\"\\n\","
+        " \"done\": 1, \"score\": -1.5e3, \"extra\": {\"nested\": [null, true, []]},"
+        " \"tags\": [\"\xc3\xa9t\xc3\xa9\"]}\n");
+    auto tasks = TaskImporter::read(in, "ndjson", nullptr);
+    ASSERT_EQ(tasks.size(), 1u);
+    EXPECT_EQ(tasks[0].getId(), TaskId{9007199254740993});
+    EXPECT_EQ(tasks[0].getDescription(), "caf\xc3\xa9 \xf0\x9f\x98\x80 \"q\"\n");
+    EXPECT_TRUE(tasks[0].isDone());
+    EXPECT_EQ(tasks[0].getTags(), (Task::TagList{"\xc3\xa9t\xc3\xa9"}));
+
+    // Каждая строка — отдельная ошибка разбора с номером строки
+    for (const char* bad : {"{\"id\": 1, \"description\": \"a\"} {}",
+                            "{\"id\": 1, \"description\": \"a\xff\"}",
+                            "{\"id\": 1, \"description\": \"\\ud83d\"}",
+                            "{\"id\": 1, \"description\": \"open}",
+                            "{\"id\": 01, \"description\": \"a\"}",
+                            "{\"id\": 1, \"description\": \"a\",}"}) {
+        std::istringstream record(std::string("\n") + bad + "\n");
+        try {
+            TaskImporter::read(record, "ndjson", nullptr);
+            ADD_FAILURE() << "expected an error for " << bad;
+        } catch (const std::runtime_error& ex) {
+            EXPECT_NE(std::string(ex.what()).find("line 2"), std::string::npos) << ex.what();
+        }
+    }
+}
+
+TEST(TaskImporterTest, RoundTripThroughExport) {
+    TaskManager source;
+    source.addTask("with, comma", std::string("2025-03-04"), {"a", "b"});
+    source.addTask("plain");
+    for (const char* format : {"csv", "json"}) {
+        std::string path = std::string("test_import_roundtrip.") + format;
+        source.exportAll(format, path);
+        auto tasks = TaskImporter::readFile(path, TaskImporter::formatFromPath(path), nullptr);
+        ASSERT_EQ(tasks.size(), 2u) << format;
+        EXPECT_EQ(tasks[0].getDescription(), "with, comma") << format;
+        EXPECT_EQ(tasks[0].getTags(), (Task::TagList{"a", "b"})) << format;
+        EXPECT_EQ(tasks[1].getId(), source.getAllTasks()[1].getId()) << format;
+        fs::remove(path);
+    }
+}
+
+TEST(TaskImporterTest, ParallelLoadMatchesFileOrderAndReportsLines) {
+    // ~3 МиБ, чтобы loadFile поделил файл на несколько кусков
+    const int count = 40000;
+    std::string pad(60, 'x');
+    std::string ndjsonPath = "test_parallel_load.ndjson";
+    std::string jsonPath = "test_parallel_load.json";
+    {
+        std::ofstream nd(ndjsonPath);
+        std::ofstream js(jsonPath);
+        nd << "{\"generation\": 7}\n";
+        js << "{\n    \"generation\": 7,\n    \"tasks\": [\n";
+        for (int i = 1; i <= count; ++i) {
+            std::string desc = "task {" + std::to_string(i) + "} \\\"q\\\" " + pad;
+            nd << "{\"id\": " << i << ", \"description\": \"" << desc << "\", \"done\": "
+               << (i % 2 ? "true" : "false") << "}\n";
+            js << "        {\n            \"id\": " << i << ",\n            \"description\": \"" << desc
+               << "\",\n            \"done\": false\n        }" << (i < count ? ",\n" : "\n");
+        }
+        js << "    ]\n}\n";
+    }
+    for (const auto& [path, format] : {std::pair<std::string, std::string>{ndjsonPath, "ndjson"},
+                                       {jsonPath, "json"}}) {
+        auto tasks = TaskImporter::loadFile(path, format, 4);
+        ASSERT_EQ(tasks.size(), static_cast<std::size_t>(count)) << format;
+        for (int i = 0; i < count; ++i) {
+            ASSERT_EQ(tasks[i].getId(), i + 1) << format;
+        }
+        EXPECT_EQ(tasks[count - 1].getDescription(), std::string_view("task {40000} \"q\" " + pad)) << format;
+
+        // Без ID из файла каждый поток берёт ID своим блоком: все новые и разные
+        IdAllocator ids(count + 1);
+        auto fresh = TaskImporter::loadFile(path, format, 4, nullptr, &ids);
+        ASSERT_EQ(fresh.size(), static_cast<std::size_t>(count)) << format;
+        std::set<TaskId> seen;
+        for (const auto& t : fresh) {
+            EXPECT_GT(t.getId(), count);
+            seen.insert(t.getId());
+        }
+        EXPECT_EQ(seen.size(), fresh.size()) << format;
+        EXPECT_EQ(fresh[count - 1].getDescription(), tasks[count - 1].getDescription()) << format;
+    }
+
+    // Ошибка в последнем куске сообщает номер строки во всём файле
+    {
+        std::ofstream nd(ndjsonPath, std::ios::app);
+        nd << "{\"id\": 1, \"done\": false}\n";
+    }
+    try {
+        TaskImporter::loadFile(ndjsonPath, "ndjson", 4);
+        FAIL() << "expected an error";
+    } catch (const std::runtime_error& ex) {
+        EXPECT_NE(std::string(ex.what()).find("line " + std::to_string(count + 2)), std::string::npos)
+            << ex.what();
+    }
+    fs::remove(ndjsonPath);
+    fs::remove(jsonPath);
+}
+
+TEST(TaskImporterTest, RecordParserAgreesWithNlohmannOnStrings) {
+    const std::vector<std::string> strings = {
+        // Допустимые строки
+        "\"plain\"", "\"\"", "\"\\u00e9\\u20AC\"", "\"\\ud83d\\ude00\"", "\"\\/\\b\\f\\n\\r\\t\\\\\\\"\"",
+        "\"\\u0000\"", "\"\x7f\"", "\"\xc3\xa9\"", "\"\xe2\x82\xac\"", "\"\xef\xbf\xbf\"",
+        "\"\xf0\x9f\x98\x80\"", "\"\xf4\x8f\xbf\xbf\"",
+        // Одиночные суррогаты и неверное экранирование
+        "\"\\ud800\"", "\"\\udc00\"", "\"\\ud800\\u0041\"", "\"\\ud800x\"", "\"\\udbff\\udbff\"",
+        "\"\\x\"", "\"\\u12g4\"", "\"\\u12\"", "\"\\U0041\"", "\"\\\"",
+        // Управляющие символы
+        "\"\x01\"", "\"\x1f\"", "\"a\tb\"",
+        // Неверный UTF-8: продолжение без начала, overlong, суррогат в UTF-8, за пределами U+10FFFF,
+        // оборванная последовательность
+        "\"\x80\"", "\"\xbf\"", "\"\xc0\x80\"", "\"\xc1\xbf\"", "\"\xe0\x80\x80\"", "\"\xe0\x9f\xbf\"",
+        "\"\xed\xa0\x80\"", "\"\xf0\x80\x80\x80\"", "\"\xf0\x8f\xbf\xbf\"", "\"\xf4\x90\x80\x80\"",
+        "\"\xf5\x80\x80\x80\"", "\"\xff\"", "\"\xc3\"", "\"\xe2\x82\"", "\"\xc3\x28\"",
+    };
+    for (const auto& value : strings) {
+        std::string line = "{\"id\":1,\"description\":" + value + "}";
+        EXPECT_EQ(importedDescription(line), referenceDescription(line)) << line;
+    }
+}
+
+TEST(TaskImporterTest, RecordParserAgreesWithNlohmannOnValues) {
+    const std::vector<std::string> values = {
+        "0", "-0", "01", "-", "1.", ".5", "1e", "1e+", "1E+2", "-1.5e-3", "+1", "0x1", "NaN",
+        "18446744073709551616", "-9223372036854775809", "true", "tru", "null", "nulll", "false",
+        "[]", "[1,]", "[,1]", "[1 2]", "{}", "{\"a\"}", "{\"a\":1,}", "{\"a\" 1}", "{1:2}",
+        "[[[{\"b\":[null]}]]]", "\"a\" \"b\"", " \t\r1", "\f1", "1 2",
+    };
+    for (const auto& value : values) {
+        std::string line = "{\"id\":1,\"description\":\"ok\",\"x\":" + value + "}";
+        EXPECT_EQ(importedDescription(line), referenceDescription(line)) << line;
+    }
+    for (const std::string& line : {std::string("{\"id\":1,\"description\":\"ok\"} x"),
+                                    std::string("{\"id\":1,\"description\":\"ok\"},"),
+                                    std::string("{\"id\":1,\"description\":\"ok\""),
+                                    std::string(" {\"id\":1,\"description\":\"ok\"}\r")}) {
+        EXPECT_EQ(importedDescription(line), referenceDescription(line)) << line;
+    }
+}
+
+TEST(TaskImporterTest, RecordParserLimitsNestingDepth) {
+    auto nested = [](std::size_t depth) {
+        return "{\"id\":1,\"description\":\"ok\",\"x\":" + std::string(depth, '[')
+               + std::string(depth, ']') + "}";
+    };
+    // В пределах предела — как nlohmann
+    std::string shallow = nested(500);
+    EXPECT_EQ(importedDescription(shallow), referenceDescription(shallow));
+    // Глубже — ошибка разбора, а не переполнение стека (nlohmann такую запись принимает)
+    EXPECT_EQ(importedDescription(nested(100000)), std::nullopt);
+}
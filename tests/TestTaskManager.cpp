@@ -1,5 +1,8 @@
 #include "gtest/gtest.h"
 #include "TaskManager.hpp"
+#include "Csv.hpp"
+#include <cstdio>
+#include <fstream>
 
 TEST(TaskManagerTest, AddAndList) {
     TaskManager mgr;
@@ -55,7 +58,7 @@ TEST(TaskManagerTest, UpdateDueDate) {
 
 TEST(TaskManagerTest, TagsOperations) {
     TaskManager mgr;
-    int id = mgr.addTask("Tag test");
+    TaskId id = mgr.addTask("Tag test");
     mgr.addTag(id, "home");
     mgr.addTag(id, "work");
     auto all = mgr.listTasks();
@@ -64,3 +67,197 @@ TEST(TaskManagerTest, TagsOperations) {
     auto all2 = mgr.listTasks();
     EXPECT_EQ(all2[0].getTags().size(), 1);
 }
+
+TEST(TaskManagerTest, CsvExportFiltersAndEscapes) {
+    TaskManager mgr;
+    TaskId tricky = mgr.addTask("Call \"Bob\"; then\nwrite", std::string("2025-02-03"), {"work", "x"});
+    TaskId other = mgr.addTask("Buy milk", std::nullopt, {"home"});
+    mgr.addTask("Pay bills", std::nullopt, {"work"});
+    mgr.markDone(other);
+
+    ExportOptions options;
+    options.delimiter = ';';
+    options.tag = "work";
+    options.search = "CALL";
+    std::string path = "test_export_filtered.csv";
+    mgr.exportAll("csv", path, options);
+
+    std::ifstream in(path, std::ios::binary);
+    CsvReader reader(in, ';');
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"id", "description", "dueDate", "done", "tags"}));
+    ASSERT_TRUE(reader.next(row));
+    EXPECT_EQ(row, (std::vector<std::string>{std::to_string(tricky), "Call \"Bob\"; then\nwrite",
+                                             "2025-02-03", "0", "work;x"}));
+    EXPECT_FALSE(reader.next(row));
+    in.close();
+
+    ExportOptions doneOnly;
+    doneOnly.done = true;
+    mgr.exportAll("json", path, doneOnly);
+    nlohmann::json arr;
+    std::ifstream(path) >> arr;
+    ASSERT_EQ(arr.size(), 1u);
+    EXPECT_EQ(arr[0]["id"], other);
+    std::remove(path.c_str());
+}
+
+TEST(TaskManagerTest, OverdueAndFiltersFollowChanges) {
+    TaskManager mgr;
+    TaskId late = mgr.addTask("Late", "2025-03-01");
+    TaskId future = mgr.addTask("Future", "2025-03-20");
+    TaskId doneLate = mgr.addTask("Done late", "2025-02-01");
+    mgr.addTask("No date");
+    // Фильтры дальше идут по таблице, а изменения обновляют её столбцы
+    mgr.table();
+    mgr.markDone(doneLate);
+    auto overdue = mgr.listOverdue("2025-03-10");
+    ASSERT_EQ(overdue.size(), 1u);
+    EXPECT_EQ(overdue[0].getId(), late);
+    EXPECT_THROW(mgr.listOverdue("10.03.2025"), std::invalid_argument);
+
+    // Изменения после первого фильтра обновляют столбцы
+    mgr.updateDueDate(future, "2025-03-05");
+    mgr.markDone(late);
+    TaskId added = mgr.addTask("Added late", "2024-12-31");
+    overdue = mgr.listOverdue("2025-03-10");
+    ASSERT_EQ(overdue.size(), 2u);
+    EXPECT_EQ(overdue[0].getId(), future);
+    EXPECT_EQ(overdue[1].getId(), added);
+    mgr.removeTask(future);
+    EXPECT_EQ(mgr.listOverdue("2025-03-10").size(), 1u);
+    EXPECT_EQ(mgr.listTasks(true).size(), 2u);
+
+    // Копия разделяет таблицу; изменение оригинала её не трогает
+    TaskManager view = mgr;
+    mgr.markDone(added);
+    EXPECT_EQ(view.listOverdue("2025-03-10").size(), 1u);
+    EXPECT_TRUE(mgr.listOverdue("2025-03-10").empty());
+}
+
+TEST(TaskManagerTest, ScanWithoutTableMatchesTableFilters) {
+    TaskManager scanned;
+    scanned.addTask("Write REPORT", std::string("2025-01-10"), {"work"});
+    scanned.addTask("Read report", std::string("2025-04-01"), {"home"});
+    scanned.addTask("Pay rent", std::string("bad date"), {"home", "work"});
+    TaskId done = scanned.addTask("Report done", std::string("2025-01-01"));
+    scanned.markDone(done);
+
+    // Копия строит таблицу, оригинал фильтрует проходом по задачам
+    TaskManager indexed = scanned;
+    indexed.table();
+    auto ids = [](const std::vector<Task>& tasks) {
+        std::vector<TaskId> out;
+        for (const auto& t : tasks) {
+            out.push_back(t.getId());
+        }
+        return out;
+    };
+    EXPECT_EQ(ids(scanned.listTasks(false)), ids(indexed.listTasks(false)));
+    EXPECT_EQ(ids(scanned.listTasks(true)), ids(indexed.listTasks(true)));
+    EXPECT_EQ(ids(scanned.searchByDescription("rEpOrT")), ids(indexed.searchByDescription("rEpOrT")));
+    EXPECT_EQ(scanned.searchByDescription("report").size(), 3u);
+    EXPECT_EQ(ids(scanned.listOverdue("2025-03-01")), ids(indexed.listOverdue("2025-03-01")));
+    EXPECT_EQ(scanned.listOverdue("2025-03-01").size(), 1u);
+
+    ExportOptions options;
+    options.done = false;
+    options.tag = "work";
+    options.search = "a";
+    scanned.exportAll("ndjson", "test_scan_export.ndjson", options);
+    indexed.exportAll("ndjson", "test_scan_export_table.ndjson", options);
+    auto read = [](const std::string& path) {
+        std::ifstream in(path);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    };
+    EXPECT_EQ(read("test_scan_export.ndjson"), read("test_scan_export_table.ndjson"));
+    EXPECT_NE(read("test_scan_export.ndjson").find("Pay rent"), std::string::npos);
+    std::remove("test_scan_export.ndjson");
+    std::remove("test_scan_export_table.ndjson");
+}
+
+TEST(TaskManagerTest, AdoptsTableBuiltByUnchangedCopy) {
+    TaskManager mgr;
+    mgr.addTask("Alpha");
+    mgr.addTask("Beta");
+
+    // Копия (как в пуле демона) строит таблицу, оригинал её забирает
+    TaskManager view = mgr;
+    EXPECT_FALSE(mgr.adoptTable(view));
+    view.table();
+    EXPECT_TRUE(mgr.adoptTable(view));
+    EXPECT_EQ(&mgr.table(), &view.table());
+
+    // Если список изменился после копирования, таблица копии ему не подходит
+    TaskManager changed;
+    changed.addTask("Gamma");
+    TaskManager copy = changed;
+    changed.addTask("Delta");
+    copy.table();
+    EXPECT_FALSE(changed.adoptTable(copy));
+    EXPECT_EQ(changed.searchByDescription("delta").size(), 1u);
+}
+
+TEST(TaskManagerTest, MoveOverloadsKeepTaskStrings) {
+    // Описания длиннее короткого буфера строки: при перемещении буфер не меняется
+    std::vector<Task> tasks;
+    tasks.push_back(Task::restore(1, "first task with a long enough description", std::nullopt,
+                                  false, {"long-enough-tag-name-here"}));
+    tasks.push_back(Task::restore(2, "second task with a long enough description",
+                                  std::string("2025-01-01"), true, {}));
+    const char* firstDesc = tasks[0].getDescription().data();
+    const char* firstTag = tasks[0].getTags()[0].data();
+
+    TaskManager mgr;
+    mgr.setAllTasks(std::move(tasks));
+    EXPECT_EQ(mgr.getTask(1).getDescription().data(), firstDesc);
+    EXPECT_EQ(mgr.getTask(1).getTags()[0].data(), firstTag);
+
+    Task replacement = Task::restore(2, "replacement with a long enough description", std::nullopt,
+                                     false, {});
+    const char* replacementDesc = replacement.getDescription().data();
+    mgr.replaceTask(std::move(replacement));
+    EXPECT_EQ(mgr.getTask(2).getDescription().data(), replacementDesc);
+    EXPECT_FALSE(mgr.getTask(2).isDone());
+
+    Task inserted = Task::restore(3, "inserted with a long enough description", std::nullopt,
+                                  false, {});
+    const char* insertedDesc = inserted.getDescription().data();
+    mgr.insertTask(0, std::move(inserted));
+    EXPECT_EQ(mgr.indexOf(3), 0u);
+    EXPECT_EQ(mgr.getTask(3).getDescription().data(), insertedDesc);
+}
+
+TEST(TaskManagerTest, EmplaceTaskTakesStringsWithoutCopy) {
+    TaskManager mgr;
+    mgr.listTasks(false); // таблица фильтров строится и дальше обновляется на месте
+    Task::String desc("emplaced task with a long enough description");
+    const char* descData = desc.data();
+    TaskId id = mgr.emplaceTask(std::in_place, std::move(desc), std::optional<Task::String>("2025-02-03"),
+                             Task::TagList{"work"});
+    const Task& t = mgr.getTask(id);
+    EXPECT_EQ(t.getDescription().data(), descData);
+    EXPECT_EQ(t.getDueDate(), std::optional<Task::String>("2025-02-03"));
+    EXPECT_EQ(t.getTags(), (Task::TagList{"work"}));
+    EXPECT_EQ(mgr.listTasks(false).size(), 1u);
+    EXPECT_EQ(mgr.listOverdue("2025-03-01").size(), 1u);
+}
+
+TEST(TaskManagerTest, LoadedTasksDoNotConsumeIds) {
+    TaskManager mgr;
+    nlohmann::json j = Task::restore(7, "Seven", std::nullopt, false, {}).toJson();
+    EXPECT_EQ(Task::fromJson(j).getId(), 7);
+    EXPECT_EQ(mgr.ids().next(), IdAllocator::kFirstId);
+
+    mgr.setAllTasks({Task::restore(3, "Three", std::nullopt, false, {}), Task::fromJson(j)});
+    EXPECT_EQ(mgr.addTask("Next"), 8);
+    mgr.insertTask(0, Task::restore(20, "Undone removal", std::nullopt, false, {}));
+    EXPECT_EQ(mgr.addTask("After undo"), 21);
+
+    // Копии разделяют генератор: ID не повторяются между ними
+    TaskManager copy = mgr;
+    EXPECT_EQ(copy.addTask("In copy"), 22);
+    EXPECT_EQ(mgr.addTask("In original"), 23);
+    EXPECT_EQ(TaskManager(mgr.snapshot()).ids().next(), 24);
+}
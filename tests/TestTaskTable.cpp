@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+#include "TaskTable.hpp"
+
+namespace {
+
+std::vector<std::size_t> rowsOf(const TaskTable::Selection& rows) {
+    std::vector<std::size_t> out;
+    TaskTable::forEach(rows, [&](std::size_t row) { out.push_back(row); });
+    return out;
+}
+
+// 150 задач (три слова битовой карты): каждая третья выполнена, у чётных есть дата
+PersistentVector<Task> sample() {
+    std::vector<Task> tasks;
+    for (int i = 0; i < 150; ++i) {
+        std::optional<std::string> due;
+        if (i % 2 == 0) {
+            due = i < 100 ? "2025-01-15" : "2025-12-15";
+        }
+        std::vector<std::string> tags;
+        if (i % 10 == 0) {
+            tags = {"ten", i % 20 == 0 ? "twenty" : "odd-ten"};
+        }
+        tasks.push_back(Task::restore(i + 1, "Task " + std::to_string(i) + (i == 149 ? " LAST" : ""),
+                                      due, i % 3 == 0, tags));
+    }
+    return PersistentVector<Task>(std::move(tasks));
+}
+
+} // namespace
+
+TEST(TaskTableTest, DoneAndOverdueFilters) {
+    TaskTable table(sample());
+    ASSERT_EQ(table.size(), 150u);
+    EXPECT_EQ(rowsOf(table.all()).size(), 150u);
+
+    auto done = table.all();
+    table.keepDone(done, true);
+    EXPECT_EQ(rowsOf(done).size(), 50u);
+    auto pending = table.all();
+    table.keepDone(pending, false);
+    EXPECT_EQ(rowsOf(pending).size(), 100u);
+
+    auto overdue = table.all();
+    table.keepOverdue(overdue, *TaskTable::parseDate("2025-06-01"));
+    // Чётные строки до 100 с датой 2025-01-15, кроме кратных трём (выполнены)
+    std::vector<std::size_t> expected;
+    for (std::size_t i = 0; i < 100; i += 2) {
+        if (i % 3 != 0) {
+            expected.push_back(i);
+        }
+    }
+    EXPECT_EQ(rowsOf(overdue), expected);
+
+    table.setDone(2, true);
+    table.setDueDate(1, "2024-01-01");
+    overdue = table.all();
+    table.keepOverdue(overdue, *TaskTable::parseDate("2025-06-01"));
+    EXPECT_EQ(rowsOf(overdue)[0], 1u);
+    EXPECT_EQ(rowsOf(overdue)[1], 4u);
+}
+
+TEST(TaskTableTest, TagAndSearchFilters) {
+    TaskTable table(sample());
+    auto tagged = table.all();
+    table.keepTag(tagged, "twenty");
+    EXPECT_EQ(rowsOf(tagged), (std::vector<std::size_t>{0, 20, 40, 60, 80, 100, 120, 140}));
+    auto none = table.all();
+    table.keepTag(none, "missing");
+    EXPECT_TRUE(rowsOf(none).empty());
+
+    auto found = table.all();
+    table.keepMatching(found, "task 14");
+    EXPECT_EQ(rowsOf(found), (std::vector<std::size_t>{14, 140, 141, 142, 143, 144, 145, 146, 147, 148, 149}));
+    auto last = table.all();
+    table.keepMatching(last, "last");
+    EXPECT_EQ(rowsOf(last), (std::vector<std::size_t>{149}));
+    // "1Task" есть только на стыке двух описаний — это не совпадение
+    auto across = table.all();
+    table.keepMatching(across, "1task");
+    EXPECT_TRUE(rowsOf(across).empty());
+
+    table.append(Task::restore(1000, "appended task", std::nullopt, false, {"twenty"}));
+    EXPECT_EQ(table.find(1000), std::optional<std::size_t>(150));
+    EXPECT_EQ(table.find(5000), std::nullopt);
+    tagged = table.all();
+    table.keepTag(tagged, "twenty");
+    EXPECT_EQ(rowsOf(tagged).back(), 150u);
+}
+
+TEST(TaskTableTest, ParseDate) {
+    EXPECT_EQ(TaskTable::parseDate("1970-01-01"), std::optional<std::int32_t>(0));
+    EXPECT_EQ(TaskTable::parseDate("2000-03-01"), std::optional<std::int32_t>(11017));
+    EXPECT_EQ(TaskTable::parseDate("2025-1-01"), std::nullopt);
+    EXPECT_EQ(TaskTable::parseDate("2025-13-01"), std::nullopt);
+}
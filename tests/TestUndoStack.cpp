@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+#include "UndoStack.hpp"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+TEST(UndoStackTest, UndoRedoAdd) {
+    TaskManager mgr;
+    UndoStack undo;
+    TaskId id = mgr.addTask("Added");
+    undo.push(UndoAction::added(mgr.getTask(id), mgr.indexOf(id)));
+
+    undo.undo(mgr);
+    EXPECT_TRUE(mgr.listTasks().empty());
+    EXPECT_FALSE(undo.canUndo());
+    ASSERT_TRUE(undo.canRedo());
+
+    undo.redo(mgr);
+    ASSERT_EQ(mgr.listTasks().size(), 1);
+    EXPECT_EQ(mgr.listTasks()[0].getId(), id);
+}
+
+TEST(UndoStackTest, UndoRemoveRestoresPosition) {
+    TaskManager mgr;
+    UndoStack undo;
+    TaskId a = mgr.addTask("A");
+    TaskId b = mgr.addTask("B");
+    TaskId c = mgr.addTask("C");
+    std::size_t idx = mgr.indexOf(b);
+    undo.push(UndoAction::removed(mgr.getTask(b), idx));
+    mgr.removeTask(b);
+
+    undo.undo(mgr);
+    auto all = mgr.listTasks();
+    ASSERT_EQ(all.size(), 3);
+    EXPECT_EQ(all[0].getId(), a);
+    EXPECT_EQ(all[1].getId(), b);
+    EXPECT_EQ(all[2].getId(), c);
+}
+
+TEST(UndoStackTest, UndoUpdateRestoresFields) {
+    TaskManager mgr;
+    UndoStack undo;
+    TaskId id = mgr.addTask("Task", "2025-01-01");
+    Task before = mgr.getTask(id);
+    mgr.updateDueDate(id, "2025-02-02");
+    mgr.markDone(id);
+    undo.push(UndoAction::updated(before, mgr.getTask(id), mgr.indexOf(id)));
+
+    undo.undo(mgr);
+    EXPECT_EQ(mgr.getTask(id).getDueDate().value(), "2025-01-01");
+    EXPECT_FALSE(mgr.getTask(id).isDone());
+    undo.redo(mgr);
+    EXPECT_EQ(mgr.getTask(id).getDueDate().value(), "2025-02-02");
+    EXPECT_TRUE(mgr.getTask(id).isDone());
+    EXPECT_THROW(undo.redo(mgr), std::runtime_error);
+}
+
+TEST(UndoStackTest, PushClearsRedoAndBudgetEvictsOldest) {
+    TaskManager mgr;
+    UndoStack undo(1); // бюджет меньше одной записи: хранится только последняя
+    TaskId a = mgr.addTask("A");
+    undo.push(UndoAction::added(mgr.getTask(a), 0));
+    TaskId b = mgr.addTask("B");
+    undo.push(UndoAction::added(mgr.getTask(b), 1));
+
+    undo.undo(mgr);
+    EXPECT_FALSE(undo.canUndo());
+    EXPECT_TRUE(undo.canRedo());
+    TaskId c = mgr.addTask("C");
+    undo.push(UndoAction::added(mgr.getTask(c), 1));
+    EXPECT_FALSE(undo.canRedo());
+}
+
+TEST(UndoStackTest, LogSurvivesAcrossInstances) {
+    std::string log = "test_undo.log";
+    fs::remove(log);
+    TaskManager mgr;
+    TaskId id = mgr.addTask("Persisted");
+    {
+        UndoStack undo(log);
+        undo.push(UndoAction::added(mgr.getTask(id), 0));
+    }
+    {
+        UndoStack undo(log);
+        ASSERT_TRUE(undo.canUndo());
+        undo.undo(mgr);
+        EXPECT_TRUE(mgr.listTasks().empty());
+    }
+    {
+        UndoStack undo(log);
+        EXPECT_FALSE(undo.canUndo());
+        ASSERT_TRUE(undo.canRedo());
+        undo.redo(mgr);
+        EXPECT_EQ(mgr.getTask(id).getDescription(), "Persisted");
+    }
+    fs::remove(log);
+}
+
+TEST(UndoStackTest, LogIsCappedByEntries) {
+    std::string log = "test_undo_cap.log";
+    fs::remove(log);
+    TaskManager mgr;
+    {
+        UndoStack undo(log, 3, 256);
+        for (int i = 0; i < 20; ++i) {
+            TaskId id = mgr.addTask("Task " + std::to_string(i));
+            undo.push(UndoAction::added(mgr.getTask(id), mgr.indexOf(id)));
+        }
+    }
+    EXPECT_LE(fs::file_size(log), 256u);
+    UndoStack undo(log, 3, 256);
+    int undone = 0;
+    while (undo.canUndo()) {
+        undo.undo(mgr);
+        ++undone;
+    }
+    EXPECT_GE(undone, 1);
+    EXPECT_LE(undone, 3);
+    EXPECT_EQ(mgr.listTasks().size(), 20u - undone);
+    fs::remove(log);
+}